@@ -0,0 +1,255 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "assetsData.h"
+#include "pool.h"
+
+// Component storage shared by every kind of moving entity (bullets,
+// asteroids, enemies, boosts). Each component lives in its own column, so a
+// system only streams through the columns it touches: movement reads velocity
+// and writes position, the collider pass reads position, size and sprite.
+// Data that only one kind needs (a bullet's damage, an enemy's fire rate)
+// stays in a per-kind array indexed by the same dense index.
+//
+// Columns are carved from the game's arena (see arena.h) at the archetype's
+// capacity, together with its pool.
+typedef struct Archetype {
+	int count;
+	EntityPool pool;
+	// Transform
+	Vector2* position;
+	Vector2* previousPosition;
+	float* rotation;
+	float* previousRotation;
+	// Motion
+	Vector2* velocity;
+	float* angularVelocity;
+	// Shape
+	float* size;
+	SpriteID* sprite;
+	Rectangle* collider;
+	float* health;
+} Archetype;
+
+// Initial component values of a new entity, everything not set is zero
+typedef struct EntityComponents {
+	Vector2 position;
+	Vector2 velocity;
+	float rotation;
+	float angularVelocity;
+	float size;
+	SpriteID sprite;
+	float health;
+} EntityComponents;
+
+static inline bool ArchetypeCarveColumns(Archetype* archetype, MemoryArena* arena, int capacity)
+{
+	archetype->position = (Vector2*)ArenaPush(arena, capacity * sizeof(Vector2));
+	archetype->previousPosition = (Vector2*)ArenaPush(arena, capacity * sizeof(Vector2));
+	archetype->rotation = (float*)ArenaPush(arena, capacity * sizeof(float));
+	archetype->previousRotation = (float*)ArenaPush(arena, capacity * sizeof(float));
+	archetype->velocity = (Vector2*)ArenaPush(arena, capacity * sizeof(Vector2));
+	archetype->angularVelocity = (float*)ArenaPush(arena, capacity * sizeof(float));
+	archetype->size = (float*)ArenaPush(arena, capacity * sizeof(float));
+	archetype->sprite = (SpriteID*)ArenaPush(arena, capacity * sizeof(SpriteID));
+	archetype->collider = (Rectangle*)ArenaPush(arena, capacity * sizeof(Rectangle));
+	archetype->health = (float*)ArenaPush(arena, capacity * sizeof(float));
+	return archetype->health != NULL;
+}
+
+// Carves the pool and columns for capacity entities and their per-kind data,
+// an array of dataSize items (none if data is NULL). False if the arena is full.
+static inline bool ArchetypeInit(Archetype* archetype, MemoryArena* arena, int capacity, void** data, size_t dataSize)
+{
+	memset(archetype, 0, sizeof(*archetype));
+	if (!PoolInit(&archetype->pool, arena, capacity)) return false;
+	capacity = archetype->pool.capacity;
+	if (data != NULL && (*data = ArenaPush(arena, capacity * dataSize)) == NULL) return false;
+	return ArchetypeCarveColumns(archetype, arena, capacity);
+}
+
+// Moves the archetype and its per-kind data to storage for a larger capacity,
+// dense indices and handles stay valid. The old storage is left in the arena.
+// Returns false and changes nothing if the arena has no room for it.
+static inline bool ArchetypeGrow(Archetype* archetype, MemoryArena* arena, int capacity, void** data, size_t dataSize)
+{
+	const size_t mark = arena->used;
+	Archetype grown = *archetype;
+	if (!PoolGrow(&grown.pool, arena, capacity)) return false;
+	capacity = grown.pool.capacity;
+	void* grownData = data != NULL ? ArenaPush(arena, capacity * dataSize) : NULL;
+	if ((data != NULL && grownData == NULL) || !ArchetypeCarveColumns(&grown, arena, capacity))
+	{
+		arena->used = mark;
+		return false;
+	}
+	const int count = archetype->count;
+	memcpy(grown.position, archetype->position, count * sizeof(Vector2));
+	memcpy(grown.previousPosition, archetype->previousPosition, count * sizeof(Vector2));
+	memcpy(grown.rotation, archetype->rotation, count * sizeof(float));
+	memcpy(grown.previousRotation, archetype->previousRotation, count * sizeof(float));
+	memcpy(grown.velocity, archetype->velocity, count * sizeof(Vector2));
+	memcpy(grown.angularVelocity, archetype->angularVelocity, count * sizeof(float));
+	memcpy(grown.size, archetype->size, count * sizeof(float));
+	memcpy(grown.sprite, archetype->sprite, count * sizeof(SpriteID));
+	memcpy(grown.collider, archetype->collider, count * sizeof(Rectangle));
+	memcpy(grown.health, archetype->health, count * sizeof(float));
+	if (data != NULL)
+	{
+		memcpy(grownData, *data, count * dataSize);
+		*data = grownData;
+	}
+	*archetype = grown;
+	return true;
+}
+
+static inline void ArchetypeRelocate(Archetype* archetype, ptrdiff_t delta)
+{
+	PoolRelocate(&archetype->pool, delta);
+	ARENA_RELOCATE(archetype->position, delta);
+	ARENA_RELOCATE(archetype->previousPosition, delta);
+	ARENA_RELOCATE(archetype->rotation, delta);
+	ARENA_RELOCATE(archetype->previousRotation, delta);
+	ARENA_RELOCATE(archetype->velocity, delta);
+	ARENA_RELOCATE(archetype->angularVelocity, delta);
+	ARENA_RELOCATE(archetype->size, delta);
+	ARENA_RELOCATE(archetype->sprite, delta);
+	ARENA_RELOCATE(archetype->collider, delta);
+	ARENA_RELOCATE(archetype->health, delta);
+}
+
+// Bytes one entity takes across the columns
+static inline size_t ArchetypeEntityBytes(const Archetype* archetype)
+{
+	return sizeof(*archetype->position) + sizeof(*archetype->previousPosition)
+		+ sizeof(*archetype->rotation) + sizeof(*archetype->previousRotation)
+		+ sizeof(*archetype->velocity) + sizeof(*archetype->angularVelocity)
+		+ sizeof(*archetype->size) + sizeof(*archetype->sprite)
+		+ sizeof(*archetype->collider) + sizeof(*archetype->health);
+}
+
+// Collider of one frame of the sprite scaled by size, centered on the position
+static inline Rectangle ArchetypeCollider(Vector2 position, float size, SpriteID spriteID)
+{
+	const float width = SpriteFrameSize[spriteID].x * size;
+	const float height = SpriteFrameSize[spriteID].y * size;
+	return (Rectangle){position.x - width / 2.0f, position.y - height / 2.0f, width, height};
+}
+
+// Returns the dense index of the new entity, or -1 if the archetype is full
+static inline int ArchetypeSpawn(Archetype* archetype, EntityComponents components)
+{
+	const int index = PoolAdd(&archetype->pool, &archetype->count);
+	if (index < 0) return -1;
+	archetype->position[index] = components.position;
+	archetype->previousPosition[index] = components.position;
+	archetype->rotation[index] = components.rotation;
+	archetype->previousRotation[index] = components.rotation;
+	archetype->velocity[index] = components.velocity;
+	archetype->angularVelocity[index] = components.angularVelocity;
+	archetype->size[index] = components.size;
+	archetype->sprite[index] = components.sprite;
+	archetype->collider[index] = ArchetypeCollider(components.position, components.size, components.sprite);
+	archetype->health[index] = components.health;
+	return index;
+}
+
+static inline bool ArchetypeAlive(const Archetype* archetype, int index)
+{
+	return PoolAlive(&archetype->pool, index);
+}
+
+// Deferred like PoolRemove, the entity is freed by ArchetypeCompact
+static inline void ArchetypeRemove(Archetype* archetype, int index)
+{
+	PoolRemove(&archetype->pool, index);
+}
+
+static inline EntityHandle ArchetypeHandle(const Archetype* archetype, int index)
+{
+	return PoolHandle(&archetype->pool, index);
+}
+
+typedef struct ArchetypeMove {
+	Archetype* archetype;
+	unsigned char* data;
+	size_t dataSize;
+} ArchetypeMove;
+
+static inline void ArchetypeMoveEntity(void* context, int to, int from)
+{
+	ArchetypeMove* move = (ArchetypeMove*)context;
+	Archetype* a = move->archetype;
+	a->position[to] = a->position[from];
+	a->previousPosition[to] = a->previousPosition[from];
+	a->rotation[to] = a->rotation[from];
+	a->previousRotation[to] = a->previousRotation[from];
+	a->velocity[to] = a->velocity[from];
+	a->angularVelocity[to] = a->angularVelocity[from];
+	a->size[to] = a->size[from];
+	a->sprite[to] = a->sprite[from];
+	a->collider[to] = a->collider[from];
+	a->health[to] = a->health[from];
+	if (move->data != NULL)
+	{
+		memcpy(move->data + (size_t)to * move->dataSize, move->data + (size_t)from * move->dataSize, move->dataSize);
+	}
+}
+
+// Frees the removed entities, data is the per-kind array (NULL if there is none)
+static inline void ArchetypeCompact(Archetype* archetype, void* data, size_t dataSize)
+{
+	ArchetypeMove move = {archetype, (unsigned char*)data, dataSize};
+	PoolCompactWith(&archetype->pool, &archetype->count, ArchetypeMoveEntity, &move);
+}
+
+// Systems, shared by all archetypes. They run over removed entities too:
+// touching a dead entity is cheaper than a branch per entity, and it is
+// freed before anything reads it again.
+
+// Keeps the state before a tick to interpolate between when drawing
+static inline void StorePreviousTransforms(Archetype* archetype)
+{
+	memcpy(archetype->previousPosition, archetype->position, archetype->count * sizeof(Vector2));
+	memcpy(archetype->previousRotation, archetype->rotation, archetype->count * sizeof(float));
+}
+
+static inline void MoveSystem(Archetype* archetype, float dt)
+{
+	for (int i = 0; i < archetype->count; i++)
+	{
+		archetype->position[i].x += archetype->velocity[i].x * dt;
+		archetype->position[i].y += archetype->velocity[i].y * dt;
+		archetype->rotation[i] += archetype->angularVelocity[i] * dt;
+	}
+}
+
+static inline void ColliderSystem(Archetype* archetype)
+{
+	for (int i = 0; i < archetype->count; i++)
+	{
+		archetype->collider[i] = ArchetypeCollider(archetype->position[i], archetype->size[i], archetype->sprite[i]);
+	}
+}
+
+// Removes every entity whose collider left the bounds, returns how many
+static inline int CullSystem(Archetype* archetype, Rectangle bounds)
+{
+	int culled = 0;
+	for (int i = 0; i < archetype->count; i++)
+	{
+		if (!ArchetypeAlive(archetype, i)) continue;
+		const Rectangle c = archetype->collider[i];
+		if (c.x > bounds.x + bounds.width || c.x + c.width < bounds.x
+				|| c.y > bounds.y + bounds.height || c.y + c.height < bounds.y)
+		{
+			ArchetypeRemove(archetype, i);
+			culled++;
+		}
+	}
+	return culled;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Block of memory the platform layer allocates once at startup and hands to
+// the game through GameMemory. The entity storage (archetype columns, pools,
+// per-kind data) is carved out of it with ArenaPush at the sizes read from the
+// configuration; nothing is freed on its own, InitializeGameState resets the
+// arena and carves everything again. A pool that grows carves new storage and
+// leaves the old one behind until the next reset.
+//
+// The block outlives hot reloads, so the pointers GameState keeps into it stay
+// valid. Savestates write the arena next to the GameState and relocate those
+// pointers when they are loaded into a block at another address.
+#define ARENA_ALIGNMENT (64)
+
+typedef struct MemoryArena {
+	unsigned char* base;
+	size_t size;
+	size_t used;
+	size_t peak; // most ever used, over all resets
+} MemoryArena;
+
+static inline void ArenaInit(MemoryArena* arena, void* memory, size_t size)
+{
+	// Start on a cache line, every push keeps the cursor on one
+	const size_t skip = memory ? (ARENA_ALIGNMENT - (uintptr_t)memory % ARENA_ALIGNMENT) % ARENA_ALIGNMENT : 0;
+	arena->base = memory && size > skip ? (unsigned char*)memory + skip : NULL;
+	arena->size = arena->base ? size - skip : 0;
+	arena->used = 0;
+	arena->peak = 0;
+}
+
+// Zeroed and aligned to a cache line, NULL if the arena has no room left
+static inline void* ArenaPush(MemoryArena* arena, size_t size)
+{
+	size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+	if (arena->base == NULL || size > arena->size - arena->used) return NULL;
+	unsigned char* memory = arena->base + arena->used;
+	arena->used += size;
+	if (arena->used > arena->peak) arena->peak = arena->used;
+	memset(memory, 0, size);
+	return memory;
+}
+
+static inline void ArenaReset(MemoryArena* arena)
+{
+	arena->used = 0;
+}
+
+// Moves a pointer into an arena that was copied from delta bytes away
+#define ARENA_RELOCATE(pointer, delta) ((pointer) = (void*)((unsigned char*)(pointer) + (delta)))
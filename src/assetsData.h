@@ -23,14 +23,6 @@ typedef enum SpriteID {
     SPRITE_COUNT
 } SpriteID;
 
-typedef struct Sprite {
-    Texture2D texture;
-    Rectangle coords;
-    Vector2 pivotOffset;
-    int numFrames;
-    SpriteID spriteID;
-} Sprite;
-
 typedef enum AnimationID {
     ANIM_BULLET,
     ANIM_EXPLOSION,
@@ -40,7 +32,7 @@ typedef enum AnimationID {
     ANIMATION_COUNT
 } AnimationID;
 
-static int SpriteToAnimation[SPRITE_COUNT] = {
+static const int SpriteToAnimation[SPRITE_COUNT] = {
     [SPRITE_BULLET] = ANIM_BULLET,
     [SPRITE_EXPLOSION] = ANIM_EXPLOSION,
     [SPRITE_PLAYER] = ANIM_PLAYER,
@@ -48,26 +40,197 @@ static int SpriteToAnimation[SPRITE_COUNT] = {
     [SPRITE_SHIELD] = ANIM_SHIELD,
 };
 
-static inline Sprite getSprite(SpriteID spriteID) {
-    Sprite s = {0};
-    switch(spriteID) {
-        case SPRITE_ASTEROID1: { s.coords = (Rectangle){2142, 0, 64, 64}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_ASTEROID1; break; }
-        case SPRITE_ASTEROID2: { s.coords = (Rectangle){2248, 0, 64, 64}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_ASTEROID2; break; }
-        case SPRITE_ASTEROID3: { s.coords = (Rectangle){2313, 0, 96, 96}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_ASTEROID3; break; }
-        case SPRITE_BULLET: { s.coords = (Rectangle){5, 0, 192, 48}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 6; s.spriteID = SPRITE_BULLET; break; }
-        case SPRITE_CURSOR: { s.coords = (Rectangle){2207, 0, 40, 40}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_CURSOR; break; }
-        case SPRITE_ENEMY: { s.coords = (Rectangle){0, 97, 64, 64}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_ENEMY; break; }
-        case SPRITE_EXPLOSION: { s.coords = (Rectangle){2599, 0, 704, 64}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 11; s.spriteID = SPRITE_EXPLOSION; break; }
-        case SPRITE_HEART: { s.coords = (Rectangle){2410, 0, 19, 19}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_HEART; break; }
-        case SPRITE_PLAYER: { s.coords = (Rectangle){69, 97, 190, 64}; s.pivotOffset = (Vector2){-1, -24}; s.numFrames = 5; s.spriteID = SPRITE_PLAYER; break; }
-        case SPRITE_SCRAPMETAL: { s.coords = (Rectangle){3319, 0, 768, 48}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 16; s.spriteID = SPRITE_SCRAPMETAL; break; }
-        case SPRITE_SHIELD: { s.coords = (Rectangle){221, 0, 1920, 96}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 20; s.spriteID = SPRITE_SHIELD; break; }
-        case SPRITE_STAR1: { s.coords = (Rectangle){2481, 0, 5, 5}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_STAR1; break; }
-        case SPRITE_STAR2: { s.coords = (Rectangle){198, 0, 3, 3}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_STAR2; break; }
-        case SPRITE_UPGRADEDAMAGE: { s.coords = (Rectangle){2538, 0, 50, 69}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_UPGRADEDAMAGE; break; }
-        case SPRITE_UPGRADEFIRERATE: { s.coords = (Rectangle){2430, 0, 50, 69}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_UPGRADEFIRERATE; break; }
-        case SPRITE_UPGRADEMULTISHOT: { s.coords = (Rectangle){2487, 0, 50, 69}; s.pivotOffset = (Vector2){0, 0}; s.numFrames = 1; s.spriteID = SPRITE_UPGRADEMULTISHOT; break; }
-        default: break;
-    }
-    return s;
-}
+#define SPRITE_FRAME_COUNT (69)
+
+// Atlas rectangle of the whole sprite, the frames of an animation side by side
+static const Rectangle SpriteCoords[SPRITE_COUNT] = {
+    [SPRITE_ASTEROID1] = {2142, 0, 64, 64},
+    [SPRITE_ASTEROID2] = {2248, 0, 64, 64},
+    [SPRITE_ASTEROID3] = {2313, 0, 96, 96},
+    [SPRITE_BULLET] = {5, 0, 192, 48},
+    [SPRITE_CURSOR] = {2207, 0, 40, 40},
+    [SPRITE_ENEMY] = {0, 97, 64, 64},
+    [SPRITE_EXPLOSION] = {2599, 0, 704, 64},
+    [SPRITE_HEART] = {2410, 0, 19, 19},
+    [SPRITE_PLAYER] = {69, 97, 190, 64},
+    [SPRITE_SCRAPMETAL] = {3319, 0, 768, 48},
+    [SPRITE_SHIELD] = {221, 0, 1920, 96},
+    [SPRITE_STAR1] = {2481, 0, 5, 5},
+    [SPRITE_STAR2] = {198, 0, 3, 3},
+    [SPRITE_UPGRADEDAMAGE] = {2538, 0, 50, 69},
+    [SPRITE_UPGRADEFIRERATE] = {2430, 0, 50, 69},
+    [SPRITE_UPGRADEMULTISHOT] = {2487, 0, 50, 69},
+};
+
+// Width and height of a single frame
+static const Vector2 SpriteFrameSize[SPRITE_COUNT] = {
+    [SPRITE_ASTEROID1] = {64, 64},
+    [SPRITE_ASTEROID2] = {64, 64},
+    [SPRITE_ASTEROID3] = {96, 96},
+    [SPRITE_BULLET] = {32, 48},
+    [SPRITE_CURSOR] = {40, 40},
+    [SPRITE_ENEMY] = {64, 64},
+    [SPRITE_EXPLOSION] = {64, 64},
+    [SPRITE_HEART] = {19, 19},
+    [SPRITE_PLAYER] = {38, 64},
+    [SPRITE_SCRAPMETAL] = {48, 48},
+    [SPRITE_SHIELD] = {96, 96},
+    [SPRITE_STAR1] = {5, 5},
+    [SPRITE_STAR2] = {3, 3},
+    [SPRITE_UPGRADEDAMAGE] = {50, 69},
+    [SPRITE_UPGRADEFIRERATE] = {50, 69},
+    [SPRITE_UPGRADEMULTISHOT] = {50, 69},
+};
+
+// Offset of the pivot from the bottom center of a frame
+static const Vector2 SpritePivots[SPRITE_COUNT] = {
+    [SPRITE_ASTEROID1] = {0, 0},
+    [SPRITE_ASTEROID2] = {0, 0},
+    [SPRITE_ASTEROID3] = {0, 0},
+    [SPRITE_BULLET] = {0, 0},
+    [SPRITE_CURSOR] = {0, 0},
+    [SPRITE_ENEMY] = {0, 0},
+    [SPRITE_EXPLOSION] = {0, 0},
+    [SPRITE_HEART] = {0, 0},
+    [SPRITE_PLAYER] = {-1, -24},
+    [SPRITE_SCRAPMETAL] = {0, 0},
+    [SPRITE_SHIELD] = {0, 0},
+    [SPRITE_STAR1] = {0, 0},
+    [SPRITE_STAR2] = {0, 0},
+    [SPRITE_UPGRADEDAMAGE] = {0, 0},
+    [SPRITE_UPGRADEFIRERATE] = {0, 0},
+    [SPRITE_UPGRADEMULTISHOT] = {0, 0},
+};
+
+static const int SpriteNumFrames[SPRITE_COUNT] = {
+    [SPRITE_ASTEROID1] = 1,
+    [SPRITE_ASTEROID2] = 1,
+    [SPRITE_ASTEROID3] = 1,
+    [SPRITE_BULLET] = 6,
+    [SPRITE_CURSOR] = 1,
+    [SPRITE_ENEMY] = 1,
+    [SPRITE_EXPLOSION] = 11,
+    [SPRITE_HEART] = 1,
+    [SPRITE_PLAYER] = 5,
+    [SPRITE_SCRAPMETAL] = 16,
+    [SPRITE_SHIELD] = 20,
+    [SPRITE_STAR1] = 1,
+    [SPRITE_STAR2] = 1,
+    [SPRITE_UPGRADEDAMAGE] = 1,
+    [SPRITE_UPGRADEFIRERATE] = 1,
+    [SPRITE_UPGRADEMULTISHOT] = 1,
+};
+
+// Index of the first frame of the sprite in SpriteFrames
+static const int SpriteFirstFrame[SPRITE_COUNT] = {
+    [SPRITE_ASTEROID1] = 0,
+    [SPRITE_ASTEROID2] = 1,
+    [SPRITE_ASTEROID3] = 2,
+    [SPRITE_BULLET] = 3,
+    [SPRITE_CURSOR] = 9,
+    [SPRITE_ENEMY] = 10,
+    [SPRITE_EXPLOSION] = 11,
+    [SPRITE_HEART] = 22,
+    [SPRITE_PLAYER] = 23,
+    [SPRITE_SCRAPMETAL] = 28,
+    [SPRITE_SHIELD] = 44,
+    [SPRITE_STAR1] = 64,
+    [SPRITE_STAR2] = 65,
+    [SPRITE_UPGRADEDAMAGE] = 66,
+    [SPRITE_UPGRADEFIRERATE] = 67,
+    [SPRITE_UPGRADEMULTISHOT] = 68,
+};
+
+// Words of one frame of the collision mask (rows padded to 64 bits), frame
+// i of the sprite starts i times as many words into its mask
+static const int SpriteMaskFrameWords[SPRITE_COUNT] = {
+    [SPRITE_ASTEROID1] = 64,
+    [SPRITE_ASTEROID2] = 64,
+    [SPRITE_ASTEROID3] = 192,
+    [SPRITE_BULLET] = 48,
+    [SPRITE_CURSOR] = 40,
+    [SPRITE_ENEMY] = 64,
+    [SPRITE_EXPLOSION] = 64,
+    [SPRITE_HEART] = 19,
+    [SPRITE_PLAYER] = 64,
+    [SPRITE_SCRAPMETAL] = 48,
+    [SPRITE_SHIELD] = 192,
+    [SPRITE_STAR1] = 5,
+    [SPRITE_STAR2] = 3,
+    [SPRITE_UPGRADEDAMAGE] = 69,
+    [SPRITE_UPGRADEFIRERATE] = 69,
+    [SPRITE_UPGRADEMULTISHOT] = 69,
+};
+
+// Atlas rectangle of every frame, the frames of a sprite back to back
+static const Rectangle SpriteFrames[SPRITE_FRAME_COUNT] = {
+    {2142, 0, 64, 64}, // SPRITE_ASTEROID1 0
+    {2248, 0, 64, 64}, // SPRITE_ASTEROID2 0
+    {2313, 0, 96, 96}, // SPRITE_ASTEROID3 0
+    {-1, 0, 32, 48}, // SPRITE_BULLET 0
+    {32, 0, 32, 48}, // SPRITE_BULLET 1
+    {65, 0, 32, 48}, // SPRITE_BULLET 2
+    {98, 0, 32, 48}, // SPRITE_BULLET 3
+    {131, 0, 32, 48}, // SPRITE_BULLET 4
+    {164, 0, 32, 48}, // SPRITE_BULLET 5
+    {2207, 0, 40, 40}, // SPRITE_CURSOR 0
+    {0, 97, 64, 64}, // SPRITE_ENEMY 0
+    {2588, 0, 64, 64}, // SPRITE_EXPLOSION 0
+    {2653, 0, 64, 64}, // SPRITE_EXPLOSION 1
+    {2718, 0, 64, 64}, // SPRITE_EXPLOSION 2
+    {2783, 0, 64, 64}, // SPRITE_EXPLOSION 3
+    {2848, 0, 64, 64}, // SPRITE_EXPLOSION 4
+    {2913, 0, 64, 64}, // SPRITE_EXPLOSION 5
+    {2978, 0, 64, 64}, // SPRITE_EXPLOSION 6
+    {3043, 0, 64, 64}, // SPRITE_EXPLOSION 7
+    {3108, 0, 64, 64}, // SPRITE_EXPLOSION 8
+    {3173, 0, 64, 64}, // SPRITE_EXPLOSION 9
+    {3238, 0, 64, 64}, // SPRITE_EXPLOSION 10
+    {2410, 0, 19, 19}, // SPRITE_HEART 0
+    {64, 97, 38, 64}, // SPRITE_PLAYER 0
+    {103, 97, 38, 64}, // SPRITE_PLAYER 1
+    {142, 97, 38, 64}, // SPRITE_PLAYER 2
+    {181, 97, 38, 64}, // SPRITE_PLAYER 3
+    {220, 97, 38, 64}, // SPRITE_PLAYER 4
+    {3303, 0, 48, 48}, // SPRITE_SCRAPMETAL 0
+    {3352, 0, 48, 48}, // SPRITE_SCRAPMETAL 1
+    {3401, 0, 48, 48}, // SPRITE_SCRAPMETAL 2
+    {3450, 0, 48, 48}, // SPRITE_SCRAPMETAL 3
+    {3499, 0, 48, 48}, // SPRITE_SCRAPMETAL 4
+    {3548, 0, 48, 48}, // SPRITE_SCRAPMETAL 5
+    {3597, 0, 48, 48}, // SPRITE_SCRAPMETAL 6
+    {3646, 0, 48, 48}, // SPRITE_SCRAPMETAL 7
+    {3695, 0, 48, 48}, // SPRITE_SCRAPMETAL 8
+    {3744, 0, 48, 48}, // SPRITE_SCRAPMETAL 9
+    {3793, 0, 48, 48}, // SPRITE_SCRAPMETAL 10
+    {3842, 0, 48, 48}, // SPRITE_SCRAPMETAL 11
+    {3891, 0, 48, 48}, // SPRITE_SCRAPMETAL 12
+    {3940, 0, 48, 48}, // SPRITE_SCRAPMETAL 13
+    {3989, 0, 48, 48}, // SPRITE_SCRAPMETAL 14
+    {4038, 0, 48, 48}, // SPRITE_SCRAPMETAL 15
+    {201, 0, 96, 96}, // SPRITE_SHIELD 0
+    {298, 0, 96, 96}, // SPRITE_SHIELD 1
+    {395, 0, 96, 96}, // SPRITE_SHIELD 2
+    {492, 0, 96, 96}, // SPRITE_SHIELD 3
+    {589, 0, 96, 96}, // SPRITE_SHIELD 4
+    {686, 0, 96, 96}, // SPRITE_SHIELD 5
+    {783, 0, 96, 96}, // SPRITE_SHIELD 6
+    {880, 0, 96, 96}, // SPRITE_SHIELD 7
+    {977, 0, 96, 96}, // SPRITE_SHIELD 8
+    {1074, 0, 96, 96}, // SPRITE_SHIELD 9
+    {1171, 0, 96, 96}, // SPRITE_SHIELD 10
+    {1268, 0, 96, 96}, // SPRITE_SHIELD 11
+    {1365, 0, 96, 96}, // SPRITE_SHIELD 12
+    {1462, 0, 96, 96}, // SPRITE_SHIELD 13
+    {1559, 0, 96, 96}, // SPRITE_SHIELD 14
+    {1656, 0, 96, 96}, // SPRITE_SHIELD 15
+    {1753, 0, 96, 96}, // SPRITE_SHIELD 16
+    {1850, 0, 96, 96}, // SPRITE_SHIELD 17
+    {1947, 0, 96, 96}, // SPRITE_SHIELD 18
+    {2044, 0, 96, 96}, // SPRITE_SHIELD 19
+    {2481, 0, 5, 5}, // SPRITE_STAR1 0
+    {198, 0, 3, 3}, // SPRITE_STAR2 0
+    {2538, 0, 50, 69}, // SPRITE_UPGRADEDAMAGE 0
+    {2430, 0, 50, 69}, // SPRITE_UPGRADEFIRERATE 0
+    {2487, 0, 50, 69}, // SPRITE_UPGRADEMULTISHOT 0
+};
@@ -1,18 +1,26 @@
 #pragma once
 #include <stdlib.h>
+#include <stdint.h>
 #include "raylib.h"
 #include "assetsData.h"
 #include "stdio.h"
 #include <math.h>
 
 // #define internal static inline
-#define SHAPE_PADDING 1
+
+// Pre-rotated collision masks per frame of a rotating sprite, one every
+// 360 / MASK_ROTATION_BUCKETS degrees. More buckets cost memory and get
+// closer to the drawn angle, 0 turns the cache off and every test rotates
+// the overlap pixels instead.
+#ifndef MASK_ROTATION_BUCKETS
+#define MASK_ROTATION_BUCKETS (32)
+#endif
 
 typedef struct SpriteAnimation
 {
     int framesPerSecond;
     float timeStarted;
-    Rectangle* rectangles;
+    const Rectangle* rectangles; // frames of the sprite in SpriteFrames
     int rectanglesLength;
 } SpriteAnimation;
 
@@ -24,17 +32,36 @@ typedef struct TextureAtlas
 	SpriteAnimation animations[ANIMATION_COUNT];
 } TextureAtlas;
 
+// Collision mask of a sprite, one bit per pixel that is not fully
+// transparent. Rows start on a word boundary, bit x & 63 of word x >> 6.
+// Animated sprites store one mask per frame back to back in the same block.
 typedef struct SpriteMask {
-    Color* pixels;
+    uint64_t* bits;
     int width;
     int height;
+    int wordsPerRow;
+	int frameCount;
+	// Collision midphase shapes around the opaque pixels of every frame, in
+	// mask pixels. Both are padded by a pixel so they never reject a pair the
+	// pixel test accepts.
+	Rectangle bounds; // tight box
+	float radius;     // bounding circle around the center of the mask
+	// Pre-rotated masks, rotationCount per frame, NULL if the sprite never rotates
+	struct SpriteMask* rotations;
+	int rotationCount;
 } SpriteMask;
 
-static inline Color* getPixelsFromAtlas(Image atlasImage, Sprite sprite, int numberOfFrames)
+// Sprites the game draws rotated, they get pre-rotated masks
+static const bool SpriteRotates[SPRITE_COUNT] = {
+	[SPRITE_ASTEROID1] = true,
+	[SPRITE_ASTEROID2] = true,
+	[SPRITE_ASTEROID3] = true,
+	[SPRITE_BULLET] = true,
+};
+
+static inline Color* getPixelsFromAtlas(Image atlasImage, Rectangle src)
 {
 	// Extract the sprite rectangle as an Image from the atlas image
-	Rectangle src = sprite.coords;
-	src.width = src.width / numberOfFrames;
 	Image img = ImageFromImage(atlasImage, src);
 	// Ensure uncompressed RGBA8 format
 	ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
@@ -45,48 +72,207 @@ static inline Color* getPixelsFromAtlas(Image atlasImage, Sprite sprite, int num
 	return pixels;
 }
 
+static inline bool maskBit(const SpriteMask* mask, int x, int y)
+{
+	return (mask->bits[y * mask->wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+// The mask of one frame, sharing the bits of the whole sprite
+static inline SpriteMask getMaskFrame(const SpriteMask* mask, int frame)
+{
+	SpriteMask frameMask = *mask;
+	frameMask.bits += (size_t)frame * mask->wordsPerRow * mask->height;
+	frameMask.frameCount = 1;
+	if (mask->rotations != NULL) frameMask.rotations += frame * mask->rotationCount;
+	return frameMask;
+}
+
+// Pre-rotated mask of a single frame closest to a rotation in degrees
+static inline const SpriteMask* getRotatedMask(const SpriteMask* mask, float rotationDeg)
+{
+	int bucket = (int)floorf(rotationDeg * mask->rotationCount / 360.0f + 0.5f) % mask->rotationCount;
+	if (bucket < 0) bucket += mask->rotationCount;
+	return &mask->rotations[bucket];
+}
+
+// Packs the frames of a sprite into one mask, frame after frame
+static inline SpriteMask packSpriteMask(Image atlasImage, SpriteID spriteID)
+{
+	const Rectangle* frames = &SpriteFrames[SpriteFirstFrame[spriteID]];
+	const int frameCount = SpriteNumFrames[spriteID];
+	SpriteMask mask = {
+		.width = (int)SpriteFrameSize[spriteID].x,
+		.height = (int)SpriteFrameSize[spriteID].y,
+		.wordsPerRow = ((int)SpriteFrameSize[spriteID].x + 63) / 64,
+		.frameCount = frameCount,
+	};
+	const size_t frameWords = SpriteMaskFrameWords[spriteID];
+	mask.bits = (uint64_t*)calloc(frameWords * frameCount, sizeof(uint64_t));
+	if (mask.bits == NULL)
+	{
+		TraceLog(LOG_FATAL, "No memory for sprite mask");
+		return (SpriteMask){0};
+	}
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		Color* pixels = getPixelsFromAtlas(atlasImage, frames[frame]);
+		uint64_t* bits = mask.bits + frame * frameWords;
+		for (int y = 0; y < mask.height; y++)
+		{
+			for (int x = 0; x < mask.width; x++)
+			{
+				if (pixels[y * mask.width + x].a > 0) bits[y * mask.wordsPerRow + (x >> 6)] |= (uint64_t)1 << (x & 63);
+			}
+		}
+		UnloadImageColors(pixels);
+	}
+	return mask;
+}
+
+static inline void computeMaskShape(SpriteMask* mask)
+{
+	const float centerX = mask->width * 0.5f;
+	const float centerY = mask->height * 0.5f;
+	int minX = mask->width, minY = mask->height, maxX = -1, maxY = -1;
+	float radiusSquared = 0.0f;
+	for (int frame = 0; frame < mask->frameCount; frame++)
+	{
+		const SpriteMask frameMask = getMaskFrame(mask, frame);
+		for (int y = 0; y < mask->height; y++)
+		{
+			for (int x = 0; x < mask->width; x++)
+			{
+				if (!maskBit(&frameMask, x, y)) continue;
+				minX = x < minX ? x : minX;
+				minY = y < minY ? y : minY;
+				maxX = x > maxX ? x : maxX;
+				maxY = y > maxY ? y : maxY;
+				// Farthest corner of the padded pixel [x - 1, x + 2)
+				const float dx = fmaxf(fabsf(x - 1 - centerX), fabsf(x + 2 - centerX));
+				const float dy = fmaxf(fabsf(y - 1 - centerY), fabsf(y + 2 - centerY));
+				radiusSquared = fmaxf(radiusSquared, dx * dx + dy * dy);
+			}
+		}
+	}
+	if (maxX < 0)
+	{
+		mask->bounds = (Rectangle){0};
+		mask->radius = 0.0f;
+		return;
+	}
+	mask->bounds = (Rectangle){minX - 1.0f, minY - 1.0f, maxX - minX + 3.0f, maxY - minY + 3.0f};
+	mask->radius = sqrtf(radiusSquared);
+}
+
+// Box around a single frame mask rotated by rotationDeg, the size of its pre-rotated mask
+static inline SpriteMask rotatedMaskSize(const SpriteMask* mask, float rotationDeg)
+{
+	const float r = rotationDeg * DEG2RAD;
+	const float c = fabsf(cosf(r)), s = fabsf(sinf(r));
+	// The epsilon keeps right angles from growing a pixel on rounding errors
+	const int width = (int)ceilf(c * mask->width + s * mask->height - 1e-3f);
+	const int height = (int)ceilf(s * mask->width + c * mask->height - 1e-3f);
+	return (SpriteMask){
+		.width = width,
+		.height = height,
+		.wordsPerRow = (width + 63) / 64,
+		.frameCount = 1,
+	};
+}
+
+// Rasterizes a single frame mask rotated about its center into rotated, which
+// has its size from rotatedMaskSize and zeroed bits. Every pixel center of
+// the rotated mask is turned back into the frame and takes the bit it lands on.
+static inline void rotateSpriteMask(const SpriteMask* mask, SpriteMask* rotated, float rotationDeg)
+{
+	const float r = -rotationDeg * DEG2RAD;
+	const float c = cosf(r), s = sinf(r);
+	for (int y = 0; y < rotated->height; y++)
+	{
+		const float ry = y + 0.5f - rotated->height * 0.5f;
+		for (int x = 0; x < rotated->width; x++)
+		{
+			const float rx = x + 0.5f - rotated->width * 0.5f;
+			const int u = (int)floorf(c * rx - s * ry + mask->width * 0.5f);
+			const int v = (int)floorf(s * rx + c * ry + mask->height * 0.5f);
+			if (u < 0 || v < 0 || u >= mask->width || v >= mask->height) continue;
+			if (maskBit(mask, u, v)) rotated->bits[y * rotated->wordsPerRow + (x >> 6)] |= (uint64_t)1 << (x & 63);
+		}
+	}
+	computeMaskShape(rotated);
+}
+
+// Builds bucketCount rotated masks for every frame, all in one block of bits.
+// Returns the bytes they take.
+static inline size_t buildRotatedMasks(SpriteMask* mask, int bucketCount)
+{
+	mask->rotations = NULL;
+	mask->rotationCount = 0;
+	if (bucketCount <= 0) return 0;
+	const int count = mask->frameCount * bucketCount;
+	SpriteMask* rotations = (SpriteMask*)calloc(count, sizeof(SpriteMask));
+	if (rotations == NULL)
+	{
+		TraceLog(LOG_WARNING, "No memory for rotated sprite masks");
+		return 0;
+	}
+	size_t words = 0;
+	for (int i = 0; i < count; i++)
+	{
+		rotations[i] = rotatedMaskSize(mask, (i % bucketCount) * 360.0f / bucketCount);
+		words += (size_t)rotations[i].wordsPerRow * rotations[i].height;
+	}
+	uint64_t* bits = (uint64_t*)calloc(words, sizeof(uint64_t));
+	if (bits == NULL)
+	{
+		TraceLog(LOG_WARNING, "No memory for rotated sprite masks");
+		free(rotations);
+		return 0;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		rotations[i].bits = bits;
+		bits += (size_t)rotations[i].wordsPerRow * rotations[i].height;
+		const SpriteMask frame = getMaskFrame(mask, i / bucketCount);
+		rotateSpriteMask(&frame, &rotations[i], (i % bucketCount) * 360.0f / bucketCount);
+	}
+	mask->rotations = rotations;
+	mask->rotationCount = bucketCount;
+	return words * sizeof(uint64_t) + count * sizeof(SpriteMask);
+}
+
+static inline void freeSpriteMask(SpriteMask* mask)
+{
+	if (mask->rotations != NULL) free(mask->rotations[0].bits);
+	free(mask->rotations);
+	free(mask->bits);
+	*mask = (SpriteMask){0};
+}
+
 static inline Rectangle GetCurrentAnimationFrame(SpriteAnimation animation) {
     int index = (int)(GetTime() * animation.framesPerSecond) % animation.rectanglesLength;
     return animation.rectangles[index];
 }
 
+// Frame shown at a point in time, the simulation passes the game time so
+// collisions test the frame that is drawn for the tick
+static inline int GetAnimationFrameIndexAt(SpriteAnimation animation, double time) {
+    return (int)(time * animation.framesPerSecond) % animation.rectanglesLength;
+}
+
 static inline int GetCurrentAnimationFrameIndex(SpriteAnimation animation) {
-    int index = (int)(GetTime() * animation.framesPerSecond) % animation.rectanglesLength;
-    return index;
+    return GetAnimationFrameIndexAt(animation, GetTime());
 }
 
-static inline SpriteAnimation createSpriteAnimation(Texture2D atlas, SpriteID spriteID, int framesPerSecond, int numFrames)
+static inline SpriteAnimation createSpriteAnimation(SpriteID spriteID, int framesPerSecond)
 {
-	Sprite sprite = getSprite(spriteID);
-	int x = sprite.coords.x;
-	int y = sprite.coords.y;
-	int width = sprite.coords.width;
-	int height = sprite.coords.height;
-
     SpriteAnimation spriteAnimation = 
     {
         .framesPerSecond = framesPerSecond,
 		.timeStarted = (float)GetTime(),
-		.rectangles = NULL,
-		.rectanglesLength = numFrames,
+		.rectangles = &SpriteFrames[SpriteFirstFrame[spriteID]],
+		.rectanglesLength = SpriteNumFrames[spriteID],
     };
-
-    Rectangle* mem = (Rectangle*)malloc(sizeof(Rectangle) * numFrames);
-    if (mem == NULL)
-    {
-        TraceLog(LOG_FATAL, "No memory for CreateSpriteAnimation");
-        spriteAnimation.rectanglesLength = 0;
-        return spriteAnimation;
-    }
-
-    spriteAnimation.rectangles = mem;
-    for(int i = 0; i < numFrames; i++)
-    {
-
-        spriteAnimation.rectangles[i] = (Rectangle){(float)x+i*(((float)width/(float)numFrames)+SHAPE_PADDING)-SHAPE_PADDING*(float)numFrames,(float)y,(float)width/(float)numFrames,(float)height};
-		// printf("Rectangle %i: %f %f %f %f\n", i, spriteAnimation.rectangles[i].x, spriteAnimation.rectangles[i].y, spriteAnimation.rectangles[i].width, spriteAnimation.rectangles[i].height);
-	}
-
     return spriteAnimation;
 }
 
@@ -96,12 +282,10 @@ static inline bool DrawSpriteAnimationOnce(Texture2D atlas,
                              Vector2 origin,
                              float rotation,
                              Color tint,
-                             float startTime)
+                             float elapsed)
 {
     // int texSizeLoc = GetShaderLocation(shader, "textureSize");
 
-    float elapsed = GetTime() - startTime;
-
     int frame = (int)(elapsed * animation.framesPerSecond);
 
     if (frame >= animation.rectanglesLength)
@@ -114,7 +298,7 @@ static inline bool DrawSpriteAnimationOnce(Texture2D atlas,
     return false; // still playing
 }
 
-static inline void DrawSpriteAnimationPro(Texture2D* atlas, SpriteAnimation* animation, Rectangle destination, Vector2 origin, float rotation, Color tint, int flipX, int flipY)
+static inline void DrawSpriteAnimationPro(Texture2D* atlas, SpriteAnimation* animation, Rectangle destination, Vector2 origin, float rotation, Color tint, int flipX, int flipY, double time)
 {
 	if (!atlas || !animation) return;
 	if (animation->framesPerSecond <= 0) return;
@@ -123,8 +307,7 @@ static inline void DrawSpriteAnimationPro(Texture2D* atlas, SpriteAnimation* ani
 		return;
 	}
 	// int texSizeLoc = GetShaderLocation(shader, "textureSize");
-    int index = (int)(GetTime() * animation->framesPerSecond) % animation->rectanglesLength;
-    Rectangle source = animation->rectangles[index];
+    Rectangle source = animation->rectangles[GetAnimationFrameIndexAt(*animation, time)];
 	if (flipX == 1) { 
 		source.width = -source.width;
 	}
@@ -134,11 +317,6 @@ static inline void DrawSpriteAnimationPro(Texture2D* atlas, SpriteAnimation* ani
     DrawTexturePro(*atlas, source, destination, origin, rotation, tint);
 }
 
-static inline void FreeSpriteAnimation(SpriteAnimation animation)
-{
-    free(animation.rectangles);
-}
-
 static inline TextureAtlas initTextureAtlas(SpriteMask spriteMasks[])
 {
     TextureAtlas atlas;
@@ -150,19 +328,25 @@ static inline TextureAtlas initTextureAtlas(SpriteMask spriteMasks[])
 	Image atlasImage = LoadImageFromTexture(atlas.textureAtlas);
     ImageFormat(&atlasImage, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
 
-	int animCount = 0;
+	size_t maskBytes = 0;
+	size_t colorBytes = 0;
+	size_t rotatedBytes = 0;
 	for (int i = 0; i < SPRITE_COUNT; i++)
 	{
-		if (getSprite((SpriteID)i).numFrames > 1)
+		if (SpriteNumFrames[i] > 1)
 		{
-			atlas.animations[animCount] = createSpriteAnimation(atlas.textureAtlas, (SpriteID)i, 7, getSprite((SpriteID)i).numFrames);
-			// printf("Animation %i: %i frames\n", animCount, getSprite((SpriteID)SpriteToAnimation[i]).numFrames);
-			animCount++;
+			atlas.animations[SpriteToAnimation[i]] = createSpriteAnimation((SpriteID)i, 7);
 		}
-		spriteMasks[i].pixels = getPixelsFromAtlas(atlasImage, getSprite((SpriteID)i), getSprite((SpriteID)i).numFrames);
-		spriteMasks[i].width = getSprite((SpriteID)i).coords.width / getSprite((SpriteID)i).numFrames;
-		spriteMasks[i].height = getSprite((SpriteID)i).coords.height;
+		// Masks come from the same rectangles the animation draws
+		const int frameCount = SpriteNumFrames[i];
+		spriteMasks[i] = packSpriteMask(atlasImage, (SpriteID)i);
+		computeMaskShape(&spriteMasks[i]);
+		if (SpriteRotates[i]) rotatedBytes += buildRotatedMasks(&spriteMasks[i], MASK_ROTATION_BUCKETS);
+		maskBytes += (size_t)spriteMasks[i].wordsPerRow * spriteMasks[i].height * frameCount * sizeof(uint64_t);
+		colorBytes += (size_t)spriteMasks[i].width * spriteMasks[i].height * frameCount * sizeof(Color);
 	}
+	TraceLog(LOG_INFO, "Sprite masks: %d bytes (%d as RGBA)", (int)maskBytes, (int)colorBytes);
+	TraceLog(LOG_INFO, "Rotated sprite masks: %d bytes at %d buckets", (int)rotatedBytes, MASK_ROTATION_BUCKETS);
 
     UnloadImage(atlasImage);
     return atlas;
@@ -0,0 +1,503 @@
+// Scenario benchmark for the update and draw loop.
+// Built like the headless driver (platformHeadless.h instead of raylib), so
+// numbers are not capped by vsync or TARGET_FPS. Each scenario forces an
+// entity load into GameState, tops it up between ticks (outside the timed
+// region) and reports ns/tick for the update and draw phases. --phases breaks
+// them down further using the profiler's per-phase timers and counters (see
+// profiler.h), such as how many collision pairs the broadphase leaves.
+// --jobs starts worker threads for the update's job graphs (see jobs.h); the
+// phases then add up the time of jobs that ran in parallel. Every scenario is
+// also run on the serial path, without the workers, and the speedup of the
+// update and of the collision passes over it is reported.
+//
+// Usage: asteroids_bench [--ticks N] [--warmup N] [--scenario NAME] [--no-draw] [--phases] [--jobs N]
+//                        [--json FILE] [--csv FILE] [--label TEXT] [--list]
+#define RAYMATH_STATIC_INLINE
+#include "platformHeadless.h"
+#include "game.c"
+#include "platformJobs.h"
+
+#define BENCH_SEED (1)
+#define BENCH_TICK_RATE (60)
+#define BENCH_MAX_SCENARIOS (16)
+
+typedef void (*BenchSetupFn)(GameState* gameState);
+
+typedef struct BenchScenario {
+	const char* name;
+	const char* description;
+	BenchSetupFn setup;    // once, after the state has been reset
+	BenchSetupFn maintain; // before every tick, not timed
+} BenchScenario;
+
+typedef struct BenchResult {
+	const BenchScenario* scenario;
+	long ticks;
+	double updateNs;
+	double drawNs;
+	double averageBullets;
+	double averageAsteroids;
+	double averageParticles;
+	double phaseNs[PROFILE_COUNT];
+	double counters[PROFILE_COUNTER_COUNT]; // per tick
+} BenchResult;
+
+// Scenario helpers
+static void BenchStartRunning(GameState* gameState)
+{
+	gameState->state = STATE_RUNNING;
+	gameState->lastState = STATE_RUNNING;
+}
+
+// Keeps the player alive and out of the upgrade screen
+static void BenchKeepPlayerAlive(GameState* gameState)
+{
+	gameState->player.health = 7;
+	gameState->player.invulTime = 1.0f;
+	gameState->experience = 0;
+	if (gameState->state != STATE_RUNNING) BenchStartRunning(gameState);
+}
+
+// Scenarios fill the pools to the capacities config.ini asks for
+static int BenchCapacity(const GameState* gameState, PoolKind kind)
+{
+	return gameState->pools[kind].capacity;
+}
+
+static void BenchAddBullet(GameState* gameState, Vector2 position, float angleDeg, EntityHandle owner)
+{
+	if (gameState->bullets.count >= BenchCapacity(gameState, POOL_BULLETS)) return;
+	Rng* rng = &gameState->rng[RNG_GAMEPLAY];
+	float angleRad = angleDeg * DEG2RAD;
+	EntityComponents components = {
+		.position = position,
+		.velocity = (Vector2){sinf(angleRad) * 500.0f, -cosf(angleRad) * 500.0f},
+		.sprite = SPRITE_BULLET,
+		.rotation = angleDeg,
+		.size = 0.75f * (0.5f + RngFloat(rng)),
+	};
+	SpawnBullet(gameState, components, (Bullet){.damage = 1.5f, .owner = owner});
+}
+
+static void BenchAddAsteroid(GameState* gameState, Vector2 position)
+{
+	if (gameState->asteroids.count >= BenchCapacity(gameState, POOL_ASTEROIDS)) return;
+	Rng* rng = &gameState->rng[RNG_GAMEPLAY];
+	const SpriteID sprites[] = {SPRITE_ASTEROID1, SPRITE_ASTEROID2, SPRITE_ASTEROID3};
+	float size = RngInt(rng, 50, 200) / 100.0f;
+	float speed = RngInt(rng, 30, 65) * 5.0f / size;
+	float angularVelocity = RngInt(rng, -40, 40);
+	float rotation = RngInt(rng, 0, 359);
+	EntityComponents components = {
+		.position = position,
+		.health = 1000.0f,
+		.size = size,
+		.velocity = (Vector2){0, speed},
+		.angularVelocity = angularVelocity,
+		.rotation = rotation,
+		.sprite = sprites[RngInt(rng, 0, 2)],
+	};
+	SpawnAsteroid(gameState, components, (Asteroid){0});
+}
+
+static void BenchAddEnemy(GameState* gameState, float phase)
+{
+	if (gameState->enemies.count >= BenchCapacity(gameState, POOL_ENEMIES)) return;
+	EntityComponents components = {
+		.position = (Vector2){VIRTUAL_WIDTH / 2.0f, 70},
+		.health = 1000.0f,
+		.size = 2,
+		.sprite = SPRITE_ENEMY,
+	};
+	SpawnEnemy(gameState, components, (Enemy){
+		.phase = phase,
+		.phaseRate = 0.4f,
+		.fireRate = 4.0f,
+		.damageMulti = 1.0f,
+		.bulletCount = 3,
+	});
+}
+
+static Vector2 BenchRandomPosition(GameState* gameState)
+{
+	Rng* rng = &gameState->rng[RNG_GAMEPLAY];
+	return (Vector2){(float)RngInt(rng, 0, VIRTUAL_WIDTH), (float)RngInt(rng, 0, VIRTUAL_HEIGHT)};
+}
+
+// Scenarios
+static void BenchRunningSetup(GameState* gameState)
+{
+	BenchStartRunning(gameState);
+}
+
+static void BenchBulletsMaintain(GameState* gameState)
+{
+	BenchKeepPlayerAlive(gameState);
+	while (gameState->bullets.count < BenchCapacity(gameState, POOL_BULLETS))
+	{
+		BenchAddBullet(gameState, BenchRandomPosition(gameState), (float)RngInt(&gameState->rng[RNG_GAMEPLAY], -15, 15), ENTITY_NONE);
+	}
+}
+
+static void BenchAsteroidsMaintain(GameState* gameState)
+{
+	BenchKeepPlayerAlive(gameState);
+	while (gameState->asteroids.count < BenchCapacity(gameState, POOL_ASTEROIDS))
+	{
+		BenchAddAsteroid(gameState, BenchRandomPosition(gameState));
+	}
+}
+
+static void BenchMixedMaintain(GameState* gameState)
+{
+	BenchKeepPlayerAlive(gameState);
+	while (gameState->asteroids.count < BenchCapacity(gameState, POOL_ASTEROIDS))
+	{
+		BenchAddAsteroid(gameState, BenchRandomPosition(gameState));
+	}
+	while (gameState->bullets.count < BenchCapacity(gameState, POOL_BULLETS) / 2)
+	{
+		BenchAddBullet(gameState, BenchRandomPosition(gameState), (float)RngInt(&gameState->rng[RNG_GAMEPLAY], -15, 15), ENTITY_NONE);
+	}
+}
+
+static void BenchEnemiesMaintain(GameState* gameState)
+{
+	BenchKeepPlayerAlive(gameState);
+	for (int i = gameState->enemies.count; i < BenchCapacity(gameState, POOL_ENEMIES); i++)
+	{
+		BenchAddEnemy(gameState, 2.0f * PI * i / BenchCapacity(gameState, POOL_ENEMIES));
+	}
+	for (int i = 0; i < gameState->enemies.count; i++)
+	{
+		gameState->enemies.health[i] = 1000.0f;
+	}
+	while (gameState->bullets.count < BenchCapacity(gameState, POOL_BULLETS) / 2)
+	{
+		BenchAddBullet(gameState, BenchRandomPosition(gameState), (float)RngInt(&gameState->rng[RNG_GAMEPLAY], -15, 15), ENTITY_NONE);
+	}
+}
+
+static void BenchEmittersMaintain(GameState* gameState)
+{
+	BenchKeepPlayerAlive(gameState);
+	while (gameState->particleEmitterCount < BenchCapacity(gameState, POOL_EMITTERS))
+	{
+		Vector2 position = BenchRandomPosition(gameState);
+		ParticleTemplate particleTemplate = {
+			.sprite = SPRITE_ASTEROID1,
+			.positionRange = (Vector4){position.x, position.x, position.y, position.y},
+			.velocityRange = (Vector4){-100, 100, -100, 100},
+			.angleRange = (Vector2){0, 360},
+			.sizeRange = (Vector2){0.4f, 0.2f},
+			.accelerationRange = (Vector4){0, 0, 0, 0},
+			.angularVelocityRange = (Vector2){-200, 200},
+			.startColor = WHITE,
+			.endColor = WHITE,
+		};
+		SpawnEmitter(gameState, position, MAX_PARTICLES, 400.0f, 1000.0f, particleTemplate);
+	}
+}
+
+static void BenchUpgradeSetup(GameState* gameState)
+{
+	gameState->state = STATE_UPGRADE;
+	gameState->lastState = STATE_RUNNING;
+}
+
+static void BenchMenuSetup(GameState* gameState)
+{
+	(void)gameState;
+}
+
+static const BenchScenario benchScenarios[] = {
+	{"running",       "plain run, natural spawns",                        BenchRunningSetup, BenchKeepPlayerAlive},
+	{"max_bullets",   "a full bullet pool of player bullets on screen",   BenchRunningSetup, BenchBulletsMaintain},
+	{"max_asteroids", "a full asteroid pool of rotating asteroids",       BenchRunningSetup, BenchAsteroidsMaintain},
+	{"mixed",         "full asteroid pool and a half full bullet pool",   BenchRunningSetup, BenchMixedMaintain},
+	{"enemies",       "full enemy pool firing into a half full bullet pool", BenchRunningSetup, BenchEnemiesMaintain},
+	{"max_emitters",  "a full emitter pool of full emitters",             BenchRunningSetup, BenchEmittersMaintain},
+	{"upgrade",       "upgrade screen",                                   BenchUpgradeSetup, NULL},
+	{"main_menu",     "main menu with background emitters",               BenchMenuSetup,    NULL},
+};
+#define BENCH_SCENARIO_COUNT ((int)(sizeof(benchScenarios) / sizeof(benchScenarios[0])))
+
+static BenchResult BenchRun(GameMemory* gameMemory, const BenchScenario* scenario, long warmup, long ticks, bool draw)
+{
+	GameState* gameState = gameMemory->gameState;
+	const float dt = 1.0f / BENCH_TICK_RATE;
+	InitializeGameState(gameState, BENCH_SEED);
+	gameState->renderAlpha = 1.0f;
+	scenario->setup(gameState);
+
+	BenchResult result = { .scenario = scenario, .ticks = ticks };
+	double updateTime = 0.0;
+	double drawTime = 0.0;
+	for (long tick = -warmup; tick < ticks; tick++)
+	{
+		HeadlessBeginFrame(dt);
+		if (scenario->maintain) scenario->maintain(gameState);
+		PollGameInput(gameState);
+		ProfileFrameBegin(gameMemory->profiler);
+
+		double start = HeadlessWallTime();
+		SimulateTick(gameMemory, dt);
+		double updated = HeadlessWallTime();
+		if (draw) DrawGame(gameMemory);
+		double drawn = HeadlessWallTime();
+		const ProfileFrame* frame = &gameMemory->profiler->frames[gameMemory->profiler->current];
+		ProfileFrameEnd(gameMemory->profiler, gameState->bullets.count);
+
+		if (tick < 0) continue;
+		for (int phase = 0; phase < PROFILE_COUNT; phase++)
+		{
+			result.phaseNs[phase] += frame->seconds[phase];
+		}
+		for (int counter = 0; counter < PROFILE_COUNTER_COUNT; counter++)
+		{
+			result.counters[counter] += frame->counters[counter];
+		}
+		updateTime += updated - start;
+		drawTime += drawn - updated;
+		result.averageBullets += gameState->bullets.count;
+		result.averageAsteroids += gameState->asteroids.count;
+		for (int i = 0; i < gameState->particleEmitterCount; i++)
+		{
+			result.averageParticles += gameState->particleEmitters[i].particleCount;
+		}
+	}
+	if (ticks > 0)
+	{
+		result.updateNs = updateTime * 1e9 / ticks;
+		result.drawNs = drawTime * 1e9 / ticks;
+		result.averageBullets /= ticks;
+		result.averageAsteroids /= ticks;
+		result.averageParticles /= ticks;
+		for (int phase = 0; phase < PROFILE_COUNT; phase++)
+		{
+			result.phaseNs[phase] *= 1e9 / ticks;
+		}
+		for (int counter = 0; counter < PROFILE_COUNTER_COUNT; counter++)
+		{
+			result.counters[counter] /= ticks;
+		}
+	}
+	return result;
+}
+
+static void BenchWriteJson(const char* path, const char* label, const BenchResult* results, int count)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		printf("Error: could not open %s\n", path);
+		return;
+	}
+	// The label comes from the command line, escaped the way the trace writes names
+	fprintf(file, "{\n  \"label\": ");
+	TraceWriteString(file, label);
+	fprintf(file, ",\n  \"tickRate\": %d,\n  \"seed\": %d,\n  \"scenarios\": [\n", BENCH_TICK_RATE, BENCH_SEED);
+	for (int i = 0; i < count; i++)
+	{
+		const BenchResult* r = &results[i];
+		fprintf(file, "    {\"name\": \"%s\", \"ticks\": %ld, \"updateNsPerTick\": %.1f, \"drawNsPerTick\": %.1f, \"totalNsPerTick\": %.1f, "
+				"\"bullets\": %.1f, \"asteroids\": %.1f, \"particles\": %.1f, \"phases\": {",
+				r->scenario->name, r->ticks, r->updateNs, r->drawNs, r->updateNs + r->drawNs,
+				r->averageBullets, r->averageAsteroids, r->averageParticles);
+		for (int phase = 0; phase < PROFILE_COUNT; phase++)
+		{
+			fprintf(file, "\"%s\": %.1f%s", ProfilePhaseName((ProfilePhase)phase), r->phaseNs[phase], phase + 1 < PROFILE_COUNT ? ", " : "");
+		}
+		fprintf(file, "}, \"counters\": {");
+		for (int counter = 0; counter < PROFILE_COUNTER_COUNT; counter++)
+		{
+			fprintf(file, "\"%s\": %.1f%s", ProfileCounterName((ProfileCounter)counter), r->counters[counter], counter + 1 < PROFILE_COUNTER_COUNT ? ", " : "");
+		}
+		fprintf(file, "}}%s\n", i + 1 < count ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+	fclose(file);
+}
+
+// Quoted with doubled quotes, so a label with commas stays one field
+static void BenchWriteCsvField(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"') fputc('"', file);
+		fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+static void BenchWriteCsv(const char* path, const char* label, const BenchResult* results, int count)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		printf("Error: could not open %s\n", path);
+		return;
+	}
+	fprintf(file, "label,scenario,ticks,update_ns_per_tick,draw_ns_per_tick,total_ns_per_tick,bullets,asteroids,particles\n");
+	for (int i = 0; i < count; i++)
+	{
+		const BenchResult* r = &results[i];
+		BenchWriteCsvField(file, label);
+		fprintf(file, ",%s,%ld,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", r->scenario->name, r->ticks,
+				r->updateNs, r->drawNs, r->updateNs + r->drawNs, r->averageBullets, r->averageAsteroids, r->averageParticles);
+	}
+	fclose(file);
+}
+
+int main(int argc, char** argv)
+{
+	long ticks = 2000;
+	long warmup = 200;
+	bool draw = true;
+	bool phases = false;
+	const char* only = NULL;
+	const char* jsonPath = NULL;
+	const char* csvPath = NULL;
+	const char* label = "";
+	int workers = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) ticks = atol(argv[++i]);
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmup = atol(argv[++i]);
+		else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) only = argv[++i];
+		else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+		else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csvPath = argv[++i];
+		else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) label = argv[++i];
+		else if (strcmp(argv[i], "--no-draw") == 0) draw = false;
+		else if (strcmp(argv[i], "--phases") == 0) phases = true;
+		else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) workers = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--list") == 0)
+		{
+			for (int s = 0; s < BENCH_SCENARIO_COUNT; s++) printf("%-14s %s\n", benchScenarios[s].name, benchScenarios[s].description);
+			return 0;
+		}
+		else
+		{
+			printf("Usage: %s [--ticks N] [--warmup N] [--scenario NAME] [--no-draw] [--phases] [--jobs N] [--json FILE] [--csv FILE] [--label TEXT] [--list]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	GameState gameState = {0};
+	Options options = {0};
+	Audio audio = {0};
+	TextureAtlas atlas = {0};
+	SpriteMask spriteMasks[SPRITE_COUNT] = {0};
+	RenderTexture2D scene = {0};
+	RenderTexture2D litScene = {0};
+	Shader shader = {0};
+	Shader explosionShader = {0};
+	Shader lightShader = {0};
+	Shader outlineShader = {0};
+	Replay replay = {0};
+	Profiler profiler = {0};
+
+	GameMemory gameMemory = {0};
+	gameMemory.gameState = &gameState;
+	gameMemory.options = &options;
+	gameMemory.audio = &audio;
+	gameMemory.atlas = &atlas;
+	gameMemory.spriteMasks = spriteMasks;
+	gameMemory.scene = &scene;
+	gameMemory.litScene = &litScene;
+	gameMemory.shader = &shader;
+	gameMemory.explosionShader = &explosionShader;
+	gameMemory.lightShader = &lightShader;
+	gameMemory.outlineShader = &outlineShader;
+	gameMemory.replay = &replay;
+	gameMemory.profiler = &profiler;
+	// Entity storage, carved by the game at the capacities in config.ini
+	void* arenaMemory = calloc(1, GAME_ARENA_SIZE);
+	MemoryArena arena;
+	ArenaInit(&arena, arenaMemory, GAME_ARENA_SIZE);
+	gameMemory.arena = &arena;
+	JobSystem jobs;
+	JobSystemStart(&jobs, workers);
+	gameMemory.jobs = &jobs;
+
+	InitGame(&gameMemory);
+	if (!spriteMasks[SPRITE_PLAYER].bits || atlas.textureAtlas.width == 0)
+	{
+		printf("Failed to load the texture atlas, run from the repository root\n");
+		return 1;
+	}
+	options.tickRate = BENCH_TICK_RATE;
+
+	BenchResult results[BENCH_MAX_SCENARIOS];
+	BenchResult serial[BENCH_MAX_SCENARIOS];
+	int resultCount = 0;
+	if (jobs.workerCount > 0) printf("job system: %d worker threads\n", jobs.workerCount);
+	printf("%-14s %10s %12s %12s %12s %9s %9s %9s\n", "scenario", "ticks", "update ns", "draw ns", "total ns", "bullets", "asteroids", "particles");
+	for (int s = 0; s < BENCH_SCENARIO_COUNT; s++)
+	{
+		if (only && strcmp(only, benchScenarios[s].name) != 0) continue;
+		if (jobs.workerCount > 0)
+		{
+			gameMemory.jobs = NULL;
+			serial[resultCount] = BenchRun(&gameMemory, &benchScenarios[s], warmup, ticks, draw);
+			gameMemory.jobs = &jobs;
+		}
+		BenchResult r = BenchRun(&gameMemory, &benchScenarios[s], warmup, ticks, draw);
+		results[resultCount++] = r;
+		printf("%-14s %10ld %12.0f %12.0f %12.0f %9.1f %9.1f %9.1f\n", r.scenario->name, r.ticks,
+				r.updateNs, r.drawNs, r.updateNs + r.drawNs, r.averageBullets, r.averageAsteroids, r.averageParticles);
+	}
+	if (resultCount == 0)
+	{
+		printf("Unknown scenario '%s', see --list\n", only);
+		return 1;
+	}
+	if (jobs.workerCount > 0)
+	{
+		// Collision passes: the enemy one is timed together with the enemy update
+		printf("\n%-14s %12s %12s %8s %14s %14s %8s\n", "speedup", "serial ns", "jobs ns", "update",
+				"serial coll ns", "jobs coll ns", "coll");
+		for (int i = 0; i < resultCount; i++)
+		{
+			const BenchResult* a = &serial[i];
+			const BenchResult* b = &results[i];
+			const double serialCollision = a->phaseNs[PROFILE_PLAYER_COLLISION] + a->phaseNs[PROFILE_ASTEROID_COLLISION];
+			const double jobsCollision = b->phaseNs[PROFILE_PLAYER_COLLISION] + b->phaseNs[PROFILE_ASTEROID_COLLISION];
+			printf("%-14s %12.0f %12.0f %7.2fx %14.0f %14.0f %7.2fx", b->scenario->name, a->updateNs, b->updateNs,
+					b->updateNs > 0.0 ? a->updateNs / b->updateNs : 0.0, serialCollision, jobsCollision,
+					jobsCollision > 0.0 ? serialCollision / jobsCollision : 0.0);
+			// Same seed and ticks, the jobs have to find exactly the pairs the serial path found
+			if (memcmp(a->counters, b->counters, sizeof(a->counters)) != 0) printf("  collision counters differ");
+			printf("\n");
+		}
+	}
+	if (phases)
+	{
+		printf("\n%-22s", "phase ns/tick");
+		for (int i = 0; i < resultCount; i++) printf(" %14s", results[i].scenario->name);
+		printf("\n");
+		for (int phase = 0; phase < PROFILE_COUNT; phase++)
+		{
+			printf("%s%-*s", ProfileIsTotal(phase) ? "" : "  ", ProfileIsTotal(phase) ? 22 : 20, ProfilePhaseName((ProfilePhase)phase));
+			for (int i = 0; i < resultCount; i++) printf(" %14.0f", results[i].phaseNs[phase]);
+			printf("\n");
+		}
+		printf("\n%-22s", "collision pairs/tick");
+		for (int i = 0; i < resultCount; i++) printf(" %14s", results[i].scenario->name);
+		printf("\n");
+		for (int counter = 0; counter < PROFILE_COUNTER_COUNT; counter++)
+		{
+			printf("  %-20s", ProfileCounterName((ProfileCounter)counter));
+			for (int i = 0; i < resultCount; i++) printf(" %14.1f", results[i].counters[counter]);
+			printf("\n");
+		}
+	}
+	if (jsonPath) BenchWriteJson(jsonPath, label, results, resultCount);
+	if (csvPath) BenchWriteCsv(csvPath, label, results, resultCount);
+
+	Cleanup(&gameMemory);
+	JobSystemStop(&jobs);
+	free(arenaMemory);
+	return 0;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "raylib.h"
+
+// Integrate-and-cull kernel for the bullet columns. One pass moves every
+// bullet, rebuilds its collider and writes a packed alive mask (bit i set
+// while bullet i still overlaps the bounds). All bullets share one sprite, so
+// the frame size is passed in once instead of looked up per bullet. Bullets
+// never spin, the rotation column is left alone.
+//
+// Positions, velocities and colliders are the interleaved Archetype columns
+// (x, y, x, y, ...), which map directly onto SIMD lanes: SSE2 handles two
+// bullets per step, AVX four. Every variant does the same float operations
+// in the same order, so they agree bit for bit with each other and with
+// ArchetypeCollider/CullSystem.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define BULLET_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+#define BULLET_MASK_WORDS(count) (((count) + 63) / 64)
+
+typedef int (*BulletKernelFunc)(Vector2* position, const Vector2* velocity, const float* size,
+		Rectangle* collider, uint64_t* alive, int count, float dt, Vector2 halfFrame, Rectangle bounds);
+
+typedef enum BulletKernelKind
+{
+	BULLET_KERNEL_SCALAR,
+	BULLET_KERNEL_SSE2,
+	BULLET_KERNEL_AVX,
+	BULLET_KERNEL_COUNT,
+} BulletKernelKind;
+
+static inline const char* BulletKernelName(BulletKernelKind kind)
+{
+	static const char* names[BULLET_KERNEL_COUNT] = {
+		[BULLET_KERNEL_SCALAR] = "scalar",
+		[BULLET_KERNEL_SSE2]   = "sse2",
+		[BULLET_KERNEL_AVX]    = "avx",
+	};
+	return names[kind];
+}
+
+// Handles bullets first..count-1, also the tail of the SIMD variants
+static inline int BulletKernelScalarFrom(Vector2* position, const Vector2* velocity, const float* size,
+		Rectangle* collider, uint64_t* alive, int first, int count, float dt, Vector2 halfFrame, Rectangle bounds)
+{
+	const float right = bounds.x + bounds.width;
+	const float bottom = bounds.y + bounds.height;
+	int aliveCount = 0;
+	for (int i = first; i < count; i++)
+	{
+		Vector2 p = position[i];
+		p.x += velocity[i].x * dt;
+		p.y += velocity[i].y * dt;
+		position[i] = p;
+		const float halfWidth = halfFrame.x * size[i];
+		const float halfHeight = halfFrame.y * size[i];
+		const Rectangle c = {p.x - halfWidth, p.y - halfHeight, halfWidth + halfWidth, halfHeight + halfHeight};
+		collider[i] = c;
+		const bool inside = !(c.x > right || c.x + c.width < bounds.x || c.y > bottom || c.y + c.height < bounds.y);
+		alive[i >> 6] |= (uint64_t)inside << (i & 63);
+		aliveCount += inside;
+	}
+	return aliveCount;
+}
+
+static inline int BulletKernelScalar(Vector2* position, const Vector2* velocity, const float* size,
+		Rectangle* collider, uint64_t* alive, int count, float dt, Vector2 halfFrame, Rectangle bounds)
+{
+	memset(alive, 0, BULLET_MASK_WORDS(count) * sizeof(uint64_t));
+	return BulletKernelScalarFrom(position, velocity, size, collider, alive, 0, count, dt, halfFrame, bounds);
+}
+
+#ifdef BULLET_KERNEL_X86
+// Two bullets per step: lanes are (x0, y0, x1, y1)
+static inline int BulletKernelSse2(Vector2* position, const Vector2* velocity, const float* size,
+		Rectangle* collider, uint64_t* alive, int count, float dt, Vector2 halfFrame, Rectangle bounds)
+{
+	memset(alive, 0, BULLET_MASK_WORDS(count) * sizeof(uint64_t));
+	const __m128 dtv = _mm_set1_ps(dt);
+	const __m128 half = _mm_setr_ps(halfFrame.x, halfFrame.y, halfFrame.x, halfFrame.y);
+	const __m128 lower = _mm_setr_ps(bounds.x, bounds.y, bounds.x, bounds.y);
+	const __m128 upper = _mm_setr_ps(bounds.x + bounds.width, bounds.y + bounds.height, bounds.x + bounds.width, bounds.y + bounds.height);
+	int aliveCount = 0;
+	int i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128 p = _mm_loadu_ps(&position[i].x);
+		p = _mm_add_ps(p, _mm_mul_ps(_mm_loadu_ps(&velocity[i].x), dtv));
+		_mm_storeu_ps(&position[i].x, p);
+
+		__m128 s = _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)&size[i]));
+		s = _mm_unpacklo_ps(s, s); // (s0, s0, s1, s1)
+		const __m128 extent = _mm_mul_ps(half, s);
+		const __m128 minimum = _mm_sub_ps(p, extent);
+		const __m128 full = _mm_add_ps(extent, extent);
+		_mm_storeu_ps(&collider[i].x, _mm_movelh_ps(minimum, full));
+		_mm_storeu_ps(&collider[i + 1].x, _mm_movehl_ps(full, minimum));
+
+		const __m128 outside = _mm_or_ps(_mm_cmpgt_ps(minimum, upper), _mm_cmplt_ps(_mm_add_ps(minimum, full), lower));
+		const int lanes = _mm_movemask_ps(outside);
+		const uint64_t bits = (uint64_t)((lanes & 0x3) == 0) | ((uint64_t)((lanes & 0xC) == 0) << 1);
+		alive[i >> 6] |= bits << (i & 63);
+		aliveCount += (int)(bits & 1) + (int)(bits >> 1);
+	}
+	return aliveCount + BulletKernelScalarFrom(position, velocity, size, collider, alive, i, count, dt, halfFrame, bounds);
+}
+
+// Four bullets per step: lanes are (x0, y0, x1, y1, x2, y2, x3, y3)
+__attribute__((target("avx")))
+static int BulletKernelAvx(Vector2* position, const Vector2* velocity, const float* size,
+		Rectangle* collider, uint64_t* alive, int count, float dt, Vector2 halfFrame, Rectangle bounds)
+{
+	memset(alive, 0, BULLET_MASK_WORDS(count) * sizeof(uint64_t));
+	const __m256 dtv = _mm256_set1_ps(dt);
+	const __m256 half = _mm256_setr_ps(halfFrame.x, halfFrame.y, halfFrame.x, halfFrame.y, halfFrame.x, halfFrame.y, halfFrame.x, halfFrame.y);
+	const float right = bounds.x + bounds.width;
+	const float bottom = bounds.y + bounds.height;
+	const __m256 lower = _mm256_setr_ps(bounds.x, bounds.y, bounds.x, bounds.y, bounds.x, bounds.y, bounds.x, bounds.y);
+	const __m256 upper = _mm256_setr_ps(right, bottom, right, bottom, right, bottom, right, bottom);
+	int aliveCount = 0;
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m256 p = _mm256_loadu_ps(&position[i].x);
+		p = _mm256_add_ps(p, _mm256_mul_ps(_mm256_loadu_ps(&velocity[i].x), dtv));
+		_mm256_storeu_ps(&position[i].x, p);
+
+		const __m128 s = _mm_loadu_ps(&size[i]);
+		const __m256 sizes = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(s, s)), _mm_unpackhi_ps(s, s), 1);
+		const __m256 extent = _mm256_mul_ps(half, sizes);
+		const __m256 minimum = _mm256_sub_ps(p, extent);
+		const __m256 full = _mm256_add_ps(extent, extent);
+		// Pair up (x, y) of the minimum with (width, height) as 64-bit halves:
+		// even gives the rects of bullets 0 and 2, odd those of 1 and 3
+		const __m256d even = _mm256_unpacklo_pd(_mm256_castps_pd(minimum), _mm256_castps_pd(full));
+		const __m256d odd = _mm256_unpackhi_pd(_mm256_castps_pd(minimum), _mm256_castps_pd(full));
+		_mm256_storeu_pd((double*)&collider[i].x, _mm256_permute2f128_pd(even, odd, 0x20));
+		_mm256_storeu_pd((double*)&collider[i + 2].x, _mm256_permute2f128_pd(even, odd, 0x31));
+
+		const __m256 outside = _mm256_or_ps(_mm256_cmp_ps(minimum, upper, _CMP_GT_OQ),
+				_mm256_cmp_ps(_mm256_add_ps(minimum, full), lower, _CMP_LT_OQ));
+		const int lanes = _mm256_movemask_ps(outside);
+		uint64_t bits = 0;
+		for (int b = 0; b < 4; b++)
+		{
+			bits |= (uint64_t)(((lanes >> (2 * b)) & 0x3) == 0) << b;
+		}
+		alive[i >> 6] |= bits << (i & 63);
+		aliveCount += __builtin_popcountll(bits);
+	}
+	return aliveCount + BulletKernelScalarFrom(position, velocity, size, collider, alive, i, count, dt, halfFrame, bounds);
+}
+#endif
+
+static inline bool BulletKernelSupported(BulletKernelKind kind)
+{
+	switch (kind)
+	{
+		case BULLET_KERNEL_SCALAR: return true;
+#ifdef BULLET_KERNEL_X86
+		case BULLET_KERNEL_SSE2: return true;
+		case BULLET_KERNEL_AVX: return __builtin_cpu_supports("avx");
+#endif
+		default: return false;
+	}
+}
+
+static inline BulletKernelFunc BulletKernelGet(BulletKernelKind kind)
+{
+	switch (kind)
+	{
+#ifdef BULLET_KERNEL_X86
+		case BULLET_KERNEL_SSE2: return BulletKernelSse2;
+		case BULLET_KERNEL_AVX: return BulletKernelAvx;
+#endif
+		default: return BulletKernelScalar;
+	}
+}
+
+// Widest variant the CPU running the game supports
+static inline BulletKernelKind BulletKernelBest(void)
+{
+	for (int kind = BULLET_KERNEL_COUNT - 1; kind > BULLET_KERNEL_SCALAR; kind--)
+	{
+		if (BulletKernelSupported((BulletKernelKind)kind)) return (BulletKernelKind)kind;
+	}
+	return BULLET_KERNEL_SCALAR;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "raylib.h"
+
+// FNV-1a style hash over 32-bit words, used for the per-tick GameState
+// checksum. Values are fed field by field (never whole structs), so padding
+// and pointers never reach the hash and equal simulations hash equal.
+#define CHECKSUM_SEED (0xCBF29CE484222325ull)
+#define CHECKSUM_PRIME (0x100000001B3ull)
+
+static inline uint64_t ChecksumU32(uint64_t hash, uint32_t value)
+{
+	return (hash ^ value) * CHECKSUM_PRIME;
+}
+
+static inline uint64_t ChecksumU64(uint64_t hash, uint64_t value)
+{
+	hash = ChecksumU32(hash, (uint32_t)value);
+	return ChecksumU32(hash, (uint32_t)(value >> 32));
+}
+
+static inline uint64_t ChecksumInt(uint64_t hash, int value)
+{
+	return ChecksumU32(hash, (uint32_t)value);
+}
+
+// Bit pattern, not value: a checksum must notice any difference at all
+static inline uint64_t ChecksumFloat(uint64_t hash, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return ChecksumU32(hash, bits);
+}
+
+static inline uint64_t ChecksumVector2(uint64_t hash, Vector2 value)
+{
+	hash = ChecksumFloat(hash, value.x);
+	return ChecksumFloat(hash, value.y);
+}
+
+static inline uint64_t ChecksumRectangle(uint64_t hash, Rectangle value)
+{
+	hash = ChecksumFloat(hash, value.x);
+	hash = ChecksumFloat(hash, value.y);
+	hash = ChecksumFloat(hash, value.width);
+	return ChecksumFloat(hash, value.height);
+}
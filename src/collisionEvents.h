@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "audio.h"
+#include "arena.h"
+#include "pool.h"
+
+// Hits found by the collision passes. Detection only appends events, it does
+// not change the entities, play sounds or spawn anything. A resolve step
+// right after each pass applies the events in the order they were found:
+// damage, removals, score, explosions and emitters. An event whose entities
+// were used up by an earlier one (a bullet already spent, an asteroid already
+// dying, the player turned invulnerable) is skipped, so the outcome is the
+// same as applying every hit the moment it was found.
+//
+// A pass split into detection jobs gives every job a queue of its own and
+// merges them in target order, so the events come out as a single loop over
+// the targets would have emitted them.
+//
+// Sounds triggered while resolving are only marked, every marked sound plays
+// once when the tick's collisions are done, however many hits asked for it.
+//
+// The queues are carved from the arena at a capacity the game derives from
+// the pool limits. Hits that find a queue full are counted in dropped.
+
+// Detection jobs a collision pass is split into at most
+#define COLLISION_JOB_CHUNKS (8)
+
+typedef enum CollisionKind
+{
+	COLLISION_BULLET_ENEMY,
+	COLLISION_BULLET_PLAYER,
+	COLLISION_BULLET_ASTEROID,
+	COLLISION_ASTEROID_PLAYER,
+	COLLISION_BOOST_PLAYER,
+} CollisionKind;
+
+typedef struct CollisionEvent {
+	Vector2 point;   // bullet position at the hit
+	uint16_t source; // dense index of the bullet, asteroid or boost
+	uint16_t target; // dense index of the enemy or asteroid hit by a bullet
+	uint8_t kind;
+} CollisionEvent;
+
+typedef struct CollisionEvents {
+	int count;
+	int capacity;
+	long dropped; // events that found the queue full, over the game
+	bool sounds[SOUND_COUNT];
+	CollisionEvent* events;
+} CollisionEvents;
+
+static inline bool CollisionEventsInit(CollisionEvents* queue, MemoryArena* arena, int capacity)
+{
+	memset(queue, 0, sizeof(*queue));
+	queue->capacity = capacity;
+	queue->events = (CollisionEvent*)ArenaPush(arena, capacity * sizeof(CollisionEvent));
+	return queue->events != NULL;
+}
+
+static inline void CollisionEventsRelocate(CollisionEvents* queue, ptrdiff_t delta)
+{
+	ARENA_RELOCATE(queue->events, delta);
+}
+
+static inline void CollisionEmit(CollisionEvents* queue, CollisionKind kind, int source, int target, Vector2 point)
+{
+	if (queue->count == queue->capacity)
+	{
+		queue->dropped++;
+		return;
+	}
+	queue->events[queue->count++] = (CollisionEvent){
+		.point = point,
+		.source = (uint16_t)source,
+		.target = (uint16_t)target,
+		.kind = (uint8_t)kind,
+	};
+}
+
+// Appends the events another queue collected, in its order, as if emitted one by one
+static inline void CollisionMerge(CollisionEvents* queue, const CollisionEvents* part)
+{
+	const int space = queue->capacity - queue->count;
+	const int count = part->count < space ? part->count : space;
+	memcpy(&queue->events[queue->count], part->events, count * sizeof(CollisionEvent));
+	queue->count += count;
+	queue->dropped += part->dropped + part->count - count;
+}
+
+static inline void CollisionQueueSound(CollisionEvents* queue, SoundId sound)
+{
+	queue->sounds[sound] = true;
+}
@@ -1,5 +1,19 @@
 #include "game.h"
 #include <raylib.h>
+#include <time.h>
+
+// Capacity keys are "<pool name>Capacity capacity [limit]"
+static void LoadPoolConfig(Options* options, const char* key, int capacity, int limit)
+{
+	for (int kind = 0; kind < POOL_KIND_COUNT; kind++)
+	{
+		const char* name = PoolName((PoolKind)kind);
+		if (strncmp(key, name, strlen(name)) != 0 || strcmp(key + strlen(name), "Capacity") != 0) continue;
+		capacity = PoolClampCapacity(capacity);
+		options->pools[kind] = (PoolConfig){capacity, MAX(capacity, PoolClampCapacity(limit))};
+		return;
+	}
+}
 
 void LoadIniFile(Options* options)
 {
@@ -20,6 +34,8 @@ void LoadIniFile(Options* options)
 		if (sscanf(line, "%63s %f %f", key, &v1, &v2) == 3) {
 			if (strcmp(key, "windowPosition") == 0) {
 				options->windowPosition = (Vector2){v1, v2};
+			} else {
+				LoadPoolConfig(options, key, (int)v1, (int)v2);
 			}
 		}
 		// Try parsing 2 values (for single floats)
@@ -28,6 +44,10 @@ void LoadIniFile(Options* options)
 				options->musicVolume = v1;
 			} else if (strcmp(key, "fxVolume") == 0) {
 				options->fxVolume = v1;
+			} else if (strcmp(key, "tickRate") == 0) {
+				options->tickRate = Clamp((int)v1, MIN_TICK_RATE, MAX_TICK_RATE);
+			} else {
+				LoadPoolConfig(options, key, (int)v1, (int)v1);
 			}
 		}
 	}
@@ -45,6 +65,11 @@ void WriteIniFile(Options* options)
 	fprintf(file, "windowPosition %d %d\n", (int)options->windowPosition.x, (int)options->windowPosition.y);
 	fprintf(file, "musicVolume %f\n", options->musicVolume);
 	fprintf(file, "fxVolume %f\n", options->fxVolume);
+	fprintf(file, "tickRate %d\n", options->tickRate);
+	for (int kind = 0; kind < POOL_KIND_COUNT; kind++)
+	{
+		fprintf(file, "%sCapacity %d %d\n", PoolName((PoolKind)kind), options->pools[kind].capacity, options->pools[kind].limit);
+	}
 	fclose(file);
 }
 
@@ -66,9 +91,8 @@ Rectangle GetScaledViewport(int winW, int winH)
 	};
 }
 
-Vector2 GetVirtualMousePosition()
+Vector2 ScreenToVirtualPosition(Vector2 mouse)
 {
-	Vector2 mouse = GetMousePosition();
 	Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
 	float scale = viewport.width / VIRTUAL_WIDTH;
 	float letterBoxOffsetX = (GetRenderWidth()  - viewport.width)  / 2.0f;
@@ -80,21 +104,128 @@ Vector2 GetVirtualMousePosition()
 	return mouseVirtual;
 }
 
+Vector2 GetVirtualMousePosition()
+{
+	return ScreenToVirtualPosition(GetMousePosition());
+}
+
+// Input
+static inline bool InputDown(const GameInput* input, InputButton button)
+{
+	return (input->down >> button) & 1u;
+}
+
+static inline bool InputPressed(const GameInput* input, InputButton button)
+{
+	return (input->pressed >> button) & 1u;
+}
+
+// Samples the devices once per rendered frame. Presses accumulate until a
+// simulation tick consumes them, so frames that run no tick do not drop input.
+// The mouse is stored in virtual coordinates and resolved against the upgrade
+// cards here, so the simulation never depends on the window size.
+void PollGameInput(GameState* gameState)
+{
+	GameInput* input = &gameState->input;
+	const bool down[INPUT_COUNT] = {
+		[INPUT_UP]           = IsKeyDown(KEY_W),
+		[INPUT_DOWN]         = IsKeyDown(KEY_S),
+		[INPUT_LEFT]         = IsKeyDown(KEY_A),
+		[INPUT_RIGHT]        = IsKeyDown(KEY_D),
+		[INPUT_SHOOT]        = IsKeyDown(KEY_SPACE),
+		[INPUT_PAUSE]        = IsKeyDown(KEY_ESCAPE) || IsKeyDown(KEY_P),
+		[INPUT_CONFIRM]      = IsKeyDown(KEY_ENTER),
+		[INPUT_SELECT_LEFT]  = IsKeyDown(KEY_LEFT),
+		[INPUT_SELECT_RIGHT] = IsKeyDown(KEY_RIGHT),
+		[INPUT_CLICK]        = IsMouseButtonDown(MOUSE_BUTTON_LEFT),
+	};
+	const bool pressed[INPUT_COUNT] = {
+		[INPUT_UP]           = IsKeyPressed(KEY_W),
+		[INPUT_DOWN]         = IsKeyPressed(KEY_S),
+		[INPUT_LEFT]         = IsKeyPressed(KEY_A),
+		[INPUT_RIGHT]        = IsKeyPressed(KEY_D),
+		[INPUT_SHOOT]        = IsKeyPressed(KEY_SPACE),
+		[INPUT_PAUSE]        = IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_P),
+		[INPUT_CONFIRM]      = IsKeyPressed(KEY_ENTER),
+		[INPUT_SELECT_LEFT]  = IsKeyPressed(KEY_LEFT),
+		[INPUT_SELECT_RIGHT] = IsKeyPressed(KEY_RIGHT),
+		[INPUT_CLICK]        = IsMouseButtonPressed(MOUSE_BUTTON_LEFT),
+	};
+	input->down = 0;
+	for (int i = 0; i < INPUT_COUNT; i++)
+	{
+		if (down[i]) input->down |= 1u << i;
+		if (pressed[i]) input->pressed |= 1u << i;
+	}
+	Vector2 mouse = GetMousePosition();
+	input->mousePosition = ScreenToVirtualPosition(mouse);
+	input->hoveredUpgrade = -1;
+	for (int i = 0; i < UPGRADE_COUNT; i++)
+	{
+		if (CheckCollisionPointRec(mouse, gameState->upgradeCards[i].rect))
+		{
+			input->hoveredUpgrade = i;
+		}
+	}
+}
+
+// Trace captures are written next to screenshots, named by their start time
+void StartTraceCapture(GameMemory* gameMemory)
+{
+	TraceStart(&gameMemory->profiler->trace, PROFILER_CLOCK());
+	TraceLog(LOG_INFO, "Start trace capture");
+}
+
+void StopTraceCapture(GameMemory* gameMemory)
+{
+	Trace* trace = &gameMemory->profiler->trace;
+	time_t now = time(NULL);
+	struct tm *t = localtime(&now);
+	char buffer[100];
+	strftime(buffer, sizeof(buffer), "%Y-%m-%d-%H-%M-%S", t);
+	const char* path = TextFormat("bin/trace-%s.json", buffer);
+	if (TraceStop(trace, path))
+	{
+		TraceLog(LOG_INFO, "Saved trace with %u events to %s", trace->eventCount, path);
+	}
+}
+
+// One "tick checksum" line per simulated tick, two logs of the same replay
+// must be identical line by line
+void StartChecksumLog(GameMemory* gameMemory)
+{
+	time_t now = time(NULL);
+	struct tm *t = localtime(&now);
+	char buffer[100];
+	strftime(buffer, sizeof(buffer), "%Y-%m-%d-%H-%M-%S", t);
+	const char* path = TextFormat("bin/checksum-%s.log", buffer);
+	gameMemory->checksumLog = fopen(path, "w");
+	if (gameMemory->checksumLog == NULL)
+	{
+		printf("Error: could not open checksum log %s\n", path);
+		return;
+	}
+	TraceLog(LOG_INFO, "Logging tick checksums to %s", path);
+}
+
+void StopChecksumLog(GameMemory* gameMemory)
+{
+	fclose(gameMemory->checksumLog);
+	gameMemory->checksumLog = NULL;
+	TraceLog(LOG_INFO, "Stopped logging tick checksums");
+}
+
 void Cleanup(GameMemory* gameMemory) 
 {
 	UnloadShader(*gameMemory->shader);
 	UnloadShader(*gameMemory->lightShader);
 	UnloadShader(*gameMemory->explosionShader);
 	UnloadShader(*gameMemory->outlineShader);
-	for (int i = 0; i < ANIMATION_COUNT; i++)
-	{
-		FreeSpriteAnimation(gameMemory->atlas->animations[i]);
-	}
 	UnloadFont(gameMemory->options->font);
 	UnloadFont(gameMemory->options->titleFont);
 	for (int i = 0; i < SPRITE_COUNT; i++)
 	{
-		UnloadImageColors(gameMemory->spriteMasks[i].pixels);
+		freeSpriteMask(&gameMemory->spriteMasks[i]);
 	}
 	for (int i = 0; i < MUSIC_COUNT; i++)
 	{
@@ -111,6 +242,15 @@ void Cleanup(GameMemory* gameMemory)
 	{
 		GifRecordStop(&gameMemory->gameState->gifRecorder);
 	}
+	// Same for a running trace capture and checksum log
+	if (gameMemory->profiler->trace.capturing)
+	{
+		StopTraceCapture(gameMemory);
+	}
+	if (gameMemory->checksumLog)
+	{
+		StopChecksumLog(gameMemory);
+	}
 	CloseAudioDevice();
 }
 
@@ -152,14 +292,148 @@ void InitializeAudio(Audio* audio, Options* options)
 	SetFxVolume(audio, options->fxVolume);
 }
 
+// A pass finds at most a hit per bullet, asteroid and boost unless a bullet
+// overlaps several targets at once. Every detection job gets the same room,
+// one of them may find all of the pass's hits.
+static bool CarveCollisionQueues(GameState* gameState)
+{
+	const PoolConfig* pools = gameState->pools;
+	const int capacity = pools[POOL_BULLETS].limit + pools[POOL_ASTEROIDS].limit + pools[POOL_BOOSTS].limit;
+	if (!CollisionEventsInit(&gameState->collisions, gameState->arena, capacity)) return false;
+	for (int chunk = 0; chunk < COLLISION_JOB_CHUNKS; chunk++)
+	{
+		if (!CollisionEventsInit(&gameState->collisionChunks[chunk], gameState->arena, capacity)) return false;
+	}
+	return true;
+}
+
+// Storage of every pool, carved from the arena at the capacities in
+// gameState->pools. False if the arena is too small for them.
+static bool CarveEntityStorage(GameState* gameState)
+{
+	MemoryArena* arena = gameState->arena;
+	const PoolConfig* pools = gameState->pools;
+	ArenaReset(arena);
+	gameState->particleEmitterCapacity = PoolClampCapacity(pools[POOL_EMITTERS].capacity);
+	return ArchetypeInit(&gameState->bullets, arena, pools[POOL_BULLETS].capacity, (void**)&gameState->bulletData, sizeof(Bullet))
+		&& ArchetypeInit(&gameState->asteroids, arena, pools[POOL_ASTEROIDS].capacity, (void**)&gameState->asteroidData, sizeof(Asteroid))
+		&& ArchetypeInit(&gameState->enemies, arena, pools[POOL_ENEMIES].capacity, (void**)&gameState->enemyData, sizeof(Enemy))
+		&& ArchetypeInit(&gameState->boosts, arena, pools[POOL_BOOSTS].capacity, NULL, 0)
+		&& PoolInit(&gameState->explosionPool, arena, pools[POOL_EXPLOSIONS].capacity)
+		&& (gameState->explosions = (Explosion*)ArenaPush(arena, gameState->explosionPool.capacity * sizeof(Explosion))) != NULL
+		&& (gameState->particleEmitters = (ParticleEmitter*)ArenaPush(arena, gameState->particleEmitterCapacity * sizeof(ParticleEmitter))) != NULL
+		// The broadphase is sized for the limits, so it never has to grow
+		&& SpatialHashInit(&gameState->bulletHash, arena, pools[POOL_BULLETS].limit)
+		&& SpatialHashInit(&gameState->asteroidHash, arena, pools[POOL_ASTEROIDS].limit)
+		&& SpatialHashInit(&gameState->boostHash, arena, pools[POOL_BOOSTS].limit)
+		&& CarveCollisionQueues(gameState);
+}
+
+static int PoolKindCapacity(const GameState* gameState, PoolKind kind)
+{
+	switch (kind)
+	{
+		case POOL_BULLETS: return gameState->bullets.pool.capacity;
+		case POOL_ASTEROIDS: return gameState->asteroids.pool.capacity;
+		case POOL_EXPLOSIONS: return gameState->explosionPool.capacity;
+		case POOL_ENEMIES: return gameState->enemies.pool.capacity;
+		case POOL_BOOSTS: return gameState->boosts.pool.capacity;
+		case POOL_EMITTERS: return gameState->particleEmitterCapacity;
+		default: return 0;
+	}
+}
+
+// Moves the explosions or emitters to an array for capacity items, count of
+// them copied over. Leaves everything as it was if the arena is full.
+static void* GrowArray(MemoryArena* arena, void* items, int count, int capacity, size_t itemSize)
+{
+	void* grown = ArenaPush(arena, capacity * itemSize);
+	if (grown != NULL) memcpy(grown, items, count * itemSize);
+	return grown;
+}
+
+// A spawn found the pool full: doubles it up to its limit, or reports the
+// spawn as dropped. Returns whether there is room for the spawn now.
+static bool GrowPool(GameState* gameState, PoolKind kind)
+{
+	MemoryArena* arena = gameState->arena;
+	const int capacity = PoolKindCapacity(gameState, kind);
+	const int limit = gameState->pools[kind].limit;
+	const int grown = MIN(limit, 2 * capacity);
+	bool done = false;
+	if (grown > capacity)
+	{
+		const size_t mark = arena->used;
+		switch (kind)
+		{
+			case POOL_BULLETS:
+				done = ArchetypeGrow(&gameState->bullets, arena, grown, (void**)&gameState->bulletData, sizeof(Bullet));
+				break;
+			case POOL_ASTEROIDS:
+				done = ArchetypeGrow(&gameState->asteroids, arena, grown, (void**)&gameState->asteroidData, sizeof(Asteroid));
+				break;
+			case POOL_ENEMIES:
+				done = ArchetypeGrow(&gameState->enemies, arena, grown, (void**)&gameState->enemyData, sizeof(Enemy));
+				break;
+			case POOL_BOOSTS:
+				done = ArchetypeGrow(&gameState->boosts, arena, grown, NULL, 0);
+				break;
+			case POOL_EXPLOSIONS:
+			{
+				EntityPool pool = gameState->explosionPool;
+				Explosion* explosions = PoolGrow(&pool, arena, grown)
+					? GrowArray(arena, gameState->explosions, gameState->explosionCount, grown, sizeof(Explosion)) : NULL;
+				if (explosions == NULL) break;
+				gameState->explosionPool = pool;
+				gameState->explosions = explosions;
+				done = true;
+				break;
+			}
+			case POOL_EMITTERS:
+			{
+				ParticleEmitter* emitters = GrowArray(arena, gameState->particleEmitters, gameState->particleEmitterCount, grown, sizeof(ParticleEmitter));
+				if (emitters == NULL) break;
+				gameState->particleEmitters = emitters;
+				gameState->particleEmitterCapacity = grown;
+				done = true;
+				break;
+			}
+			default:
+				break;
+		}
+		if (done)
+		{
+			printf("The %s pool grew from %d to %d (limit %d), arena %zu of %zu KB used\n", PoolName(kind), capacity, grown, limit,
+					arena->used / 1024, arena->size / 1024);
+			return true;
+		}
+		arena->used = mark;
+	}
+	// Reported the first time in a game, GameState counts every one
+	if (gameState->poolExhausted[kind]++ == 0)
+	{
+		if (grown > capacity)
+		{
+			printf("The %s pool is full at %d and the arena has no room to grow it to %d (%zu of %zu KB used), spawns are dropped\n",
+					PoolName(kind), capacity, grown, arena->used / 1024, arena->size / 1024);
+		}
+		else
+		{
+			printf("The %s pool is full at its limit of %d, spawns are dropped (raise %sCapacity in config.ini)\n",
+					PoolName(kind), limit, PoolName(kind));
+		}
+	}
+	return false;
+}
+
 void SpawnEmitter(GameState* gameState, 
 		Vector2 pos, 
 		int maxParticleCount,
 		float spawnRate,
 		float lifetime,
-		Particle templateParticle)
+		ParticleTemplate particleTemplate)
 {
-	if (gameState->particleEmitterCount >= MAX_PARTICLE_EMITTERS) return;
+	if (gameState->particleEmitterCount >= gameState->particleEmitterCapacity && !GrowPool(gameState, POOL_EMITTERS)) return;
 
 	ParticleEmitter* e = &gameState->particleEmitters[gameState->particleEmitterCount++];
 	*e = (ParticleEmitter){0};
@@ -170,37 +444,39 @@ void SpawnEmitter(GameState* gameState,
 	e->maxParticleCount = maxParticleCount;
 	e->spawnRate = spawnRate;
 	e->lifetime = lifetime;
-	e->templateParticle = templateParticle;
+	e->particleTemplate = particleTemplate;
 }
 
-static void EmitParticle(ParticleEmitter* e)
+static void EmitParticle(ParticleEmitter* e, Rng* rng)
 {
 	if (e->particleCount >= e->maxParticleCount) return;
-	Particle particle = e->templateParticle;
-	float angle = GetRandomValue(e->templateParticle.angleRange.x, e->templateParticle.angleRange.y);
-	Vector2 acceleration = (Vector2){GetRandomValue(e->templateParticle.accelerationRange.x, e->templateParticle.accelerationRange.y),
-		GetRandomValue(e->templateParticle.accelerationRange.z, e->templateParticle.accelerationRange.w)};
+	const ParticleTemplate* t = &e->particleTemplate;
+	Particle particle = {0};
+	float angle = RngInt(rng, t->angleRange.x, t->angleRange.y);
+	Vector2 acceleration = (Vector2){RngInt(rng, t->accelerationRange.x, t->accelerationRange.y),
+		RngInt(rng, t->accelerationRange.z, t->accelerationRange.w)};
 
-	Vector2 position = (Vector2) {GetRandomValue(e->templateParticle.positionRange.x, e->templateParticle.positionRange.y),
-		GetRandomValue(e->templateParticle.positionRange.z, e->templateParticle.positionRange.w)};
+	Vector2 position = (Vector2) {RngInt(rng, t->positionRange.x, t->positionRange.y),
+		RngInt(rng, t->positionRange.z, t->positionRange.w)};
 
-	float angularVelocity = GetRandomValue(e->templateParticle.angularVelocityRange.x, e->templateParticle.angularVelocityRange.y);
-	float velocityX = (float)GetRandomValue(e->templateParticle.velocityRange.x, e->templateParticle.velocityRange.y);
-	float velocityY = (float)GetRandomValue(e->templateParticle.velocityRange.z, e->templateParticle.velocityRange.w);
-	float size = GetRandomValue(e->templateParticle.sizeRange.x, e->templateParticle.sizeRange.y);
+	float angularVelocity = RngInt(rng, t->angularVelocityRange.x, t->angularVelocityRange.y);
+	float velocityX = (float)RngInt(rng, t->velocityRange.x, t->velocityRange.y);
+	float velocityY = (float)RngInt(rng, t->velocityRange.z, t->velocityRange.w);
+	float size = RngInt(rng, t->sizeRange.x, t->sizeRange.y);
 
 	particle.position = position;
+	particle.previousPosition = position;
 	particle.velocity = (Vector2){velocityX, velocityY};
 	particle.acceleration = acceleration;
 	particle.angularVelocity = angularVelocity;
 	particle.rotation = angle;
 	particle.age = 0.0f;
-	particle.lifetime = 0.5f + (float)GetRandomValue(0, 50) / 100.0f;
+	particle.lifetime = 0.5f + (float)RngInt(rng, 0, 50) / 100.0f;
 
 	e->particles[e->particleCount++] = particle;
 }
 
-void UpdateEmitter(ParticleEmitter* e, float dt)
+void UpdateEmitter(ParticleEmitter* e, float dt, Rng* rng)
 {
 	if (e->lifetime > 0.0f && e->age >= 0.0f)
 	{
@@ -219,7 +495,7 @@ void UpdateEmitter(ParticleEmitter* e, float dt)
 		if (e->spawnTimer >= spawnInterval)
 		{
 			e->spawnTimer -= spawnInterval;
-			EmitParticle(e);
+			EmitParticle(e, rng);
 		}
 	}
 
@@ -252,12 +528,24 @@ void UpdateEmitters(GameState* gameState, float dt)
 			gameState->particleEmitters[i] = gameState->particleEmitters[--gameState->particleEmitterCount];
 			continue;
 		}
-		UpdateEmitter(e, dt);
+		UpdateEmitter(e, dt, &gameState->rng[RNG_PARTICLES]);
 	}
 }
 
-void InitializeGameState(GameState* gameState) 
+// Seed for the next run, drawn from the current one so a chain of restarts stays reproducible
+uint64_t NextGameSeed(GameState* gameState)
 {
+	uint64_t hi = RngNext(&gameState->rng[RNG_GAMEPLAY]);
+	uint64_t lo = RngNext(&gameState->rng[RNG_GAMEPLAY]);
+	return (hi << 32) | lo;
+}
+
+void InitializeGameState(GameState* gameState, uint64_t seed) 
+{
+	// The arena and the capacities outlive the reset, the storage is carved again
+	MemoryArena* arena = gameState->arena;
+	PoolConfig pools[POOL_KIND_COUNT];
+	memcpy(pools, gameState->pools, sizeof(pools));
 	*gameState = (GameState) {
 		.experience = 0,
 		.score = 0,
@@ -265,19 +553,11 @@ void InitializeGameState(GameState* gameState)
 		.lastState = STATE_MAIN_MENU,
 		.timeScale = 1.0f,
 		.player = {0},
-		.enemies = {0},
-		.enemyCount = 0,
 		.enemySpawnRate = 30.0f,
 		.enemySpawnTime = 25.0f,
-		.bullets = {0},
-		.bulletCount = 0,
-		.explosions = {0},
 		.explosionCount = 0,
-		.asteroids = {0},
-		.asteroidCount = 0,
 		.spawnTime = 0.0,
 		.asteroidSpawnRate = 0.2f,
-		.boostCount = 0,
 		.boostSpawnTime = 0.0f,
 		.boostSpawnRate = 10.0f,
 		.stars = {0},
@@ -294,7 +574,12 @@ void InitializeGameState(GameState* gameState)
 		.currentCollision = {0},
 		.stateChanged = true,
 		.particleEmitterCount = 0,
+		.seed = seed,
 	};
+	for (int i = 0; i < RNG_STREAM_COUNT; i++)
+	{
+		RngSeed(&gameState->rng[i], seed, (RngStream)i);
+	}
 
 	MsfGifState gifState = { 0 };
 	gameState->gifRecorder = (GifRecorder){ 
@@ -312,11 +597,12 @@ void InitializeGameState(GameState* gameState)
 	gameState->player = (Player) {
 		.velocity = 350,
 		.position = (Vector2){VIRTUAL_WIDTH / 2.0f, VIRTUAL_HEIGHT / 2.0f},
+		.previousPosition = (Vector2){VIRTUAL_WIDTH / 2.0f, VIRTUAL_HEIGHT / 2.0f},
 		.health = 7,
 		.bulletCount = 1,
-		.sprite = getSprite(SPRITE_PLAYER),
+		.sprite = SPRITE_PLAYER,
 		.size = 2,
-		.animationFrames = 5,
+		.animationFrames = SpriteNumFrames[SPRITE_PLAYER],
 		.invulTime = 0.0f,
 		.invulDuration = 3.0f,
 		.fireRate = 1.0f,
@@ -327,6 +613,69 @@ void InitializeGameState(GameState* gameState)
 		.level = 1,
 		.collider = (Rectangle){0,0,0,0},
 	};
+
+	gameState->arena = arena;
+	memcpy(gameState->pools, pools, sizeof(pools));
+	if (!CarveEntityStorage(gameState))
+	{
+		printf("The arena of %zu KB is too small for the configured capacities, using the defaults\n", arena->size / 1024);
+		memcpy(gameState->pools, defaultPoolConfigs, sizeof(defaultPoolConfigs));
+		ASSERT(CarveEntityStorage(gameState));
+	}
+}
+
+// Entity spawning, every addition goes through the entity's pool. Return
+// the dense index of the new entity, or -1 if there is no room left.
+int SpawnBullet(GameState* gameState, EntityComponents components, Bullet bullet)
+{
+	int index = ArchetypeSpawn(&gameState->bullets, components);
+	if (index < 0 && GrowPool(gameState, POOL_BULLETS)) index = ArchetypeSpawn(&gameState->bullets, components);
+	if (index < 0) return index;
+	gameState->bulletData[index] = bullet;
+	gameState->bulletMaxSpeed = fmaxf(gameState->bulletMaxSpeed, Vector2Length(components.velocity));
+	return index;
+}
+
+int SpawnAsteroid(GameState* gameState, EntityComponents components, Asteroid asteroid)
+{
+	int index = ArchetypeSpawn(&gameState->asteroids, components);
+	if (index < 0 && GrowPool(gameState, POOL_ASTEROIDS)) index = ArchetypeSpawn(&gameState->asteroids, components);
+	if (index >= 0) gameState->asteroidData[index] = asteroid;
+	return index;
+}
+
+int SpawnEnemy(GameState* gameState, EntityComponents components, Enemy enemy)
+{
+	int index = ArchetypeSpawn(&gameState->enemies, components);
+	if (index < 0 && GrowPool(gameState, POOL_ENEMIES)) index = ArchetypeSpawn(&gameState->enemies, components);
+	if (index >= 0) gameState->enemyData[index] = enemy;
+	return index;
+}
+
+int SpawnBoost(GameState* gameState, EntityComponents components)
+{
+	int index = ArchetypeSpawn(&gameState->boosts, components);
+	if (index < 0 && GrowPool(gameState, POOL_BOOSTS)) index = ArchetypeSpawn(&gameState->boosts, components);
+	return index;
+}
+
+Explosion* SpawnExplosion(GameState* gameState, Explosion explosion)
+{
+	int index = PoolAdd(&gameState->explosionPool, &gameState->explosionCount);
+	if (index < 0 && GrowPool(gameState, POOL_EXPLOSIONS)) index = PoolAdd(&gameState->explosionPool, &gameState->explosionCount);
+	if (index < 0) return NULL;
+	gameState->explosions[index] = explosion;
+	return &gameState->explosions[index];
+}
+
+// Frees everything removed during the tick, run once after UpdateGame
+void CompactEntities(GameState* gameState)
+{
+	ArchetypeCompact(&gameState->bullets, gameState->bulletData, sizeof(Bullet));
+	ArchetypeCompact(&gameState->asteroids, gameState->asteroidData, sizeof(Asteroid));
+	ArchetypeCompact(&gameState->enemies, gameState->enemyData, sizeof(Enemy));
+	ArchetypeCompact(&gameState->boosts, NULL, 0);
+	PoolCompact(&gameState->explosionPool, gameState->explosions, sizeof(Explosion), &gameState->explosionCount);
 }
 
 void InitializeOptions(Options* options) 
@@ -357,7 +706,11 @@ void InitializeOptions(Options* options)
 		.musicVolumeChanged = false,
 		.fxVolumeChanged = false,
 		.showDebugInfo = false,
+		.showProfiler = false,
+		.turboTicks = 0,
+		.tickRate = DEFAULT_TICK_RATE,
 	};
+	memcpy(options->pools, defaultPoolConfigs, sizeof(defaultPoolConfigs));
 	SetTextureFilter(options->font.texture, TEXTURE_FILTER_BILINEAR);
 	SetTextureFilter(options->titleFont.texture, TEXTURE_FILTER_BILINEAR);
 	GuiSetStyle(DEFAULT, TEXT_SIZE, 24);
@@ -373,6 +726,19 @@ void InitializeOptions(Options* options)
 	GuiSetFont(options->font);
 }
 
+// A restart after game over resets the options, but the debug and timing
+// settings carry over (turbo would otherwise stop at the first death)
+void RestartOptions(Options* options)
+{
+	const Options previous = *options;
+	InitializeOptions(options);
+	options->tickRate = previous.tickRate;
+	options->showDebugInfo = previous.showDebugInfo;
+	options->showProfiler = previous.showProfiler;
+	options->turboTicks = previous.turboTicks;
+	memcpy(options->pools, previous.pools, sizeof(previous.pools));
+}
+
 void InitGame(GameMemory* gameMemory)
 {
 	SetTargetFPS(TARGET_FPS);
@@ -410,41 +776,75 @@ void InitGame(GameMemory* gameMemory)
 	// Options options = {0};
 	GameState gameState = {0};
 	Audio audio = {0};
+	Profiler* profiler = gameMemory->profiler;
+	double assetStart = PROFILER_CLOCK();
 	InitializeOptions(gameMemory->options);
+	ProfileEvent(profiler, TRACE_ASSET, "options and fonts", assetStart);
 #ifndef PLATFORM_WEB
 	LoadIniFile(gameMemory->options);
 	SetWindowPosition((int)gameMemory->options->windowPosition.x, (int)gameMemory->options->windowPosition.y);
 #endif
-	InitializeGameState(gameMemory->gameState);
+	ASSERT(gameMemory->arena != NULL && gameMemory->arena->base != NULL);
+	gameMemory->gameState->arena = gameMemory->arena;
+	memcpy(gameMemory->gameState->pools, gameMemory->options->pools, sizeof(gameMemory->options->pools));
+	InitializeGameState(gameMemory->gameState, (uint64_t)time(NULL));
+	printf("Entity storage: %zu of %zu KB of the arena\n", gameMemory->arena->used / 1024, gameMemory->arena->size / 1024);
+	TraceLog(LOG_INFO, "Bullet kernel: %s", BulletKernelName(BulletKernelBest()));
+	assetStart = PROFILER_CLOCK();
 	InitializeAudio(gameMemory->audio, gameMemory->options);
+	ProfileEvent(profiler, TRACE_ASSET, "audio", assetStart);
 	// gameMemory->options = &options;
-	RenderTexture2D scene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
-	RenderTexture2D litScene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
-	SpriteMask spriteMasks[SPRITE_COUNT];
-	TextureAtlas atlas = initTextureAtlas(spriteMasks);
-	gameMemory->scene = &scene;
-	gameMemory->litScene = &litScene;
-
-	// Write the initialized state to gameMemory
-	gameMemory->atlas = &atlas;
-	gameMemory->spriteMasks = spriteMasks;
+	// Write the initialized state to the memory owned by the platform layer
+	*gameMemory->scene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
+	*gameMemory->litScene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
+	assetStart = PROFILER_CLOCK();
+	*gameMemory->atlas = initTextureAtlas(gameMemory->spriteMasks);
+	ProfileEvent(profiler, TRACE_ASSET, "texture atlas and masks", assetStart);
+	TextureAtlas* atlas = gameMemory->atlas;
 	gameMemory->options->previousWidth  = VIRTUAL_WIDTH;
 	gameMemory->options->previousHeight = VIRTUAL_HEIGHT;
 #ifndef PLATFORM_WEB
+	assetStart = PROFILER_CLOCK();
 	*gameMemory->shader = LoadShader(0, TextFormat("./src/shaders/default.glsl", GLSL_VERSION));
 	*gameMemory->lightShader = LoadShader(0, TextFormat("./src/shaders/light.glsl", GLSL_VERSION));
 	*gameMemory->explosionShader = LoadShader(0, TextFormat("./src/shaders/explode.glsl", GLSL_VERSION));
 	*gameMemory->outlineShader = LoadShader(0, TextFormat("./src/shaders/outline.glsl", GLSL_VERSION));
+	ProfileEvent(profiler, TRACE_ASSET, "shaders", assetStart);
 #endif
 	int texSizeLoc = GetShaderLocation(*gameMemory->shader, "textureSize");
-	Vector2 texSize = {(float)atlas.textureAtlas.width, (float)atlas.textureAtlas.height};
+	Vector2 texSize = {(float)atlas->textureAtlas.width, (float)atlas->textureAtlas.height};
 	SetShaderValue(*gameMemory->shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 	texSizeLoc = GetShaderLocation(*gameMemory->outlineShader, "textureSize");
-	texSize = (Vector2){(float)atlas.textureAtlas.width, (float)atlas.textureAtlas.height};
+	texSize = (Vector2){(float)atlas->textureAtlas.width, (float)atlas->textureAtlas.height};
 	SetShaderValue(*gameMemory->outlineShader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 	printf("InitGame done!\n");
 }
 
+// Points the storage pointers of a GameState at an arena that was copied
+// delta bytes away from the one they were carved from
+static void RelocateEntityStorage(GameState* gameState, ptrdiff_t delta)
+{
+	if (delta == 0) return;
+	ArchetypeRelocate(&gameState->bullets, delta);
+	ArchetypeRelocate(&gameState->asteroids, delta);
+	ArchetypeRelocate(&gameState->enemies, delta);
+	ArchetypeRelocate(&gameState->boosts, delta);
+	PoolRelocate(&gameState->explosionPool, delta);
+	ARENA_RELOCATE(gameState->bulletData, delta);
+	ARENA_RELOCATE(gameState->asteroidData, delta);
+	ARENA_RELOCATE(gameState->enemyData, delta);
+	ARENA_RELOCATE(gameState->explosions, delta);
+	ARENA_RELOCATE(gameState->particleEmitters, delta);
+	SpatialHashRelocate(&gameState->bulletHash, delta);
+	SpatialHashRelocate(&gameState->asteroidHash, delta);
+	SpatialHashRelocate(&gameState->boostHash, delta);
+	CollisionEventsRelocate(&gameState->collisions, delta);
+	for (int chunk = 0; chunk < COLLISION_JOB_CHUNKS; chunk++)
+	{
+		CollisionEventsRelocate(&gameState->collisionChunks[chunk], delta);
+	}
+}
+
 void loadSaveState(GameMemory* gameMemory)
 {
 	FILE* file = fopen("save.dat", "rb");
@@ -453,8 +853,34 @@ void loadSaveState(GameMemory* gameMemory)
 		printf("Error: could not open savestate file\n");
 		return;
 	}
-	fread(gameMemory->gameState, sizeof(GameState), 1, file);
+	// The GameState, then the arena it points into and where that arena was
+	GameState* gameState = gameMemory->gameState;
+	MemoryArena* arena = gameMemory->arena;
+	GameState loaded;
+	unsigned char* savedBase;
+	size_t used;
+	if (fread(&loaded, sizeof(GameState), 1, file) != 1
+		|| fread(&savedBase, sizeof(savedBase), 1, file) != 1
+		|| fread(&used, sizeof(used), 1, file) != 1
+		|| used > arena->size)
+	{
+		printf("Error: savestate is damaged or needs a larger arena than %zu KB\n", arena->size / 1024);
+		fclose(file);
+		return;
+	}
+	const bool ok = fread(arena->base, 1, used, file) == used;
 	fclose(file);
+	if (!ok)
+	{
+		// Part of the arena was overwritten, start over rather than run on half a state
+		printf("Error: savestate is damaged\n");
+		InitializeGameState(gameState, NextGameSeed(gameState));
+		return;
+	}
+	*gameState = loaded;
+	arena->used = used;
+	gameState->arena = arena;
+	RelocateEntityStorage(gameState, arena->base - savedBase);
 }
 
 void writeSaveState(GameMemory* gameMemory)
@@ -466,14 +892,99 @@ void writeSaveState(GameMemory* gameMemory)
 		return;
 	}
 	fwrite(gameMemory->gameState, sizeof(GameState), 1, file);
+	fwrite(&gameMemory->arena->base, sizeof(gameMemory->arena->base), 1, file);
+	fwrite(&gameMemory->arena->used, sizeof(gameMemory->arena->used), 1, file);
+	fwrite(gameMemory->arena->base, 1, gameMemory->arena->used, file);
 	fclose(file);
 }
 
+// Unrotated masks sample whole mask columns and rows, so the path below
+// works on bit rows over the overlap instead of single pixels
+#define MASK_ROW_MAX_PIXELS (1024)
+#define MASK_ROW_WORDS (MASK_ROW_MAX_PIXELS / 64)
+#define MASK_MAX_WIDTH (256)
+
+// Mask column (or row) sampled at a screen coordinate, the same float
+// operations as the rotated path with the sine term being zero
+static inline int MaskSample(float screen, float center, float cosine, float half, float scale)
+{
+	float local = cosine * (screen - center);
+	local += half;
+	return (int)(local * scale);
+}
+
+// First bit at or after from that equals value, limit if there is none
+static inline int MaskRowFind(const uint64_t* row, int from, int limit, bool value)
+{
+	for (int word = from >> 6; (word << 6) < limit; word++)
+	{
+		uint64_t bits = value ? row[word] : ~row[word];
+		if (word == from >> 6) bits &= ~(uint64_t)0 << (from & 63);
+		if (bits != 0)
+		{
+			const int index = (word << 6) + __builtin_ctzll(bits);
+			return index < limit ? index : limit;
+		}
+	}
+	return limit;
+}
+
+static inline void MaskRowSetRange(uint64_t* row, int from, int to)
+{
+	for (int word = from >> 6; word <= (to - 1) >> 6 && from < to; word++)
+	{
+		uint64_t bits = ~(uint64_t)0;
+		if (word == from >> 6) bits &= ~(uint64_t)0 << (from & 63);
+		if (word == (to - 1) >> 6) bits &= ~(uint64_t)0 >> (63 - ((to - 1) & 63));
+		row[word] |= bits;
+	}
+}
+
+typedef struct MaskColumns {
+	// first[u] is the first overlap column sampling mask column u or a later one
+	int16_t first[MASK_MAX_WIDTH + 1];
+	int rowScreen;
+	float rowCenter, cosine, rowHalf, rowScale;
+} MaskColumns;
+
+static void MaskColumnsInit(MaskColumns* columns, const SpriteMask* mask, Rectangle dst, Vector2 center,
+		float cosine, float scaleX, float scaleY, int ox, int oy, int ow)
+{
+	// Samples only grow with x, the first column reaching u ends every run of lower ones
+	int u = 0;
+	for (int x = 0; x < ow && u <= mask->width; x++)
+	{
+		const int sample = MaskSample(ox + x, center.x, cosine, dst.width * 0.5f, scaleX);
+		while (u <= sample && u <= mask->width) columns->first[u++] = (int16_t)x;
+	}
+	while (u <= mask->width) columns->first[u++] = (int16_t)ow;
+	columns->rowScreen = oy;
+	columns->rowCenter = center.y;
+	columns->cosine = cosine;
+	columns->rowHalf = dst.height * 0.5f;
+	columns->rowScale = scaleY;
+}
+
+// Opaque pixels of the mask row sampled by overlap row y, as a bit row over
+// the overlap columns. Every opaque run of the mask row is one range.
+static bool MaskOverlapRow(const SpriteMask* mask, const MaskColumns* columns, int y, uint64_t* out, int words)
+{
+	memset(out, 0, words * sizeof(uint64_t));
+	const int v = MaskSample(columns->rowScreen + y, columns->rowCenter, columns->cosine, columns->rowHalf, columns->rowScale);
+	if (v < 0 || v >= mask->height) return false;
+	const uint64_t* row = &mask->bits[v * mask->wordsPerRow];
+	for (int u = MaskRowFind(row, 0, mask->width, true); u < mask->width; )
+	{
+		const int end = MaskRowFind(row, u, mask->width, false);
+		MaskRowSetRange(out, columns->first[u], columns->first[end]);
+		u = MaskRowFind(row, end, mask->width, true);
+	}
+	return true;
+}
+
 bool pixelPerfectCollision(
-		Color* pixel1,
-		Color* pixel2,
-		int width1, int width2,
-		int height1, int height2,
+		const SpriteMask* mask1,
+		const SpriteMask* mask2,
 		Rectangle dst1, Rectangle dst2,
 		Rectangle overlap,
 		float rotationDeg1,
@@ -483,6 +994,9 @@ bool pixelPerfectCollision(
 	if (overlap.width <= 0 || overlap.height <= 0)
 		return false;
 
+	const int width1 = mask1->width, height1 = mask1->height;
+	const int width2 = mask2->width, height2 = mask2->height;
+
 	// Screen -> texture scale
 	const float sx1 = (float)width1  / dst1.width;
 	const float sy1 = (float)height1 / dst1.height;
@@ -511,6 +1025,26 @@ bool pixelPerfectCollision(
 	int ow = (int)ceilf(overlap.width);
 	int oh = (int)ceilf(overlap.height);
 
+	if (sin1 == 0.0f && sin2 == 0.0f && cos1 > 0.0f && cos2 > 0.0f
+			&& ow <= MASK_ROW_MAX_PIXELS && width1 <= MASK_MAX_WIDTH && width2 <= MASK_MAX_WIDTH)
+	{
+		MaskColumns columns1, columns2;
+		MaskColumnsInit(&columns1, mask1, dst1, center1, cos1, sx1, sy1, ox, oy, ow);
+		MaskColumnsInit(&columns2, mask2, dst2, center2, cos2, sx2, sy2, ox, oy, ow);
+		const int words = (ow + 63) / 64;
+		uint64_t row1[MASK_ROW_WORDS], row2[MASK_ROW_WORDS];
+		for (int y = 0; y < oh; y++)
+		{
+			if (!MaskOverlapRow(mask1, &columns1, y, row1, words)) continue;
+			if (!MaskOverlapRow(mask2, &columns2, y, row2, words)) continue;
+			for (int word = 0; word < words; word++)
+			{
+				if (row1[word] & row2[word]) return true;
+			}
+		}
+		return false;
+	}
+
 	for (int y = 0; y < oh; y++) {
 		for (int x = 0; x < ow; x++) {
 			float sx = ox + x;
@@ -546,10 +1080,8 @@ bool pixelPerfectCollision(
 			if (u1 < 0 || v1 < 0 || u2 < 0 || v2 < 0) continue;
 			if (u1 >= width1 || v1 >= height1) continue;
 			if (u2 >= width2 || v2 >= height2) continue;
-			Color a = pixel1[v1 * width1 + u1];
-			Color b = pixel2[v2 * width2 + u2];
 
-			if (a.a > 0 && b.a > 0) {
+			if (maskBit(mask1, u1, v1) && maskBit(mask2, u2, v2)) {
 				return true;
 			}
 		}
@@ -559,80 +1091,1034 @@ bool pixelPerfectCollision(
 }
 
 
-void HandleResize(Options* options)
+// Oriented box of a mask's opaque pixels, placed like pixelPerfectCollision
+// places the mask: scaled to dst and rotated about its center
+typedef struct MaskBox {
+	Vector2 center;
+	Vector2 axisX;
+	Vector2 axisY;
+	Vector2 extent;
+} MaskBox;
+
+static MaskBox GetMaskBox(const SpriteMask* mask, Rectangle dst, float cosine, float sine)
 {
-	float* previousWidth = &options->previousWidth;
-	float* previousHeight = &options->previousHeight;
-	int width  = GetRenderWidth();
-	int height = GetRenderHeight();
-	if (width != *previousWidth || height != *previousHeight) 
-	{
-		float aspect = (float)VIRTUAL_WIDTH / VIRTUAL_HEIGHT;
-		height = (int)(width / aspect); // adjust height to maintain ratio
+	const float scaleX = dst.width / mask->width;
+	const float scaleY = dst.height / mask->height;
+	const Vector2 offset = {
+		(mask->bounds.x + mask->bounds.width * 0.5f) * scaleX - dst.width * 0.5f,
+		(mask->bounds.y + mask->bounds.height * 0.5f) * scaleY - dst.height * 0.5f,
+	};
+	return (MaskBox){
+		.center = {
+			dst.x + dst.width * 0.5f + cosine * offset.x - sine * offset.y,
+			dst.y + dst.height * 0.5f + sine * offset.x + cosine * offset.y,
+		},
+		.axisX = {cosine, sine},
+		.axisY = {-sine, cosine},
+		.extent = {mask->bounds.width * 0.5f * scaleX, mask->bounds.height * 0.5f * scaleY},
+	};
+}
 
-		if (width < MIN_SCREEN_WIDTH || height < MIN_SCREEN_HEIGHT) {
-			width  = width  < MIN_SCREEN_WIDTH ? MIN_SCREEN_WIDTH : width;
-			height = height < MIN_SCREEN_HEIGHT ? MIN_SCREEN_HEIGHT: height;
-		}
-		options->screenWidth = width;
-		options->screenHeight = height;
-		// SetWindowSize(width, height);
+static float MaskBoxProject(MaskBox box, Vector2 axis)
+{
+	return box.extent.x * fabsf(Vector2DotProduct(box.axisX, axis)) + box.extent.y * fabsf(Vector2DotProduct(box.axisY, axis));
+}
+
+// Midphase: false if the opaque pixels of the two masks cannot touch, in which
+// case pixelPerfectCollision would return false too. Tests the bounding
+// circles first, then the oriented boxes on their four separating axes.
+bool masksMayCollide(const SpriteMask* mask1, const SpriteMask* mask2,
+		Rectangle dst1, Rectangle dst2, float rotationDeg1, float rotationDeg2)
+{
+	const Vector2 center1 = {dst1.x + dst1.width * 0.5f, dst1.y + dst1.height * 0.5f};
+	const Vector2 center2 = {dst2.x + dst2.width * 0.5f, dst2.y + dst2.height * 0.5f};
+	const float radius1 = mask1->radius * fmaxf(dst1.width / mask1->width, dst1.height / mask1->height);
+	const float radius2 = mask2->radius * fmaxf(dst2.width / mask2->width, dst2.height / mask2->height);
+	if (Vector2DistanceSqr(center1, center2) > (radius1 + radius2) * (radius1 + radius2)) return false;
+
+	const float r1 = rotationDeg1 * DEG2RAD;
+	const float r2 = rotationDeg2 * DEG2RAD;
+	const MaskBox box1 = GetMaskBox(mask1, dst1, cosf(r1), sinf(r1));
+	const MaskBox box2 = GetMaskBox(mask2, dst2, cosf(r2), sinf(r2));
+	const Vector2 distance = Vector2Subtract(box2.center, box1.center);
+	const Vector2 axes[4] = {box1.axisX, box1.axisY, box2.axisX, box2.axisY};
+	for (int i = 0; i < 4; i++)
+	{
+		if (fabsf(Vector2DotProduct(distance, axes[i])) > MaskBoxProject(box1, axes[i]) + MaskBoxProject(box2, axes[i])) return false;
 	}
+	return true;
 }
 
-void UpdateGame(GameMemory* gameMemory)
+// CheckCollisionRecs for a pair handed out by the broadphase, counted for the pair statistics
+static inline bool CandidatesOverlap(long* counters, Rectangle a, Rectangle b)
 {
-	GameState* gameState = gameMemory->gameState;
-	Options* options = gameMemory->options;
-	TextureAtlas* atlas = gameMemory->atlas;
-	SpriteMask* spriteMasks = gameMemory->spriteMasks;
-	// SpriteMask spriteMasks[SPRITE_COUNT] = gameMemory->spriteMasks;
-	Audio* audio = gameMemory->audio;
+	const bool overlap = CheckCollisionRecs(a, b);
+	counters[PROFILE_PAIRS_OVERLAP] += overlap;
+	return overlap;
+}
 
-	// static bool cursorHidden = true;
-	static bool stepMode = false;
-	static bool stepOnce = false;
-	const Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
+// Swaps a rotated mask for its pre-rotated mask at the nearest bucket, placed
+// over the same center at the same scale, so the tests run axis aligned.
+// Every rotating sprite is scaled the same along both axes.
+static void UsePreRotatedMask(const SpriteMask** mask, Rectangle* dst, float* rotationDeg)
+{
+	if (*rotationDeg == 0.0f || (*mask)->rotations == NULL) return;
+	const SpriteMask* rotated = getRotatedMask(*mask, *rotationDeg);
+	const float width = rotated->width * (dst->width / (*mask)->width);
+	const float height = rotated->height * (dst->height / (*mask)->height);
+	*dst = (Rectangle){
+		dst->x + (dst->width - width) * 0.5f,
+		dst->y + (dst->height - height) * 0.5f,
+		width, height,
+	};
+	*mask = rotated;
+	*rotationDeg = 0.0f;
+}
 
-#ifndef PLATFORM_WEB
-	if (IsKeyPressed(KEY_F)) 
-	{
-		ToggleFullscreen();
-	}
-	if (IsKeyPressed(KEY_F2)) 
-	{
-		writeSaveState(gameMemory);
-	}
-	if (IsKeyPressed(KEY_T)) 
+// Midphase, then the pixel test for a pair whose colliders overlap, counted for the pair statistics
+static bool MasksCollide(long* counters, const SpriteMask* mask1, const SpriteMask* mask2,
+		Rectangle dst1, Rectangle dst2, Rectangle overlap, float rotationDeg1, float rotationDeg2)
+{
+	// The overlap of the colliders stays the area tested
+	UsePreRotatedMask(&mask1, &dst1, &rotationDeg1);
+	UsePreRotatedMask(&mask2, &dst2, &rotationDeg2);
+	if (!masksMayCollide(mask1, mask2, dst1, dst2, rotationDeg1, rotationDeg2))
 	{
-		loadSaveState(gameMemory);
-	}
-	if (IsKeyPressed(KEY_V)) {
-		if (IsWindowState(FLAG_VSYNC_HINT))
-		{
-			ClearWindowState(FLAG_VSYNC_HINT);
-		} else {
-			SetWindowState(FLAG_VSYNC_HINT);
-		}
+		counters[PROFILE_MIDPHASE_REJECTS]++;
+		return false;
 	}
-	// Start-Stop GIF recording on CTRL+R
-	if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_R))
+	counters[PROFILE_PIXEL_TESTS]++;
+	return pixelPerfectCollision(mask1, mask2, dst1, dst2, overlap, rotationDeg1, rotationDeg2);
+}
+
+// Interval of the tick, 0 < enter < t < exit <= 1, in which a collider moving
+// by displacement overlaps a target that stays put. moving is where the
+// collider ends the tick, the displacement is relative to the target.
+static bool SweptOverlap(Rectangle moving, Vector2 displacement, Rectangle target, float* enter, float* exit)
+{
+	const float start[2] = {moving.x - displacement.x, moving.y - displacement.y};
+	const float size[2] = {moving.width, moving.height};
+	const float targetStart[2] = {target.x, target.y};
+	const float targetSize[2] = {target.width, target.height};
+	const float move[2] = {displacement.x, displacement.y};
+	float lo = 0.0f, hi = 1.0f;
+	for (int axis = 0; axis < 2; axis++)
 	{
-		if (gameState->gifRecorder.recording)
+		// Overlapping while start + move * t lies in (targetStart - size, targetStart + targetSize)
+		const float from = targetStart[axis] - size[axis] - start[axis];
+		const float to = targetStart[axis] + targetSize[axis] - start[axis];
+		if (move[axis] == 0.0f)
 		{
-			GifRecordStop(&gameState->gifRecorder);
+			if (from >= 0.0f || to <= 0.0f) return false;
+			continue;
 		}
-		else
+		float t0 = from / move[axis];
+		float t1 = to / move[axis];
+		if (t0 > t1)
 		{
-			GifRecordStart(&gameState->gifRecorder);
+			const float swap = t0;
+			t0 = t1;
+			t1 = swap;
 		}
+		lo = fmaxf(lo, t0);
+		hi = fminf(hi, t1);
 	}
-	// Take Screenshot
-	if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_M))
+	*enter = lo;
+	*exit = hi;
+	return lo < hi;
+}
+
+// Pixel test of a bullet against a target over the whole tick, so fast
+// bullets and low tick rates cannot step over a target. The bullet is tested
+// at samples no further apart than its smaller side through the interval its
+// collider overlaps the target's, the earliest hit wins and its time goes to
+// impact. A bullet that needs a single sample is tested where it ends the
+// tick, the same test as without sweeping.
+static bool BulletSweepCollides(long* counters, const SpriteMask* bulletMask, const SpriteMask* targetMask,
+		Rectangle bullet, Vector2 displacement, Rectangle target, float bulletRotation, float targetRotation, float* impact)
+{
+	float enter, exit;
+	const bool overlap = SweptOverlap(bullet, displacement, target, &enter, &exit);
+	counters[PROFILE_PAIRS_OVERLAP] += overlap;
+	if (!overlap) return false;
+	const float step = fminf(bullet.width, bullet.height);
+	const float length = Vector2Length(displacement);
+	const int steps = length > step ? (int)ceilf(length / step) : 1;
+	// The start of the tick was the end of the last one
+	const int first = MAX((int)ceilf(enter * steps), 1);
+	const int last = MIN((int)floorf(exit * steps), steps);
+	// An overlap between two samples is tested in its middle
+	const int count = first <= last ? last - first + 1 : 1;
+	for (int i = 0; i < count; i++)
 	{
-		ScreenShot();
+		const float t = first <= last ? (float)(first + i) / steps : (enter + exit) * 0.5f;
+		const Rectangle at = {
+			bullet.x + displacement.x * (t - 1.0f),
+			bullet.y + displacement.y * (t - 1.0f),
+			bullet.width, bullet.height,
+		};
+		if (!CheckCollisionRecs(at, target)) continue;
+		if (MasksCollide(counters, bulletMask, targetMask, at, target, GetCollisionRec(at, target), bulletRotation, targetRotation))
+		{
+			*impact = t;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Rectangle grown by amount on every side
+static inline Rectangle GrowRectangle(Rectangle rect, float amount)
+{
+	return (Rectangle){rect.x - amount, rect.y - amount, rect.width + 2.0f * amount, rect.height + 2.0f * amount};
+}
+
+// Resolve step of the collision events, see collisionEvents.h. Each handler
+// skips an event whose entities were used up by an earlier one.
+
+// Bullet explosions start half a bullet frame above the bullet
+static Vector2 BulletExplosionPosition(Vector2 bullet)
+{
+	return (Vector2){ bullet.x, bullet.y - SpriteCoords[SPRITE_BULLET].height/2.0f };
+}
+
+static void ResolveBulletEnemy(GameState* gameState, CollisionEvent event)
+{
+	Archetype* bullets = &gameState->bullets;
+	Archetype* enemies = &gameState->enemies;
+	const int bulletIndex = event.source;
+	const int enemyIndex = event.target;
+	if (!ArchetypeAlive(bullets, bulletIndex) || !ArchetypeAlive(enemies, enemyIndex)) return;
+	Explosion* explosion = SpawnExplosion(gameState, (Explosion){
+		.position = BulletExplosionPosition(event.point),
+		.velocity = enemies->velocity[enemyIndex],
+	});
+	if (explosion != NULL)
+	{
+		CollisionQueueSound(&gameState->collisions, SOUND_EXPLOSIONBLAST);
+	}
+	enemies->health[enemyIndex] -= gameState->bulletData[bulletIndex].damage;
+	ArchetypeRemove(bullets, bulletIndex);
+	if (enemies->health[enemyIndex] <= 0.0f)
+	{
+		gameState->experience += 200;
+		gameState->score += 20 * MAX((int)(enemies->size[enemyIndex] * 100),1);
+		ArchetypeRemove(enemies, enemyIndex);
+		if(explosion != NULL)
+		{
+			explosion->velocity.x = 0.0f;
+		}
+	}
+}
+
+static void DamagePlayer(GameState* gameState)
+{
+	CollisionQueueSound(&gameState->collisions, SOUND_HIT);
+	gameState->player.invulTime = gameState->player.invulDuration;
+	if (--gameState->player.health < 1)
+	{
+		gameState->state = STATE_GAME_OVER;
+		gameState->stateChanged = true;
+	}
+}
+
+static void ResolveBulletPlayer(GameState* gameState, CollisionEvent event)
+{
+	Archetype* bullets = &gameState->bullets;
+	const int bulletIndex = event.source;
+	if (!ArchetypeAlive(bullets, bulletIndex)) return;
+	if (gameState->player.invulTime > 0.0f || gameState->player.shieldEnabled) return;
+	Explosion* explosion = SpawnExplosion(gameState, (Explosion){
+		.position = BulletExplosionPosition(event.point),
+		.velocity = { 0.0f, gameState->player.velocity },
+	});
+	if (explosion != NULL)
+	{
+		CollisionQueueSound(&gameState->collisions, SOUND_EXPLOSIONBLAST);
+	}
+	ArchetypeRemove(bullets, bulletIndex);
+	DamagePlayer(gameState);
+}
+
+static void ResolveBulletAsteroid(GameState* gameState, CollisionEvent event)
+{
+	Archetype* bullets = &gameState->bullets;
+	Archetype* asteroids = &gameState->asteroids;
+	const int bulletIndex = event.source;
+	const int asteroidIndex = event.target;
+	Asteroid* asteroid = &gameState->asteroidData[asteroidIndex];
+	if (!ArchetypeAlive(bullets, bulletIndex) || !ArchetypeAlive(asteroids, asteroidIndex) || asteroid->dying) return;
+	const SpriteID asteroidSprite = asteroids->sprite[asteroidIndex];
+	Explosion* explosion = SpawnExplosion(gameState, (Explosion){
+		.position = BulletExplosionPosition(event.point),
+		.velocity = asteroids->velocity[asteroidIndex],
+	});
+	if (explosion != NULL)
+	{
+		CollisionQueueSound(&gameState->collisions, SOUND_EXPLOSIONBLAST);
+	}
+	asteroids->health[asteroidIndex] -= gameState->bulletData[bulletIndex].damage;
+
+	if (asteroids->health[asteroidIndex] <= 0.0f) {
+		asteroid->dying = true;
+		// Dying asteroids stay in place while the fragments fly
+		asteroids->velocity[asteroidIndex] = (Vector2){0, 0};
+		asteroids->angularVelocity[asteroidIndex] = 0.0f;
+		// Spawn asteroid fragments via particle emitter
+		const float size = asteroids->size[asteroidIndex];
+		Vector2 pos = asteroids->position[asteroidIndex];
+		pos.y += SpriteCoords[asteroidSprite].height / 2.0f;
+		pos.x += SpriteCoords[asteroidSprite].width  / 2.0f;
+		ParticleTemplate particleTemplate = {
+			.sprite = asteroidSprite,
+			.positionRange = (Vector4){pos.x, pos.x, pos.y, pos.y},
+			.velocityRange = (Vector4){-100, 100, -100, 100},
+			.angleRange = (Vector2){0, 360},
+			.sizeRange = (Vector2){0.20*size, 0.1*size},
+			.accelerationRange = (Vector4){0, 0, 0, 0}, 
+			.angularVelocityRange = (Vector2){-200, 200},
+			.startColor = WHITE,
+			.endColor = WHITE,
+			.lifetime = 0.2f + (float)RngInt(&gameState->rng[RNG_PARTICLES], 0, 50) / 100.0f,
+		};
+		SpawnEmitter(gameState, pos, 15, 120.0f, 0.25f, particleTemplate);
+		asteroid->deathTime = 0.0f;
+		gameState->experience += MAX((int)(size * 100),1);
+		gameState->score += MAX((int)(size * 100),1);
+		if(explosion != NULL)
+		{
+			explosion->velocity.y = 0.0f;
+		}
+	}
+	ArchetypeRemove(bullets, bulletIndex);
+}
+
+static void ResolveAsteroidPlayer(GameState* gameState, CollisionEvent event)
+{
+	Archetype* asteroids = &gameState->asteroids;
+	const int asteroidIndex = event.source;
+	if (!ArchetypeAlive(asteroids, asteroidIndex) || gameState->asteroidData[asteroidIndex].dying) return;
+	if (gameState->player.invulTime > 0.0f || gameState->player.shieldEnabled) return;
+	ArchetypeRemove(asteroids, asteroidIndex);
+	gameState->currentCollision = (Rectangle){0,0,0,0};
+	DamagePlayer(gameState);
+}
+
+static void ResolveBoostPlayer(GameState* gameState, CollisionEvent event)
+{
+	Archetype* boosts = &gameState->boosts;
+	const int boostIndex = event.source;
+	if (!ArchetypeAlive(boosts, boostIndex)) return;
+	ArchetypeRemove(boosts, boostIndex);
+	gameState->player.shieldEnabled = true;
+	gameState->player.shieldTime = 5.25f;
+	CollisionQueueSound(&gameState->collisions, SOUND_SHIELD);
+	gameState->currentCollision = (Rectangle){0,0,0,0};
+}
+
+// Applies the events of the last collision pass in the order they were found
+static void ResolveCollisions(GameState* gameState)
+{
+	CollisionEvents* queue = &gameState->collisions;
+	for (int e = 0; e < queue->count; e++)
+	{
+		const CollisionEvent event = queue->events[e];
+		switch ((CollisionKind)event.kind)
+		{
+			case COLLISION_BULLET_ENEMY:    ResolveBulletEnemy(gameState, event); break;
+			case COLLISION_BULLET_PLAYER:   ResolveBulletPlayer(gameState, event); break;
+			case COLLISION_BULLET_ASTEROID: ResolveBulletAsteroid(gameState, event); break;
+			case COLLISION_ASTEROID_PLAYER: ResolveAsteroidPlayer(gameState, event); break;
+			case COLLISION_BOOST_PLAYER:    ResolveBoostPlayer(gameState, event); break;
+		}
+	}
+	queue->count = 0;
+}
+
+// Plays the sounds the tick's collisions asked for, each once
+static void PlayCollisionSounds(CollisionEvents* queue, Audio* audio)
+{
+	for (int sound = 0; sound < SOUND_COUNT; sound++)
+	{
+		if (!queue->sounds[sound]) continue;
+		queue->sounds[sound] = false;
+		// Restarts a sound still playing from an earlier tick
+		if (IsSoundPlaying(audio->sounds[sound]))
+		{
+			StopSound(audio->sounds[sound]);
+		}
+		PlaySound(audio->sounds[sound]);
+	}
+}
+
+void HandleResize(Options* options)
+{
+	float* previousWidth = &options->previousWidth;
+	float* previousHeight = &options->previousHeight;
+	int width  = GetRenderWidth();
+	int height = GetRenderHeight();
+	if (width != *previousWidth || height != *previousHeight) 
+	{
+		float aspect = (float)VIRTUAL_WIDTH / VIRTUAL_HEIGHT;
+		height = (int)(width / aspect); // adjust height to maintain ratio
+
+		if (width < MIN_SCREEN_WIDTH || height < MIN_SCREEN_HEIGHT) {
+			width  = width  < MIN_SCREEN_WIDTH ? MIN_SCREEN_WIDTH : width;
+			height = height < MIN_SCREEN_HEIGHT ? MIN_SCREEN_HEIGHT: height;
+		}
+		options->screenWidth = width;
+		options->screenHeight = height;
+		// SetWindowSize(width, height);
+	}
+}
+
+// Starts recording the run gameState was just initialized for, with the
+// seed and pool capacities it uses
+void RecordReplayFrom(Replay* replay, const GameState* gameState, int tickRate)
+{
+	ReplayPool pools[POOL_KIND_COUNT];
+	for (int kind = 0; kind < POOL_KIND_COUNT; kind++)
+	{
+		pools[kind] = (ReplayPool){(uint32_t)gameState->pools[kind].capacity, (uint32_t)gameState->pools[kind].limit};
+	}
+	ReplayRecordStart(replay, gameState->seed, (uint32_t)tickRate, pools, POOL_KIND_COUNT);
+}
+
+// Replays always start from a freshly seeded run
+void StartReplayRecording(GameMemory* gameMemory)
+{
+	GameState* gameState = gameMemory->gameState;
+	uint64_t seed = NextGameSeed(gameState);
+	InitializeGameState(gameState, seed);
+	gameMemory->options->lastMousePos = (Vector2){0,0};
+	RecordReplayFrom(gameMemory->replay, gameState, gameMemory->options->tickRate);
+	TraceLog(LOG_INFO, "Start replay recording (seed %llu)", (unsigned long long)seed);
+}
+
+void StopReplayRecording(GameMemory* gameMemory, const char* path)
+{
+	Replay* replay = gameMemory->replay;
+	replay->mode = REPLAY_OFF;
+	if (ReplaySave(replay, path))
+	{
+		TraceLog(LOG_INFO, "Saved replay with %u ticks to %s", replay->tickCount, path);
+	}
+}
+
+bool StartReplayPlayback(GameMemory* gameMemory, const char* path)
+{
+	Replay* replay = gameMemory->replay;
+	if (!ReplayLoad(replay, path)) return false;
+	if (replay->poolCount != 0 && replay->poolCount != POOL_KIND_COUNT)
+	{
+		printf("Error: %s has %u pools, this build has %d\n", path, replay->poolCount, POOL_KIND_COUNT);
+		ReplayFree(replay);
+		return false;
+	}
+	// The recorded pools replace the configured ones until the next start
+	for (uint32_t kind = 0; kind < replay->poolCount; kind++)
+	{
+		const int capacity = PoolClampCapacity((int)replay->pools[kind].capacity);
+		gameMemory->gameState->pools[kind] = (PoolConfig){capacity, MAX(capacity, PoolClampCapacity((int)replay->pools[kind].limit))};
+	}
+	InitializeGameState(gameMemory->gameState, replay->seed);
+	gameMemory->options->lastMousePos = (Vector2){0,0};
+	gameMemory->options->tickRate = replay->tickRate;
+	TraceLog(LOG_INFO, "Playing replay %s (%u ticks, seed %llu)", path, replay->tickCount, (unsigned long long)replay->seed);
+	return true;
+}
+
+// Step debugging mode
+static bool stepMode = false;
+static bool stepOnce = false;
+
+// Step mode holds the simulation while running until K asks for one more
+// tick. Decided before SimulateTick, so a held tick is neither simulated nor
+// recorded, and a replay of a stepped session plays the same ticks.
+static bool StepModeHolds(const GameState* gameState)
+{
+	if (!stepMode || gameState->state != STATE_RUNNING) return false;
+	if (stepOnce)
+	{
+		stepOnce = false;
+		return false;
+	}
+	return true;
+}
+
+// Debug and window keys act on the rendered frame, not on the simulation
+void HandleDebugKeys(GameMemory* gameMemory)
+{
+	GameState* gameState = gameMemory->gameState;
+	Options* options = gameMemory->options;
+
+#ifndef PLATFORM_WEB
+	if (IsKeyPressed(KEY_F)) 
+	{
+		ToggleFullscreen();
+	}
+	if (IsKeyPressed(KEY_F2)) 
+	{
+		writeSaveState(gameMemory);
+	}
+	if (IsKeyPressed(KEY_T)) 
+	{
+		loadSaveState(gameMemory);
+	}
+	if (IsKeyPressed(KEY_V)) {
+		if (IsWindowState(FLAG_VSYNC_HINT))
+		{
+			ClearWindowState(FLAG_VSYNC_HINT);
+		} else {
+			SetWindowState(FLAG_VSYNC_HINT);
+		}
+	}
+	// Start-Stop GIF recording on CTRL+R
+	if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_R))
+	{
+		if (gameState->gifRecorder.recording)
+		{
+			double gifStart = PROFILER_CLOCK();
+			GifRecordStop(&gameState->gifRecorder);
+			ProfileEvent(gameMemory->profiler, TRACE_GIF, "gif encode and save", gifStart);
+		}
+		else
+		{
+			GifRecordStart(&gameState->gifRecorder);
+		}
+	}
+	// Take Screenshot
+	if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_M))
+	{
+		ScreenShot();
+	}
+	// Start-Stop trace capture on F4
+	if (IsKeyPressed(KEY_F4))
+	{
+		if (gameMemory->profiler->trace.capturing)
+		{
+			StopTraceCapture(gameMemory);
+		}
+		else
+		{
+			StartTraceCapture(gameMemory);
+		}
+	}
+	// Start-Stop input recording on F5, play back the last recording on F6
+	if (IsKeyPressed(KEY_F5))
+	{
+		if (gameMemory->replay->mode == REPLAY_RECORDING)
+		{
+			StopReplayRecording(gameMemory, REPLAY_FILE);
+		}
+		else
+		{
+			StartReplayRecording(gameMemory);
+		}
+	}
+	if (IsKeyPressed(KEY_F6))
+	{
+		if (gameMemory->replay->mode == REPLAY_PLAYING)
+		{
+			gameMemory->replay->mode = REPLAY_OFF;
+		}
+		else
+		{
+			StartReplayPlayback(gameMemory, REPLAY_FILE);
+		}
+	}
+	// Start-Stop logging per-tick checksums on F7
+	if (IsKeyPressed(KEY_F7))
+	{
+		if (gameMemory->checksumLog)
+		{
+			StopChecksumLog(gameMemory);
+		}
+		else
+		{
+			StartChecksumLog(gameMemory);
+		}
 	}
 #endif
+	// Toggle the profiler overlay on F3
+	if (IsKeyPressed(KEY_F3))
+	{
+		options->showProfiler = !options->showProfiler;
+	}
+	// Cycle turbo on N: off, 4, 16 and 64 ticks per frame, unlimited
+	if (IsKeyPressed(KEY_N))
+	{
+		switch (options->turboTicks)
+		{
+			case 0:  options->turboTicks = 4; break;
+			case 4:  options->turboTicks = 16; break;
+			case 16: options->turboTicks = 64; break;
+			case 64: options->turboTicks = TURBO_UNLIMITED; break;
+			default: options->turboTicks = 0; break;
+		}
+		TraceLog(LOG_INFO, "Turbo: %d ticks per frame", options->turboTicks);
+	}
+	if (gameState->state == STATE_RUNNING)
+	{
+		if (IsKeyPressed(KEY_J)) stepMode = !stepMode;
+		if (IsKeyPressed(KEY_K)) stepOnce = true;
+		if (IsKeyPressed(KEY_H))
+		{
+			gameState->timeScale -= 0.1f;
+		}
+		if (IsKeyPressed(KEY_L)) 
+		{
+			gameState->timeScale += 0.1f;
+		}
+		if (IsKeyPressed(KEY_O)) options->disableShaders = !options->disableShaders;
+	}
+}
+
+// Bullets integrated per job, a multiple of 64 so every chunk owns whole words of the alive mask
+#define BULLET_JOB_CHUNK (256)
+#define BULLET_JOB_CHUNKS ((POOL_MAX_CAPACITY + BULLET_JOB_CHUNK - 1) / BULLET_JOB_CHUNK)
+
+typedef struct UpdateJobData UpdateJobData;
+
+typedef struct BulletChunk {
+	UpdateJobData* update;
+	int first;
+	int aliveCount;
+} BulletChunk;
+
+// Detection job of a collision pass over the targets first..last-1, or over
+// the words first..last-1 of the candidate bitset for the player. Hits,
+// counters and the debug rectangle stay in the chunk until the merge.
+typedef struct CollisionChunk {
+	UpdateJobData* update;
+	int first;
+	int last;
+	CollisionEvents* events;
+	long counters[PROFILE_COUNTER_COUNT];
+	bool collided; // currentCollision was set
+	Rectangle currentCollision;
+} CollisionChunk;
+
+// Data the update jobs share, on the stack of UpdateGame while its graphs run
+struct UpdateJobData {
+	GameState* gameState;
+	Profiler* profiler;
+	Rectangle screenRect;
+	Rectangle fallingBounds;
+	SpriteMask bulletMask;
+	SpriteMask playerMask;
+	SpriteMask boostMask;
+	const SpriteMask* spriteMasks;
+	uint64_t bulletsAlive[BULLET_MASK_WORDS(POOL_MAX_CAPACITY)];
+	BulletChunk bulletChunks[BULLET_JOB_CHUNKS];
+	int bulletChunkCount;
+	SpatialQuery playerBullets;   // bullets near the player
+	SpatialQuery playerAsteroids; // asteroids overlapping the player
+	CollisionChunk collisionChunks[COLLISION_JOB_CHUNKS];
+};
+
+// Adds the time every job of the graph ran to the profiler phase in its tag
+static void ProfileJobs(Profiler* profiler, const JobGraph* graph)
+{
+	for (int i = 0; i < graph->count; i++)
+	{
+		const Job* job = &graph->jobs[i];
+		if (job->tag >= 0) ProfileSpan(profiler, (ProfilePhase)job->tag, job->start, job->end);
+	}
+}
+
+static void UpdateStarsJob(void* data)
+{
+	UpdateJobData* update = (UpdateJobData*)data;
+	GameState* gameState = update->gameState;
+	const Rectangle screenRect = update->screenRect;
+	// Spawn stars for parallax
+	{
+		if (gameState->initStars == 0)
+		{
+			while(gameState->starCount < MAX_STARS)
+			{                            
+				int imgIndex = RngInt(&gameState->rng[RNG_PARTICLES], 1, 2);   
+				// float starXPosition = GetRandomValue(0, options->screenWidth); 
+				// float starYPosition = GetRandomValue(0, options->screenHeight); 
+				float starXPosition = RngInt(&gameState->rng[RNG_PARTICLES], 0, VIRTUAL_WIDTH);
+				float starYPosition = RngInt(&gameState->rng[RNG_PARTICLES], 0, VIRTUAL_HEIGHT); 
+				SpriteID sprite;
+				if (imgIndex == 1)
+				{
+					sprite = SPRITE_STAR1;
+				} 
+				else
+				{
+					sprite = SPRITE_STAR2;
+				}
+
+				Star star = {
+					.position = (Vector2) {starXPosition, starYPosition},
+					.previousPosition = (Vector2) {starXPosition, starYPosition},
+					.velocity = 30.0f * RngInt(&gameState->rng[RNG_PARTICLES], 1,2) * imgIndex,
+					.size = 1,
+					.sprite = sprite,
+					.alpha = 0.5 * imgIndex,
+				};
+				gameState->stars[gameState->starCount++] = star;
+			}
+			gameState->initStars = 1;
+		}
+	}
+	// Spawn new stars for parallax
+	{
+		gameState->starTime += gameState->dt;
+		if (gameState->starTime > gameState->starSpawnRate) 
+		{
+			gameState->starTime = 0;
+			if (gameState->starCount < MAX_STARS)
+			{
+				int imgIndex = RngInt(&gameState->rng[RNG_PARTICLES], 1, 2);  
+				SpriteID starSprite = SPRITE_STAR1;
+				if (imgIndex == 2)
+				{
+					starSprite = SPRITE_STAR2;
+				}
+				float starXPosition = RngInt(&gameState->rng[RNG_PARTICLES], 0, VIRTUAL_WIDTH);
+				Star star = {
+					.position = (Vector2) {starXPosition, 0},
+					.previousPosition = (Vector2) {starXPosition, 0},
+					.velocity = 30.0f * RngInt(&gameState->rng[RNG_PARTICLES], 1,2) * imgIndex,
+					.size = 1,
+					.alpha = 0.5f * imgIndex,
+					.sprite = starSprite,
+				};
+				gameState->stars[gameState->starCount++]= star;
+			}
+		}
+	}
+	// Update stars
+	{
+		for (int starIndex = 0; starIndex < gameState->starCount; starIndex++)
+		{
+			Star* star = &gameState->stars[starIndex];
+			star->position.y += star->velocity * gameState->dt;
+			if(!CheckCollisionPointRec(star->position, screenRect))
+			{
+				// Replace with last star
+				if (gameState->starCount > 0)
+				{
+					*star = gameState->stars[--gameState->starCount];
+				} else {
+					gameState->starCount = 0;
+				}
+			}
+		}
+	}
+}
+
+static void MoveEnemiesJob(void* data)
+{
+	GameState* gameState = ((UpdateJobData*)data)->gameState;
+	Archetype* enemies = &gameState->enemies;
+	for (int enemyIndex = 0; enemyIndex < enemies->count; enemyIndex++)
+	{
+		Enemy* enemy = &gameState->enemyData[enemyIndex];
+		const float width = SpriteCoords[enemies->sprite[enemyIndex]].width * enemies->size[enemyIndex];
+		const float previousX = enemies->position[enemyIndex].x;
+		enemy->phase += enemy->phaseRate * gameState->dt;
+		enemies->position[enemyIndex].x = 0.5 * width + (VIRTUAL_WIDTH - width) * 0.5f * (1.0f + sinf(enemy->phase));
+		// The swept bullet test and the explosions left behind read the motion from the velocity
+		enemies->velocity[enemyIndex].x = (enemies->position[enemyIndex].x - previousX) / gameState->dt;
+	}
+	ColliderSystem(enemies);
+}
+
+// Broadphase of the enemy pass, over the bullets before they move
+static void BuildBulletHashJob(void* data)
+{
+	UpdateJobData* update = (UpdateJobData*)data;
+	SpatialHashBuild(&update->gameState->bulletHash, update->screenRect, &update->gameState->bullets);
+}
+
+static void UpdateAsteroidsJob(void* data)
+{
+	UpdateJobData* update = (UpdateJobData*)data;
+	GameState* gameState = update->gameState;
+	Archetype* asteroids = &gameState->asteroids;
+	MoveSystem(asteroids, gameState->dt);
+	ColliderSystem(asteroids);
+	for (int asteroidIndex = 0; asteroidIndex < asteroids->count; asteroidIndex++)
+	{
+		Asteroid* asteroid = &gameState->asteroidData[asteroidIndex];
+		if (asteroid->dying) {
+			asteroid->deathTime += gameState->dt;
+		}
+		if (asteroid->deathTime > 0.5f) {
+			// printf("dying done: %f\n", asteroid->deathTime);
+			asteroid->dying = false;
+			ArchetypeRemove(asteroids, asteroidIndex);
+		}
+	}
+	CullSystem(asteroids, update->fallingBounds);
+	SpatialHashBuild(&gameState->asteroidHash, update->screenRect, asteroids);
+}
+
+static void IntegrateBulletsJob(void* data)
+{
+	BulletChunk* chunk = (BulletChunk*)data;
+	UpdateJobData* update = chunk->update;
+	Archetype* bullets = &update->gameState->bullets;
+	const int count = MIN(bullets->count - chunk->first, BULLET_JOB_CHUNK);
+	const Vector2 halfFrame = Vector2Scale(SpriteFrameSize[SPRITE_BULLET], 0.5f);
+	BulletKernelFunc kernel = BulletKernelGet(BulletKernelBest());
+	const int first = chunk->first;
+	chunk->aliveCount = kernel(bullets->position + first, bullets->velocity + first, bullets->size + first, bullets->collider + first,
+			update->bulletsAlive + first / 64, count, update->gameState->dt, halfFrame, update->screenRect);
+}
+
+static void CullBulletsJob(void* data)
+{
+	UpdateJobData* update = (UpdateJobData*)data;
+	Archetype* bullets = &update->gameState->bullets;
+	const uint64_t* alive = update->bulletsAlive;
+	int aliveCount = 0;
+	for (int chunk = 0; chunk < update->bulletChunkCount; chunk++)
+	{
+		aliveCount += update->bulletChunks[chunk].aliveCount;
+	}
+	// Remove the bullets whose bit is clear
+	for (int word = 0; aliveCount < bullets->count && word < BULLET_MASK_WORDS(bullets->count); word++)
+	{
+		uint64_t dead = ~alive[word];
+		const int remaining = bullets->count - word * 64;
+		if (remaining < 64) dead &= ((uint64_t)1 << remaining) - 1;
+		while (dead)
+		{
+			ArchetypeRemove(bullets, word * 64 + __builtin_ctzll(dead));
+			dead &= dead - 1;
+		}
+	}
+	SpatialHashBuild(&update->gameState->bulletHash, update->screenRect, bullets);
+}
+
+static void UpdateExplosionsJob(void* data)
+{
+	GameState* gameState = ((UpdateJobData*)data)->gameState;
+	const float duration = (float)SpriteNumFrames[SPRITE_EXPLOSION] / EXPLOSION_FPS;
+	for (int explosionIndex = 0; explosionIndex < gameState->explosionCount; explosionIndex++)
+	{
+		if (!PoolAlive(&gameState->explosionPool, explosionIndex)) continue;
+		Explosion* explosion = &gameState->explosions[explosionIndex];
+		explosion->position.x += explosion->velocity.x * gameState->dt;
+		explosion->position.y += explosion->velocity.y * gameState->dt;
+		explosion->age += gameState->dt;
+		if (explosion->age >= duration)
+		{
+			PoolRemove(&gameState->explosionPool, explosionIndex);
+		}
+	}
+}
+
+static void UpdateBoostsJob(void* data)
+{
+	UpdateJobData* update = (UpdateJobData*)data;
+	GameState* gameState = update->gameState;
+	Archetype* boosts = &gameState->boosts;
+	MoveSystem(boosts, gameState->dt);
+	ColliderSystem(boosts);
+	if (CullSystem(boosts, update->fallingBounds) > 0)
+	{
+		gameState->boostSpawnTime = 0.0f;
+	}
+	SpatialHashBuild(&gameState->boostHash, update->screenRect, boosts);
+}
+
+static void UpdateEmittersJob(void* data)
+{
+	GameState* gameState = ((UpdateJobData*)data)->gameState;
+	UpdateEmitters(gameState, gameState->dt);
+}
+
+// Splits count targets into detection jobs and queues their hits in target
+// order, so who gets hit first and which bullet is used up stay as they were
+static void DetectCollisions(JobSystem* jobs, UpdateJobData* update, JobFunc detect, int count)
+{
+	GameState* gameState = update->gameState;
+	// Without workers the chunks would only add overhead, the merge is the same either way
+	const bool parallel = jobs && jobs->workerCount > 0;
+	const int maxChunks = parallel ? COLLISION_JOB_CHUNKS : 1;
+	const int size = (count + maxChunks - 1) / maxChunks;
+	const int chunks = size > 0 ? (count + size - 1) / size : 0;
+	JobGraph graph;
+	JobGraphReset(&graph);
+	for (int c = 0; c < chunks; c++)
+	{
+		CollisionChunk* chunk = &update->collisionChunks[c];
+		*chunk = (CollisionChunk){
+			.update = update,
+			.first = c * size,
+			.last = MIN(count, (c + 1) * size),
+			.events = &gameState->collisionChunks[c],
+		};
+		chunk->events->count = 0;
+		chunk->events->dropped = 0;
+		// The pass is timed as a whole, the jobs are not added to a phase
+		if (parallel) JobAdd(&graph, detect, chunk, -1);
+		else detect(chunk);
+	}
+	if (parallel) JobGraphRun(jobs, &graph);
+	long* counters = ProfileCounters(update->profiler);
+	const long dropped = gameState->collisions.dropped;
+	for (int c = 0; c < chunks; c++)
+	{
+		const CollisionChunk* chunk = &update->collisionChunks[c];
+		CollisionMerge(&gameState->collisions, chunk->events);
+		for (int counter = 0; counter < PROFILE_COUNTER_COUNT; counter++)
+		{
+			counters[counter] += chunk->counters[counter];
+		}
+		if (chunk->collided) gameState->currentCollision = chunk->currentCollision;
+	}
+	// Reported the first time in a game, like a full pool
+	if (dropped == 0 && gameState->collisions.dropped > 0)
+	{
+		printf("The collision queue is full at %d hits, hits are dropped (raise the bullet or asteroid limit in config.ini)\n",
+				gameState->collisions.capacity);
+	}
+}
+
+static void DetectBulletEnemyJob(void* data)
+{
+	CollisionChunk* chunk = (CollisionChunk*)data;
+	const UpdateJobData* update = chunk->update;
+	GameState* gameState = update->gameState;
+	Archetype* enemies = &gameState->enemies;
+	Archetype* bullets = &gameState->bullets;
+	const float bulletReach = gameState->bulletMaxSpeed * gameState->dt;
+	for (int enemyIndex = chunk->first; enemyIndex < chunk->last; enemyIndex++)
+	{
+		SpatialQuery query;
+		const float reach = bulletReach + Vector2Length(enemies->velocity[enemyIndex]) * gameState->dt;
+		SpatialHashQuery(&gameState->bulletHash, GrowRectangle(enemies->collider[enemyIndex], reach), &query);
+		chunk->counters[PROFILE_PAIRS_BRUTE] += bullets->count;
+		chunk->counters[PROFILE_PAIRS_CANDIDATE] += query.count;
+		for (int bulletIndex; (bulletIndex = SpatialQueryNext(&query)) >= 0;)
+		{
+			if (!ArchetypeAlive(bullets, bulletIndex)) continue;
+			if (!HandleIsNone(gameState->bulletData[bulletIndex].owner)) continue;
+			// Swept relative to the enemy
+			const Vector2 displacement = Vector2Scale(Vector2Subtract(bullets->velocity[bulletIndex], enemies->velocity[enemyIndex]), gameState->dt);
+			float impact;
+			if (BulletSweepCollides(chunk->counters, &update->bulletMask, &update->spriteMasks[enemies->sprite[enemyIndex]], bullets->collider[bulletIndex], displacement,
+						enemies->collider[enemyIndex], bullets->rotation[bulletIndex], 0, &impact))
+			{
+				const Vector2 hit = Vector2Add(bullets->position[bulletIndex], Vector2Scale(displacement, impact - 1.0f));
+				CollisionEmit(chunk->events, COLLISION_BULLET_ENEMY, bulletIndex, enemyIndex, hit);
+			}
+		}
+	}
+}
+
+// Chunks over the candidate words, the player is the only target
+static void DetectBulletPlayerJob(void* data)
+{
+	CollisionChunk* chunk = (CollisionChunk*)data;
+	const UpdateJobData* update = chunk->update;
+	GameState* gameState = update->gameState;
+	Archetype* bullets = &gameState->bullets;
+	SpatialQuery query = update->playerBullets;
+	query.word = chunk->first;
+	query.words = chunk->last;
+	for (int bulletIndex; (bulletIndex = SpatialQueryNext(&query)) >= 0;)
+	{
+		if (!ArchetypeAlive(bullets, bulletIndex)) continue;
+		const Rectangle bulletCollider = bullets->collider[bulletIndex];
+		// Swept, the player counts as standing still during the tick
+		const Vector2 displacement = Vector2Scale(bullets->velocity[bulletIndex], gameState->dt);
+		float impact;
+		if(!HandleIsNone(gameState->bulletData[bulletIndex].owner) 
+				&& gameState->player.invulTime <= 0.0f 
+				&& gameState->player.shieldEnabled == false
+				&& BulletSweepCollides(chunk->counters, &update->bulletMask, &update->playerMask, bulletCollider, displacement,
+					gameState->player.collider, bullets->rotation[bulletIndex], 0, &impact))
+		{
+			const Rectangle hitCollider = {
+				bulletCollider.x + displacement.x * (impact - 1.0f),
+				bulletCollider.y + displacement.y * (impact - 1.0f),
+				bulletCollider.width, bulletCollider.height,
+			};
+			chunk->collided = true;
+			chunk->currentCollision = GetCollisionRec(gameState->player.collider, hitCollider);
+			const Vector2 hit = Vector2Add(bullets->position[bulletIndex], Vector2Scale(displacement, impact - 1.0f));
+			CollisionEmit(chunk->events, COLLISION_BULLET_PLAYER, bulletIndex, 0, hit);
+		}
+	}
+}
+
+static void DetectAsteroidJob(void* data)
+{
+	CollisionChunk* chunk = (CollisionChunk*)data;
+	const UpdateJobData* update = chunk->update;
+	GameState* gameState = update->gameState;
+	Archetype* asteroids = &gameState->asteroids;
+	Archetype* bullets = &gameState->bullets;
+	const float bulletReach = gameState->bulletMaxSpeed * gameState->dt;
+	for (int asteroidIndex = chunk->first; asteroidIndex < chunk->last; asteroidIndex++)
+	{
+		if (!ArchetypeAlive(asteroids, asteroidIndex)) continue;
+		const Asteroid* asteroid = &gameState->asteroidData[asteroidIndex];
+		const SpriteMask* asteroidMask = &update->spriteMasks[asteroids->sprite[asteroidIndex]];
+		// Collision asteroid bullet
+		SpatialQuery query;
+		const float reach = bulletReach + Vector2Length(asteroids->velocity[asteroidIndex]) * gameState->dt;
+		SpatialHashQuery(&gameState->bulletHash, GrowRectangle(asteroids->collider[asteroidIndex], reach), &query);
+		chunk->counters[PROFILE_PAIRS_BRUTE] += bullets->count;
+		chunk->counters[PROFILE_PAIRS_CANDIDATE] += query.count;
+		for (int bulletIndex; (bulletIndex = SpatialQueryNext(&query)) >= 0;)
+		{
+			if (!ArchetypeAlive(bullets, bulletIndex)) continue;
+			if (!HandleIsNone(gameState->bulletData[bulletIndex].owner) || asteroid->dying) continue;
+			// Swept relative to the asteroid
+			const Vector2 displacement = Vector2Scale(Vector2Subtract(bullets->velocity[bulletIndex], asteroids->velocity[asteroidIndex]), gameState->dt);
+			float impact;
+			if (BulletSweepCollides(chunk->counters, &update->bulletMask, asteroidMask, bullets->collider[bulletIndex], displacement,
+						asteroids->collider[asteroidIndex], bullets->rotation[bulletIndex], asteroids->rotation[asteroidIndex], &impact))
+			{
+				const Vector2 hit = Vector2Add(bullets->position[bulletIndex], Vector2Scale(displacement, impact - 1.0f));
+				CollisionEmit(chunk->events, COLLISION_BULLET_ASTEROID, bulletIndex, asteroidIndex, hit);
+			}
+		}
+
+		// Collision asteroid player, in the same loop so the order stays as it was
+		if(SpatialQueryContains(&update->playerAsteroids, asteroidIndex) &&
+				CandidatesOverlap(chunk->counters, asteroids->collider[asteroidIndex], gameState->player.collider) && 
+				gameState->player.invulTime <= 0.0f &&
+				gameState->player.shieldEnabled == false &&
+				!asteroid->dying)
+		{
+			Rectangle collisionRec = GetCollisionRec(asteroids->collider[asteroidIndex], gameState->player.collider);
+			chunk->collided = true;
+			chunk->currentCollision = collisionRec;
+			if (MasksCollide(chunk->counters, &update->playerMask, asteroidMask,
+						gameState->player.collider, asteroids->collider[asteroidIndex], collisionRec, 0.0f, asteroids->rotation[asteroidIndex]))
+			{
+				CollisionEmit(chunk->events, COLLISION_ASTEROID_PLAYER, asteroidIndex, 0, asteroids->position[asteroidIndex]);
+			}
+		} 
+	}
+}
+
+void UpdateGame(GameMemory* gameMemory)
+{
+	GameState* gameState = gameMemory->gameState;
+	Options* options = gameMemory->options;
+	TextureAtlas* atlas = gameMemory->atlas;
+	SpriteMask* spriteMasks = gameMemory->spriteMasks;
+	// SpriteMask spriteMasks[SPRITE_COUNT] = gameMemory->spriteMasks;
+	Audio* audio = gameMemory->audio;
+	Profiler* profiler = gameMemory->profiler;
+
+	GameInput* input = &gameState->input;
+
+	// static bool cursorHidden = true;
+
 	// gameState->stateChanged = false;
 	switch (gameState->state) 
 	{
@@ -645,8 +2131,8 @@ void UpdateGame(GameMemory* gameMemory)
 							100,
 							20.0f,
 							10.0f,
-							(Particle){
-							.sprite = getSprite(SPRITE_STAR1),
+							(ParticleTemplate){
+							.sprite = SPRITE_STAR1,
 							.positionRange = (Vector4){0, VIRTUAL_WIDTH, 0, VIRTUAL_HEIGHT},
 							.velocityRange = (Vector4){0, 0, 0, 0},
 							.angleRange = (Vector2){0, 0},
@@ -655,7 +2141,6 @@ void UpdateGame(GameMemory* gameMemory)
 							.angularVelocityRange = (Vector2){0, 0},
 							.startColor = WHITE,
 							.endColor = WHITE,
-							.age = 0.0f,
 							.lifetime = 3.0f,
 							}
 							);
@@ -665,8 +2150,8 @@ void UpdateGame(GameMemory* gameMemory)
 							100,
 							20.0f,
 							20.0f,
-							(Particle){
-							.sprite = getSprite(SPRITE_STAR2),
+							(ParticleTemplate){
+							.sprite = SPRITE_STAR2,
 							.positionRange = (Vector4){0, VIRTUAL_WIDTH, 0, VIRTUAL_HEIGHT},
 							.velocityRange = (Vector4){0, 0, 0, 0},
 							.angleRange = (Vector2){0, 0},
@@ -675,19 +2160,20 @@ void UpdateGame(GameMemory* gameMemory)
 							.angularVelocityRange = (Vector2){0, 0},
 							.startColor = WHITE,
 							.endColor = WHITE,
-							.age = 0.0f,
 							.lifetime = 3.0f,
 							}
 							);
 				}
+				ProfileBegin(profiler, PROFILE_EMITTERS);
 				// Update emitters
 				UpdateEmitters(gameState, gameState->dt);
+				ProfileEnd(profiler, PROFILE_EMITTERS);
 
-				if (IsKeyPressed(KEY_ENTER)) {                    
+				if (InputPressed(input, INPUT_CONFIRM)) {                    
 					gameState->state = STATE_RUNNING;
 					gameState->stateChanged = true;
 				}
-				if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_P)) {
+				if (InputPressed(input, INPUT_PAUSE)) {
 					gameState->state = STATE_PAUSED;
 					gameState->lastState = STATE_MAIN_MENU;
 					gameState->stateChanged = true;
@@ -701,13 +2187,37 @@ void UpdateGame(GameMemory* gameMemory)
 					gameState->lastState = STATE_RUNNING;
 					gameState->particleEmitterCount = 0;
 				}
-				float viewportScale = viewport.width / VIRTUAL_WIDTH;
 				const Rectangle screenRect = {
 					.height = VIRTUAL_HEIGHT,
 					.width = VIRTUAL_WIDTH,
 					.x = 0,
 					.y = 0
 				};
+				// Collision masks of the animation frames drawn for this tick
+				const SpriteMask bulletMask = getMaskFrame(&spriteMasks[SPRITE_BULLET],
+						GetAnimationFrameIndexAt(atlas->animations[SpriteToAnimation[SPRITE_BULLET]], gameState->time));
+				const SpriteMask playerMask = getMaskFrame(&spriteMasks[SPRITE_PLAYER],
+						GetAnimationFrameIndexAt(atlas->animations[SpriteToAnimation[SPRITE_PLAYER]], gameState->time));
+				const SpriteMask boostMask = getMaskFrame(&spriteMasks[SPRITE_SCRAPMETAL],
+						GetAnimationFrameIndexAt(atlas->animations[SpriteToAnimation[SPRITE_SCRAPMETAL]], gameState->time));
+				// Asteroids and boosts fall in from above the screen and leave at the bottom
+				const Rectangle fallingBounds = {
+					.x = 0,
+					.y = -VIRTUAL_HEIGHT,
+					.width = VIRTUAL_WIDTH,
+					.height = 2 * VIRTUAL_HEIGHT,
+				};
+				UpdateJobData jobData = {
+					.gameState = gameState,
+					.profiler = profiler,
+					.screenRect = screenRect,
+					.fallingBounds = fallingBounds,
+					.bulletMask = bulletMask,
+					.playerMask = playerMask,
+					.boostMask = boostMask,
+					.spriteMasks = spriteMasks,
+				};
+				JobGraph graph;
 				if (!IsMusicStreamPlaying(audio->music[audio->currentSongtrackID])) 
 				{
 					ResumeMusicStream(audio->music[audio->currentSongtrackID]);
@@ -716,149 +2226,59 @@ void UpdateGame(GameMemory* gameMemory)
 				ResumeSound(audio->sounds[SOUND_SHIELD]);
 				// Input keys
 				{
-					// Step debugging mode
-					if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_P)) {
+					if (InputPressed(input, INPUT_PAUSE)) {
 						gameState->state = STATE_PAUSED;
 						gameState->lastState = STATE_RUNNING;
 						gameState->stateChanged = true;
 					}
-					if (IsKeyPressed(KEY_J)) stepMode = !stepMode;
-					if (IsKeyPressed(KEY_K)) stepOnce = true;
-					if (IsKeyPressed(KEY_H))
-					{
-						gameState->timeScale -= 0.1f;
-					}
-					if (IsKeyPressed(KEY_L)) 
-					{
-						gameState->timeScale += 0.1f;
-					}
-					if (IsKeyPressed(KEY_O)) options->disableShaders = !options->disableShaders;
-					if (stepMode && !stepOnce) return;
-					stepOnce = false;
 				}
 				// Update score
 				{
-					const float requiredExperience = 500.0;
-					if (gameState->experience > requiredExperience * gameState->player.level * 1.5f)
-					{
-						gameState->state = STATE_UPGRADE;
-						gameState->stateChanged = true;
-						gameState->experience -= requiredExperience * gameState->player.level * 1.5f;
-						gameState->player.level++;
-					}
-				}
-				// Spawn stars for parallax
-				{
-					if (gameState->initStars == 0)
-					{
-						while(gameState->starCount < MAX_STARS)
-						{                            
-							int imgIndex = GetRandomValue(1, 2);   
-							// float starXPosition = GetRandomValue(0, options->screenWidth); 
-							// float starYPosition = GetRandomValue(0, options->screenHeight); 
-							float starXPosition = GetRandomValue(0, VIRTUAL_WIDTH);
-							float starYPosition = GetRandomValue(0, VIRTUAL_HEIGHT); 
-							Sprite sprite;
-							if (imgIndex == 1)
-							{
-								sprite = getSprite(SPRITE_STAR1);
-							} 
-							else
-							{
-								sprite = getSprite(SPRITE_STAR2);
-							}
-
-							Star star = {
-								.position = (Vector2) {starXPosition, starYPosition},
-								.velocity = 30.0f * GetRandomValue(1,2) * imgIndex,
-								.size = 1,
-								.sprite = sprite,
-								.alpha = 0.5 * imgIndex,
-							};
-							gameState->stars[gameState->starCount++] = star;
-						}
-						gameState->initStars = 1;
-					}
-				}
-				// Spawn new stars for parallax
-				{
-					gameState->starTime += gameState->dt;
-					if (gameState->starTime > gameState->starSpawnRate) 
-					{
-						gameState->starTime = 0;
-						if (gameState->starCount < MAX_STARS)
-						{
-							int imgIndex = GetRandomValue(1, 2);  
-							Sprite starSprite = getSprite(SPRITE_STAR1);
-							if (imgIndex == 2)
-							{
-								starSprite = getSprite(SPRITE_STAR2);
-							}
-							float starXPosition = GetRandomValue(0, VIRTUAL_WIDTH);
-							Star star = {
-								.position = (Vector2) {starXPosition, 0},
-								.velocity = 30.0f * GetRandomValue(1,2) * imgIndex,
-								.size = 1,
-								.alpha = 0.5f * imgIndex,
-								.sprite = starSprite,
-							};
-							gameState->stars[gameState->starCount++]= star;
-						}
-					}
-				}
-				// Update stars
-				{
-					for (int starIndex = 0; starIndex < gameState->starCount; starIndex++)
+					const float requiredExperience = 500.0;
+					if (gameState->experience > requiredExperience * gameState->player.level * 1.5f)
 					{
-						Star* star = &gameState->stars[starIndex];
-						star->position.y += star->velocity * gameState->dt;
-						if(!CheckCollisionPointRec(star->position, screenRect))
-						{
-							// Replace with last star
-							if (gameState->starCount > 0)
-							{
-								*star = gameState->stars[--gameState->starCount];
-							} else {
-								gameState->starCount = 0;
-							}
-						}
+						gameState->state = STATE_UPGRADE;
+						gameState->stateChanged = true;
+						gameState->experience -= requiredExperience * gameState->player.level * 1.5f;
+						gameState->player.level++;
 					}
 				}
+				ProfileBegin(profiler, PROFILE_PLAYER);
 				// Update Player
 				// Player movement
 				{
-					if (IsKeyDown(KEY_W)) {
-						if(!CheckCollisionPointLine((Vector2) {gameState->player.position.x * viewportScale, gameState->player.position.y * viewportScale},
+					if (InputDown(input, INPUT_UP)) {
+						if(!CheckCollisionPointLine(gameState->player.position,
 									(Vector2) {0, 0}, 
-									(Vector2) {viewport.width, 0},
-									gameState->player.sprite.coords.height * viewportScale))
+									(Vector2) {VIRTUAL_WIDTH, 0},
+									SpriteCoords[gameState->player.sprite].height))
 						{
 							gameState->player.position.y -= gameState->player.velocity * gameState->dt;
 						}   
 					}
-					if (IsKeyDown(KEY_S)) {
-						if(!CheckCollisionPointLine((Vector2) {gameState->player.position.x * viewportScale, gameState->player.position.y * viewportScale},
-									(Vector2) {0, viewport.height},
-									(Vector2) {viewport.width, viewport.height},
-									gameState->player.sprite.coords.height * viewportScale))
+					if (InputDown(input, INPUT_DOWN)) {
+						if(!CheckCollisionPointLine(gameState->player.position,
+									(Vector2) {0, VIRTUAL_HEIGHT},
+									(Vector2) {VIRTUAL_WIDTH, VIRTUAL_HEIGHT},
+									SpriteCoords[gameState->player.sprite].height))
 						{
 							gameState->player.position.y += gameState->player.velocity * gameState->dt;
 						}
 					}
-					if (IsKeyDown(KEY_A)) {
-						if(!CheckCollisionPointLine((Vector2) {gameState->player.position.x * viewportScale, gameState->player.position.y * viewportScale},
+					if (InputDown(input, INPUT_LEFT)) {
+						if(!CheckCollisionPointLine(gameState->player.position,
 									(Vector2) {0, 0}, 
-									(Vector2) {0, viewport.height},
-									gameState->player.sprite.coords.width / gameState->player.animationFrames * viewportScale))
+									(Vector2) {0, VIRTUAL_HEIGHT},
+									SpriteFrameSize[gameState->player.sprite].x))
 						{
 							gameState->player.position.x -= gameState->player.velocity * gameState->dt;
 						}
 					}
-					if (IsKeyDown(KEY_D)) {
-						if(!CheckCollisionPointLine((Vector2) {gameState->player.position.x * viewportScale, gameState->player.position.y * viewportScale},
-									(Vector2) {viewport.width, 0},
-									(Vector2) {viewport.width, viewport.height},
-									gameState->player.sprite.coords.width / gameState->player.animationFrames * viewportScale))
+					if (InputDown(input, INPUT_RIGHT)) {
+						if(!CheckCollisionPointLine(gameState->player.position,
+									(Vector2) {VIRTUAL_WIDTH, 0},
+									(Vector2) {VIRTUAL_WIDTH, VIRTUAL_HEIGHT},
+									SpriteFrameSize[gameState->player.sprite].x))
 						{
 							gameState->player.position.x += gameState->player.velocity * gameState->dt;
 						}
@@ -885,8 +2305,8 @@ void UpdateGame(GameMemory* gameMemory)
 						gameState->player.shieldEnabled = false;
 						gameState->player.shieldTime = 5.25f;
 					}
-					const float playerWidth = gameState->player.sprite.coords.width/gameState->player.animationFrames * gameState->player.size;
-					const float playerHeight = gameState->player.sprite.coords.height * gameState->player.size;
+					const float playerWidth = SpriteFrameSize[gameState->player.sprite].x * gameState->player.size;
+					const float playerHeight = SpriteCoords[gameState->player.sprite].height * gameState->player.size;
 					gameState->player.collider = (Rectangle) {
 						.width = playerWidth,
 							.height =  playerHeight,
@@ -894,15 +2314,17 @@ void UpdateGame(GameMemory* gameMemory)
 							.y = gameState->player.position.y - playerHeight/2.0f,
 					};
 				}
+				ProfileEnd(profiler, PROFILE_PLAYER);
+				ProfileBegin(profiler, PROFILE_SHOOT);
 				// Shoot bullets (player)
-				if (IsKeyDown(KEY_SPACE) 
+				if (InputDown(input, INPUT_SHOOT) 
 						&& gameState->player.shootTime >= 1.0f/gameState->player.fireRate
-						&& gameState->bulletCount <= MAX_BULLETS)
+						&& gameState->bullets.count <= gameState->pools[POOL_BULLETS].limit)
 				{
-					const float random = (1.0f - (float)GetRandomValue(0, 2))/5.0f;
+					const float random = (1.0f - (float)RngInt(&gameState->rng[RNG_AUDIO], 0, 2))/5.0f;
 					SetSoundPitch(audio->sounds[SOUND_GUN], 1.0f + random);
 					PlaySound(audio->sounds[SOUND_GUN]);
-					if (gameState->player.bulletCount > 0 && gameState->bulletCount < MAX_BULLETS - gameState->player.bulletCount)
+					if (gameState->player.bulletCount > 0 && gameState->bullets.count < gameState->pools[POOL_BULLETS].limit - gameState->player.bulletCount)
 					{
 						int count = gameState->player.bulletCount;
 						float spreadAngle = 30.0f; // total spread in degrees 
@@ -912,152 +2334,132 @@ void UpdateGame(GameMemory* gameMemory)
 						{
 							float t = (count == 1) ? 0.5f : (float)i / (count - 1);
 							float angleDeg = startAngle + t * spreadAngle;
-							float angleRad = -angleDeg * DEG2RAD;
+							float angleRad = angleDeg * DEG2RAD;
 
 							float speed = 500.0f;
 
 							Vector2 velocity = {
 								sinf(angleRad) * speed,
-								cosf(angleRad) * speed
+								-cosf(angleRad) * speed
 							};
 
-							Bullet bullet = {
+							EntityComponents components = {
 								.position = gameState->player.position,
 								.velocity = velocity,
-								.damage = 1.5f * gameState->player.damageMulti,
-								.sprite = getSprite(SPRITE_BULLET),
+								.sprite = SPRITE_BULLET,
 								.rotation = angleDeg,
 								.size = bulletSize * 0.75f,
-								.owner = &gameState->player,
 							};
 
 							// Adjust Y so bullet spawns at top of player
-							bullet.position.y -= gameState->player.sprite.coords.height * gameState->player.size / 2.0f
-								- bullet.sprite.coords.height * bullet.size / 2.0f;
+							components.position.y -= SpriteCoords[gameState->player.sprite].height * gameState->player.size / 2.0f
+								- SpriteCoords[SPRITE_BULLET].height * components.size / 2.0f;
 
-							gameState->bullets[gameState->bulletCount++] = bullet;
+							SpawnBullet(gameState, components, (Bullet){
+								.damage = 1.5f * gameState->player.damageMulti,
+								.owner = ENTITY_NONE,
+							});
 						}
 
 						gameState->player.shootTime -= 1.0f / gameState->player.fireRate;
 					}
 				}
+				ProfileEnd(profiler, PROFILE_SHOOT);
+				ProfileBegin(profiler, PROFILE_ENEMIES);
 				// Spawn enemies
 				{
 					gameState->enemySpawnTime += gameState->dt;
-					if (gameState->enemySpawnTime > gameState->enemySpawnRate && gameState->enemyCount < MAX_ENEMIES) 
+					if (gameState->enemySpawnTime > gameState->enemySpawnRate && gameState->enemies.count < gameState->pools[POOL_ENEMIES].capacity) 
 					{
 						// printf("Spawning enemy\n");
 						float size = 2.0;
-						Vector2 velocity = (Vector2){0.1f + (float)GetRandomValue(3, 10)/20.0f,0};
-						float enemyXPosition = GetRandomValue(0            +getSprite(SPRITE_ENEMY).coords.width/2.0f, 
-								VIRTUAL_WIDTH-getSprite(SPRITE_ENEMY).coords.width/2.0f);
-						Enemy enemy =
+						float phaseRate = 0.1f + (float)RngInt(&gameState->rng[RNG_GAMEPLAY], 3, 10)/20.0f;
+						float enemyXPosition = RngInt(&gameState->rng[RNG_GAMEPLAY], 0            +SpriteCoords[SPRITE_ENEMY].width/2.0f, 
+								VIRTUAL_WIDTH-SpriteCoords[SPRITE_ENEMY].width/2.0f);
+						EntityComponents components =
 						{
-							.velocity = velocity,
 							.position = (Vector2){enemyXPosition, 70},
-							.phase = 0.0f,
 							.health = 20,
 							.size = size,
-							.sprite = getSprite(SPRITE_ENEMY),
+							.sprite = SPRITE_ENEMY,
+						};
+						SpawnEnemy(gameState, components, (Enemy){
+							.phase = 0.0f,
+							.phaseRate = phaseRate,
 							.shootTime = 0.0f,
 							.fireRate = 1.0f,
 							.bulletCount = 3,
-						};
-						enemy.collider = (Rectangle){
-							.x = enemy.position.x - enemy.sprite.coords.width*enemy.size/2.0f,
-								.y = enemy.position.y - enemy.sprite.coords.height*enemy.size/2.0f,
-								.width = enemy.sprite.coords.width*enemy.size,
-								.height = enemy.sprite.coords.height*enemy.size,
-						};
-						gameState->enemies[gameState->enemyCount++] = enemy;
+						});
 						gameState->enemySpawnTime = 0.0f;
 					}
 				}
-				// Update enemies
+				ProfileEnd(profiler, PROFILE_ENEMIES);
+				ProfileBegin(profiler, PROFILE_ASTEROIDS);
+				// Spawn Asteroids
 				{
-					for (int enemyIndex = 0; enemyIndex < gameState->enemyCount; enemyIndex++)
-					{
-						Enemy* enemy = &gameState->enemies[enemyIndex];
-						enemy->phase += enemy->velocity.x * gameState->dt;
-						enemy->position.x = 0.5 * enemy->sprite.coords.width*enemy->size + (VIRTUAL_WIDTH - enemy->sprite.coords.width*enemy->size) * 0.5f * (1.0f + sinf(enemy->phase));
-						enemy->collider = (Rectangle){
-							.x = enemy->position.x - enemy->sprite.coords.width*enemy->size/2.0f,
-								.y = enemy->position.y - enemy->sprite.coords.height*enemy->size/2.0f,
-								.width = enemy->sprite.coords.width*enemy->size,
-								.height = enemy->sprite.coords.height*enemy->size,
-						};
-					}
-					for (int enemyIndex = 0; enemyIndex < gameState->enemyCount; enemyIndex++)
+					gameState->spawnTime += gameState->dt;
+					if (gameState->spawnTime > gameState->asteroidSpawnRate && gameState->asteroids.count < gameState->pools[POOL_ASTEROIDS].capacity) 
 					{
-						Enemy* enemy = &gameState->enemies[enemyIndex];
-						// Collision enemy bullet
-						for (int bulletIndex = 0; bulletIndex < gameState->bulletCount; bulletIndex++)
+						float size = RngInt(&gameState->rng[RNG_GAMEPLAY], 50.0f, 200.0f) / 100.0f;
+						float asteroidXPosition = RngInt(&gameState->rng[RNG_GAMEPLAY], 0, VIRTUAL_WIDTH);
+						float speed = RngInt(&gameState->rng[RNG_GAMEPLAY], 30.0f, 65.0f) * 5.0f / (float)size;
+						float angularVelocity = RngInt(&gameState->rng[RNG_GAMEPLAY], -40.0f, 40.0f);
+						EntityComponents components =
 						{
-							Bullet* bullet = &gameState->bullets[bulletIndex];
-							if(bullet->owner == &gameState->player)
-							{
-								if(CheckCollisionRecs(enemy->collider, bullet->collider))
-								{
-									Rectangle collisionRec = GetCollisionRec(enemy->collider, bullet->collider);
-									Rectangle bulletSrc = GetCurrentAnimationFrame(atlas->animations[SpriteToAnimation[SPRITE_BULLET]]);
-									if (pixelPerfectCollision(spriteMasks[SPRITE_BULLET].pixels, spriteMasks[enemy->sprite.spriteID].pixels, 
-												bulletSrc.width, enemy->sprite.coords.width,
-												bulletSrc.height, enemy->sprite.coords.height,
-												bullet->collider, enemy->collider, collisionRec, bullet->rotation, 0))
-									{
-
-										Explosion* explosion = NULL;
-										if (gameState->explosionCount < MAX_EXPLOSIONS)
-										{
-											PlaySound(audio->sounds[SOUND_EXPLOSIONBLAST]);
-											explosion = &gameState->explosions[gameState->explosionCount++];
-											explosion->position = bullet->position;
-											explosion->position.y -= bulletSrc.height/2.0f;
-											explosion->velocity = enemy->velocity;
-											explosion->startTime = GetTime();
-											explosion->active = true;
-										}
-										enemy->health -= bullet->damage;
-										// Replace bullet with last bullet
-										if (gameState->bulletCount > 0)
-										{
-											*bullet = gameState->bullets[--gameState->bulletCount];
-										} else {
-											gameState->bulletCount = 0;
-										}
-										if (enemy->health <= 0.0f)
-										{
-											gameState->experience += 200;
-											gameState->score += 20 * MAX((int)(enemy->size * 100),1);
-											if (gameState->enemyCount > 0)
-											{
-												*enemy = gameState->enemies[--gameState->enemyCount];
-											} else {
-												gameState->enemyCount = 0;
-											}
-											if(explosion != NULL)
-											{
-												explosion->velocity.x = 0.0f;
-											}
-										}
-									}
-								}
-							}
+							.position = (Vector2) {asteroidXPosition, 0},
+							.health = (size + 1.0),
+							.velocity = (Vector2) {0, speed},
+							.angularVelocity = angularVelocity,
+							.size = size,
+						};
+						int whichAsteroid = RngInt(&gameState->rng[RNG_GAMEPLAY], 1,10);
+						if (whichAsteroid < 6) {
+							components.sprite = SPRITE_ASTEROID1;
+						} else if (whichAsteroid < 9) {
+							components.sprite = SPRITE_ASTEROID2;
+						} else {
+							components.sprite = SPRITE_ASTEROID3;
 						}
+						components.position.y -= SpriteCoords[components.sprite].height; // to make them come into screen smoothly
+						gameState->spawnTime = 0;
+						SpawnAsteroid(gameState, components, (Asteroid){
+							.dying = false,
+							.deathTime = 0.0f,
+						});
 					}
+				}
+				ProfileEnd(profiler, PROFILE_ASTEROIDS);
+				// Stars, enemy and asteroid movement and the bullet broadphase touch disjoint state
+				{
+					JobGraphReset(&graph);
+					JobAdd(&graph, UpdateStarsJob, &jobData, PROFILE_STARS);
+					JobAdd(&graph, MoveEnemiesJob, &jobData, PROFILE_ENEMIES);
+					JobAdd(&graph, BuildBulletHashJob, &jobData, PROFILE_BULLETS);
+					JobAdd(&graph, UpdateAsteroidsJob, &jobData, PROFILE_ASTEROIDS);
+					JobGraphRun(gameMemory->jobs, &graph);
+					ProfileJobs(profiler, &graph);
+				}
+				ProfileBegin(profiler, PROFILE_ENEMIES);
+				// Collision enemy bullet
+				{
+					Archetype* enemies = &gameState->enemies;
+					Archetype* bullets = &gameState->bullets;
+					DetectCollisions(gameMemory->jobs, &jobData, DetectBulletEnemyJob, enemies->count);
+					ResolveCollisions(gameState);
 
-					for (int enemyIndex = 0; enemyIndex < gameState->enemyCount; enemyIndex++)
+					for (int enemyIndex = 0; enemyIndex < enemies->count; enemyIndex++)
 					{
-						Enemy* enemy = &gameState->enemies[enemyIndex];
+						if (!ArchetypeAlive(enemies, enemyIndex)) continue;
+						Enemy* enemy = &gameState->enemyData[enemyIndex];
 						// Shoot bullets (enemies)
 						enemy->shootTime += gameState->dt;
-						if (enemy->shootTime >= 1.0f/enemy->fireRate && gameState->bulletCount <= MAX_BULLETS)
+						if (enemy->shootTime >= 1.0f/enemy->fireRate && bullets->count <= gameState->pools[POOL_BULLETS].limit)
 						{
-							const float random = (1.0f - (float)GetRandomValue(0, 2))/5.0f;
+							const float random = (1.0f - (float)RngInt(&gameState->rng[RNG_AUDIO], 0, 2))/5.0f;
 							SetSoundPitch(audio->sounds[SOUND_GUN], 1.0f + random);
 							PlaySound(audio->sounds[SOUND_GUN]);
 							float bulletSize = 0.5f;
-							if (enemy->bulletCount > 0 && gameState->bulletCount < MAX_BULLETS - enemy->bulletCount)
+							if (enemy->bulletCount > 0 && bullets->count < gameState->pools[POOL_BULLETS].limit - enemy->bulletCount)
 							{
 								int count = enemy->bulletCount;
 								float spreadAngle = 30.0f; // total spread in degrees (adjust as needed)
@@ -1069,383 +2471,114 @@ void UpdateGame(GameMemory* gameMemory)
 									float angleRad = angleDeg * DEG2RAD;
 									float speed = 500.0f;
 
-									Vector2 velocity = { sinf(angleRad) * speed, -cosf(angleRad) * speed };
+									Vector2 velocity = { -sinf(angleRad) * speed, cosf(angleRad) * speed };
 
-									Bullet bullet = {
-										.position = enemy->position,
+									EntityComponents components = {
+										.position = enemies->position[enemyIndex],
 										.velocity = velocity,
-										.damage = 1.0f * enemy->damageMulti,
-										.sprite = getSprite(SPRITE_BULLET),
+										.sprite = SPRITE_BULLET,
 										.rotation = angleDeg,
 										.size = bulletSize,
-										.owner = &enemy,
 									};
 
 									// Adjust Y so bullet spawns at top of player
-									bullet.position.y -= enemy->sprite.coords.height * enemy->size / 2.0f
-										- bullet.sprite.coords.height * bullet.size / 2.0f;
+									components.position.y -= SpriteCoords[enemies->sprite[enemyIndex]].height * enemies->size[enemyIndex] / 2.0f
+										- SpriteCoords[SPRITE_BULLET].height * components.size / 2.0f;
 
-									gameState->bullets[gameState->bulletCount++] = bullet;
+									SpawnBullet(gameState, components, (Bullet){
+										.damage = 1.0f * enemy->damageMulti,
+										.owner = ArchetypeHandle(enemies, enemyIndex),
+									});
 								}
 								enemy->shootTime -= 1.0f / enemy->fireRate;
 							}
 						}
 					}
 				}
-				// Update Bullets
+				ProfileEnd(profiler, PROFILE_ENEMIES);
+				// Update Bullets, integrated in chunks and culled once all of them are done
 				{
-					for (int bulletIndex = 0; bulletIndex < gameState->bulletCount; bulletIndex++)
+					JobGraphReset(&graph);
+					const int chunks = (gameState->bullets.count + BULLET_JOB_CHUNK - 1) / BULLET_JOB_CHUNK;
+					jobData.bulletChunkCount = chunks;
+					for (int chunk = 0; chunk < chunks; chunk++)
 					{
-						Bullet* bullet = &gameState->bullets[bulletIndex];
-						if(!CheckCollisionPointRec(bullet->position, screenRect))
-						{
-							// Replace with last projectile
-							if (gameState->bulletCount > 0)
-							{
-								*bullet = gameState->bullets[--gameState->bulletCount];
-							} else {
-								gameState->bulletCount = 0;
-							}
-						}
-						bullet->position.x -= bullet->velocity.x * gameState->dt;
-						bullet->position.y -= bullet->velocity.y * gameState->dt;
-						const int texture_x = bullet->position.x - bullet->sprite.coords.width * bullet->size / getSprite(SPRITE_BULLET).numFrames / 2.0;
-						const int texture_y = bullet->position.y - bullet->sprite.coords.height * bullet->size / 2.0;
-						const float width = bullet->sprite.coords.width / getSprite(SPRITE_BULLET).numFrames * bullet->size;
-						const float height = bullet->sprite.coords.height * bullet->size;
-						bullet->collider = (Rectangle) {
-							.width = width,
-								.height = height,
-								.x = texture_x,
-								.y = texture_y,
+						jobData.bulletChunks[chunk] = (BulletChunk){
+							.update = &jobData,
+							.first = chunk * BULLET_JOB_CHUNK,
 						};
+						JobAdd(&graph, IntegrateBulletsJob, &jobData.bulletChunks[chunk], PROFILE_BULLETS);
 					}
-				}
-				// Collision player bullet
-				for (int bulletIndex = 0; bulletIndex < gameState->bulletCount; bulletIndex++)
-				{
-					Bullet* bullet = &gameState->bullets[bulletIndex];
-					if(CheckCollisionRecs(gameState->player.collider, bullet->collider) 
-							&& bullet->owner != &gameState->player 
-							&& gameState->player.invulTime <= 0.0f 
-							&& gameState->player.shieldEnabled == false)
-					{
-						Rectangle collisionRec = GetCollisionRec(gameState->player.collider, bullet->collider);
-						gameState->currentCollision = collisionRec;
-						Rectangle bulletSrc = GetCurrentAnimationFrame(atlas->animations[SpriteToAnimation[SPRITE_BULLET]]);
-						Rectangle playerSrc = GetCurrentAnimationFrame(atlas->animations[SpriteToAnimation[SPRITE_PLAYER]]);
-						if (pixelPerfectCollision(spriteMasks[SPRITE_BULLET].pixels, spriteMasks[SPRITE_PLAYER].pixels, 
-									bulletSrc.width, playerSrc.width,
-									bulletSrc.height, playerSrc.height,
-									bullet->collider, gameState->player.collider, collisionRec, bullet->rotation, 0))
-						{
-
-							Explosion* explosion = NULL;
-							if (gameState->explosionCount < MAX_EXPLOSIONS)
-							{
-								PlaySound(audio->sounds[SOUND_EXPLOSIONBLAST]);
-								explosion = &gameState->explosions[gameState->explosionCount++];
-								explosion->position = bullet->position;
-								explosion->position.y -= bulletSrc.height/2.0f;
-								explosion->velocity.y = gameState->player.velocity;
-								explosion->startTime = GetTime();
-								explosion->active = true;
-							}
-							PlaySound(audio->sounds[SOUND_HIT]);
-							// Replace with bullet with last bullet
-							if (gameState->bulletCount > 0)
-							{
-								*bullet = gameState->bullets[--gameState->bulletCount];
-							} else {
-								gameState->bulletCount = 0;
-							}
-							gameState->player.invulTime = gameState->player.invulDuration;
-							if (--gameState->player.health < 1)
-							{
-								gameState->state = STATE_GAME_OVER;
-								gameState->stateChanged = true;
-							}
-						}
-					}
-				}
-				// Spawn Asteroids
-				{
-					gameState->spawnTime += gameState->dt;
-					if (gameState->spawnTime > gameState->asteroidSpawnRate && gameState->asteroidCount < MAX_ASTEROIDS) 
+					const int cull = JobAdd(&graph, CullBulletsJob, &jobData, PROFILE_BULLETS);
+					for (int chunk = 0; chunk < chunks; chunk++)
 					{
-						float size = GetRandomValue(50.0f, 200.0f) / 100.0f;
-						float asteroidXPosition = GetRandomValue(0, VIRTUAL_WIDTH);
-						Asteroid asteroid =
-						{
-							.position = (Vector2) {asteroidXPosition, 0},
-							.health = (size + 1.0),
-							.velocity = (Vector2) {0, GetRandomValue(30.0f, 65.0f) * 5.0f / (float)size},
-							.angularVelocity = GetRandomValue(-40.0f, 40.0f),
-							.size = size,
-							.dying = false,
-							.deathTime = 0.0f,
-						};
-						int whichAsteroid = GetRandomValue(1,10);
-						Sprite asteroidSprite;
-						if (whichAsteroid < 6) {
-							asteroidSprite = getSprite(SPRITE_ASTEROID1);
-						} else if (whichAsteroid < 9) {
-							asteroidSprite = getSprite(SPRITE_ASTEROID2);
-						} else {
-							asteroidSprite = getSprite(SPRITE_ASTEROID3);
-						}
-						asteroid.sprite = asteroidSprite;
-						asteroid.position.y -= asteroid.sprite.coords.height; // to make them come into screen smoothly
-						gameState->spawnTime = 0;
-						gameState->asteroids[gameState->asteroidCount++] = asteroid;
+						JobDepends(&graph, cull, chunk);
 					}
+					JobGraphRun(gameMemory->jobs, &graph);
+					ProfileJobs(profiler, &graph);
 				}
-				// Update asteroids
+				ProfileBegin(profiler, PROFILE_PLAYER_COLLISION);
+				// Collision player bullet
 				{
-					for (int asteroidIndex = 0; asteroidIndex < gameState->asteroidCount; asteroidIndex++)
-					{
-						Asteroid* asteroid = &gameState->asteroids[asteroidIndex];
-						if (!asteroid->dying) {
-							asteroid->position.y += asteroid->velocity.y * gameState->dt;
-							asteroid->rotation   += asteroid->angularVelocity * gameState->dt;
-						} else {
-							// asteroid->position.y -= 20.0 * gameState->dt;
-						}
-
-						float width  = asteroid->sprite.coords.width * asteroid->size;
-						float height = asteroid->sprite.coords.height * asteroid->size;
-						asteroid->collider = (Rectangle) {
-							.x = asteroid->position.x - width / 2.0f,
-								.y = asteroid->position.y - height / 2.0f, 
-								.width  = width,
-								.height = height, 
-						};
-						if (asteroid->dying) {
-							asteroid->deathTime += gameState->dt;
-						}
-						if (asteroid->deathTime > 0.5f) {
-							// printf("dying done: %f\n", asteroid->deathTime);
-							asteroid->dying = false;
-							*asteroid = gameState->asteroids[--gameState->asteroidCount];
-						}
-					}
+					SpatialHashQuery(&gameState->bulletHash, GrowRectangle(gameState->player.collider, gameState->bulletMaxSpeed * gameState->dt), &jobData.playerBullets);
+					ProfileCount(profiler, PROFILE_PAIRS_BRUTE, gameState->bullets.count);
+					ProfileCount(profiler, PROFILE_PAIRS_CANDIDATE, jobData.playerBullets.count);
+					DetectCollisions(gameMemory->jobs, &jobData, DetectBulletPlayerJob, jobData.playerBullets.words);
+					ResolveCollisions(gameState);
 				}
-				// Collision asteroid bullet
+				ProfileEnd(profiler, PROFILE_PLAYER_COLLISION);
+				ProfileBegin(profiler, PROFILE_ASTEROID_COLLISION);
+				// Collision asteroid bullet and asteroid player
 				{
-					for (int asteroidIndex = 0; asteroidIndex < gameState->asteroidCount; asteroidIndex++)
-					{
-						Asteroid* asteroid = &gameState->asteroids[asteroidIndex];
-						for (int bulletIndex = 0; bulletIndex < gameState->bulletCount; bulletIndex++)
-						{
-							Bullet* bullet = &gameState->bullets[bulletIndex];
-							if(bullet->owner == &gameState->player && !asteroid->dying)
-							{
-								if(CheckCollisionRecs(asteroid->collider, bullet->collider))
-								{
-									Rectangle collisionRec = GetCollisionRec(asteroid->collider, bullet->collider);
-									Rectangle bulletSrc = GetCurrentAnimationFrame(atlas->animations[SpriteToAnimation[SPRITE_BULLET]]);
-									if (pixelPerfectCollision(spriteMasks[SPRITE_BULLET].pixels, spriteMasks[asteroid->sprite.spriteID].pixels, 
-												bulletSrc.width, asteroid->sprite.coords.width,
-												bulletSrc.height, asteroid->sprite.coords.height,
-												bullet->collider, asteroid->collider, collisionRec, bullet->rotation, asteroid->rotation))
-									{
-
-										Explosion* explosion = NULL;
-										if (gameState->explosionCount < MAX_EXPLOSIONS)
-										{
-											PlaySound(audio->sounds[SOUND_EXPLOSIONBLAST]);
-											explosion = &gameState->explosions[gameState->explosionCount++];
-											explosion->position = bullet->position;
-											explosion->position.y -= bulletSrc.height/2.0f;
-											explosion->velocity = asteroid->velocity;
-											explosion->startTime = GetTime();
-											explosion->active = true;
-										}
-										asteroid->health -= bullet->damage;
-										// Replace with last bullet
-
-										if (asteroid->health <= 0.0f && !asteroid->dying) {
-											asteroid->dying = true;
-											// Spawn asteroid fragments via particle emitter
-											Vector2 pos = asteroid->position;
-											pos.y += asteroid->sprite.coords.height / 2.0f;
-											pos.x += asteroid->sprite.coords.width  / 2.0f;
-											Particle templateParticle = {
-												.sprite = asteroid->sprite,
-												.positionRange = (Vector4){pos.x, pos.x, pos.y, pos.y},
-												.velocityRange = (Vector4){-100, 100, -100, 100},
-												.angleRange = (Vector2){0, 360},
-												.sizeRange = (Vector2){0.20*asteroid->size, 0.1*asteroid->size},
-												.accelerationRange = (Vector4){0, 0, 0, 0}, 
-												.angularVelocityRange = (Vector2){-200, 200},
-												.startColor = WHITE,
-												.endColor = WHITE,
-												.age = 0.0f,
-												.lifetime = 0.2f + (float)GetRandomValue(0, 50) / 100.0f,
-											};
-											SpawnEmitter(gameState, pos, 15, 120.0f, 0.25f, templateParticle);
-											asteroid->deathTime = 0.0f;
-											gameState->experience += MAX((int)(asteroid->size * 100),1);
-											gameState->score += MAX((int)(asteroid->size * 100),1);
-											if(explosion != NULL)
-											{
-												explosion->velocity.y = 0.0f;
-											}
-										}
-										// Remove bullet
-										*bullet = gameState->bullets[--gameState->bulletCount];
-									}
-								}
-							}
-						}
-
-						// Collision asteroid player
-						if(CheckCollisionRecs(asteroid->collider, gameState->player.collider) && 
-								gameState->player.invulTime <= 0.0f &&
-								gameState->player.shieldEnabled == false &&
-								!asteroid->dying)
-						{
-							Rectangle collisionRec = GetCollisionRec(asteroid->collider, gameState->player.collider);
-							gameState->currentCollision = collisionRec;
-							Rectangle playerSrc = GetCurrentAnimationFrame(atlas->animations[SpriteToAnimation[SPRITE_PLAYER]]);
-							if (pixelPerfectCollision(spriteMasks[SPRITE_PLAYER].pixels, spriteMasks[asteroid->sprite.spriteID].pixels, 
-										playerSrc.width, asteroid->sprite.coords.width,
-										playerSrc.height, asteroid->sprite.coords.height, 
-										gameState->player.collider, asteroid->collider, collisionRec, 0.0f, asteroid->rotation))
-							{
-								PlaySound(audio->sounds[SOUND_HIT]);
-								gameState->player.invulTime = gameState->player.invulDuration;
-								*asteroid = gameState->asteroids[--gameState->asteroidCount];
-								gameState->currentCollision = (Rectangle){0,0,0,0};
-								if(--gameState->player.health < 1) 
-								{
-									gameState->state = STATE_GAME_OVER;
-									gameState->stateChanged = true;
-								}
-							}
-						} 
-						// Check if asteroid is off-screen
-						if (asteroid->position.y > VIRTUAL_HEIGHT + asteroid->sprite.coords.height * asteroid->size)
-						{
-							*asteroid = gameState->asteroids[--gameState->asteroidCount];
-						}
-					}
+					SpatialHashQuery(&gameState->asteroidHash, gameState->player.collider, &jobData.playerAsteroids);
+					ProfileCount(profiler, PROFILE_PAIRS_BRUTE, gameState->asteroids.count);
+					ProfileCount(profiler, PROFILE_PAIRS_CANDIDATE, jobData.playerAsteroids.count);
+					DetectCollisions(gameMemory->jobs, &jobData, DetectAsteroidJob, gameState->asteroids.count);
+					ResolveCollisions(gameState);
 				}
+				ProfileEnd(profiler, PROFILE_ASTEROID_COLLISION);
 				// Collision asteroid mouse
-				Vector2 mouseVirtual = GetVirtualMousePosition();
-				for (int asteroidIndex = 0; asteroidIndex < gameState->asteroidCount; asteroidIndex++)
+				Vector2 mouseVirtual = input->mousePosition;
+				for (int asteroidIndex = 0; asteroidIndex < gameState->asteroids.count; asteroidIndex++)
 				{
-					Asteroid* asteroid = &gameState->asteroids[asteroidIndex];
-					if (CheckCollisionPointRec(mouseVirtual, asteroid->collider))
-					{
-						asteroid->selected = true;
-					} 
-					else 
-					{
-						asteroid->selected = false;
-					}
+					gameState->asteroidData[asteroidIndex].selected = CheckCollisionPointRec(mouseVirtual, gameState->asteroids.collider[asteroidIndex]);
 				}
 
-				// Update explosions
-				{
-					for (int explosionIndex = 0; explosionIndex < gameState->explosionCount; explosionIndex++)
-					{
-						Explosion* explosion = &gameState->explosions[explosionIndex];
-						if (explosion->active)
-						{
-							explosion->position.x += explosion->velocity.x * gameState->dt;
-							explosion->position.y += explosion->velocity.y * gameState->dt;
-						}
-					}
-				}
+				ProfileBegin(profiler, PROFILE_BOOSTS);
 				// Spawn boosts
 				{
-					if (gameState->boostCount < MAX_BOOSTS)
+					if (gameState->boosts.count < gameState->pools[POOL_BOOSTS].capacity)
 					{
 						gameState->boostSpawnTime += gameState->dt;
 					}
-					if (gameState->boostSpawnTime > gameState->boostSpawnRate && gameState->boostCount < MAX_BOOSTS)
+					if (gameState->boostSpawnTime > gameState->boostSpawnRate && gameState->boosts.count < gameState->pools[POOL_BOOSTS].capacity)
 					{
 						// int size = (int)GetRandomValue(1, 3);
-						float size = GetRandomValue(50.0f, 200.0f) / 100.0f;
+						float size = RngInt(&gameState->rng[RNG_GAMEPLAY], 50.0f, 200.0f) / 100.0f;
 						float minSpawnDistance = 50.0f * size;  
-						float boostXPosition = MAX(minSpawnDistance, GetRandomValue(0, VIRTUAL_WIDTH));
-						Boost boost = {
+						float boostXPosition = MAX(minSpawnDistance, RngInt(&gameState->rng[RNG_GAMEPLAY], 0, VIRTUAL_WIDTH));
+						float speed = RngInt(&gameState->rng[RNG_GAMEPLAY], 30.0f, 65.0f) * 5.0f / (float)size;
+						EntityComponents components = {
 							.position = (Vector2) {boostXPosition, 0},
-							.velocity = (Vector2) {0, GetRandomValue(30.0f, 65.0f) * 5.0f / (float)size},
+							.velocity = (Vector2) {0, speed},
 							.angularVelocity = 0.0f,
 							.size = 2.0f,
 							.rotation = 0.0f,
+							.sprite = SPRITE_SCRAPMETAL,
 						};
-						Sprite boostSprite;
-						boostSprite = getSprite(SPRITE_SCRAPMETAL);
-						boost.sprite = boostSprite;
-						boost.position.y -= boost.sprite.coords.height; // to make them come into screen smoothly
+						components.position.y -= SpriteCoords[SPRITE_SCRAPMETAL].height; // to make them come into screen smoothly
 						gameState->boostSpawnTime = 0;
-						gameState->boosts[gameState->boostCount++] = boost;
-					}
-				}
-				// Update boosts
-				{
-					for (int boostIndex = 0; boostIndex < gameState->boostCount; boostIndex++)
-					{
-						Boost* boost = &gameState->boosts[boostIndex];
-						boost->position.y += boost->velocity.y * gameState->dt;
-						boost->rotation += boost->angularVelocity * gameState->dt;
-						float width  = boost->sprite.coords.width / boost->sprite.numFrames * boost->size;
-						float height = boost->sprite.coords.height * boost->size;
-						boost->collider = (Rectangle) {
-							.x = boost->position.x - width / 2.0f,
-								.y = boost->position.y - height / 2.0f,
-								.width = width,
-								.height = height, 
-						};
-						// Check if boost is off-screen
-						if (boost->position.y > VIRTUAL_HEIGHT + boost->sprite.coords.height * boost->size)
-						{
-							*boost = gameState->boosts[--gameState->boostCount];
-							gameState->boostSpawnTime = 0.0f;
-						}
-						// Collision boost player
-						if(CheckCollisionRecs(boost->collider, gameState->player.collider))
-						{
-							Rectangle collisionRec = GetCollisionRec(boost->collider, gameState->player.collider);
-							gameState->currentCollision = collisionRec;
-							Rectangle playerSrc = GetCurrentAnimationFrame(atlas->animations[SpriteToAnimation[SPRITE_PLAYER]]);
-							Rectangle boostSrc = GetCurrentAnimationFrame(atlas->animations[SpriteToAnimation[SPRITE_SCRAPMETAL]]);
-							if (pixelPerfectCollision(spriteMasks[SPRITE_PLAYER].pixels, spriteMasks[boost->sprite.spriteID].pixels, 
-										playerSrc.width, boostSrc.width,
-										playerSrc.height, boostSrc.height,
-										gameState->player.collider, boost->collider, collisionRec, 0.0f, boost->rotation))
-							{
-								*boost = gameState->boosts[--gameState->boostCount];
-								gameState->player.shieldEnabled = true;
-								gameState->player.shieldTime = 5.25f;
-								if(IsSoundPlaying(audio->sounds[SOUND_SHIELD]))
-								{
-									StopSound(audio->sounds[SOUND_SHIELD]);
-								}
-								PlaySound(audio->sounds[SOUND_SHIELD]);
-								gameState->currentCollision = (Rectangle){0,0,0,0};
-							}
-						} 
+						SpawnBoost(gameState, components);
 					}
 				}
+				ProfileEnd(profiler, PROFILE_BOOSTS);
+				ProfileBegin(profiler, PROFILE_EMITTERS);
 				// Test particle emitter
 				{
-					if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-
-						Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
-						float scale = viewport.width / VIRTUAL_WIDTH;
-						float letterBoxOffsetX = (GetRenderWidth()  - viewport.width)  / 2.0f;
-						float letterBoxOffsetY = (GetRenderHeight() - viewport.height) / 2.0f;
-						Vector2 mouse = GetMousePosition();
-						Vector2 mousePosition = {
-							(mouse.x - letterBoxOffsetX) / scale,
-							(mouse.y - letterBoxOffsetY) / scale
-						};
-						Particle templateParticle = {
-							.sprite = getSprite(SPRITE_HEART),
+					if (InputPressed(input, INPUT_CLICK)) {
+						Vector2 mousePosition = input->mousePosition;
+						ParticleTemplate particleTemplate = {
+							.sprite = SPRITE_HEART,
 							.positionRange = (Vector4){mousePosition.x, mousePosition.x, mousePosition.y, mousePosition.y},
 							.velocityRange = (Vector4){50, 100, 50, 100},
 							.angleRange = (Vector2){0, 360},
@@ -1454,22 +2587,57 @@ void UpdateGame(GameMemory* gameMemory)
 							.angularVelocityRange = (Vector2){-300, 300},
 							.startColor = WHITE,
 							.endColor = WHITE,
-							.age = 0.0f,
-							.lifetime = 1.0f + (float)GetRandomValue(0, 50) / 100.0f,
+							.lifetime = 1.0f + (float)RngInt(&gameState->rng[RNG_PARTICLES], 0, 50) / 100.0f,
 						};
 #ifndef PLATFORM_WEB
-						SpawnEmitter(gameState, mousePosition, 20, 30.0f, 0.5f, templateParticle);
+						SpawnEmitter(gameState, mousePosition, 20, 30.0f, 0.5f, particleTemplate);
 #endif
 					}
 				}
-				// Update emitters
-				UpdateEmitters(gameState, gameState->dt);
+				ProfileEnd(profiler, PROFILE_EMITTERS);
+				// Explosions, boosts and emitters touch disjoint state
+				{
+					JobGraphReset(&graph);
+					JobAdd(&graph, UpdateExplosionsJob, &jobData, -1);
+					JobAdd(&graph, UpdateBoostsJob, &jobData, PROFILE_BOOSTS);
+					JobAdd(&graph, UpdateEmittersJob, &jobData, PROFILE_EMITTERS);
+					JobGraphRun(gameMemory->jobs, &graph);
+					ProfileJobs(profiler, &graph);
+				}
+				ProfileBegin(profiler, PROFILE_BOOSTS);
+				// Collision boost player, resolved here so the jobs above never write the player
+				{
+					Archetype* boosts = &gameState->boosts;
+					long* counters = ProfileCounters(profiler);
+					SpatialQuery query;
+					SpatialHashQuery(&gameState->boostHash, gameState->player.collider, &query);
+					ProfileCount(profiler, PROFILE_PAIRS_BRUTE, boosts->count);
+					ProfileCount(profiler, PROFILE_PAIRS_CANDIDATE, query.count);
+					for (int boostIndex; (boostIndex = SpatialQueryNext(&query)) >= 0;)
+					{
+						if (!ArchetypeAlive(boosts, boostIndex)) continue;
+						if (CandidatesOverlap(counters, boosts->collider[boostIndex], gameState->player.collider))
+						{
+							Rectangle collisionRec = GetCollisionRec(boosts->collider[boostIndex], gameState->player.collider);
+							gameState->currentCollision = collisionRec;
+							if (MasksCollide(counters, &jobData.playerMask, &jobData.boostMask,
+										gameState->player.collider, boosts->collider[boostIndex], collisionRec, 0.0f, boosts->rotation[boostIndex]))
+							{
+								CollisionEmit(&gameState->collisions, COLLISION_BOOST_PLAYER, boostIndex, 0, boosts->position[boostIndex]);
+							}
+						}
+					}
+					ResolveCollisions(gameState);
+				}
+				ProfileEnd(profiler, PROFILE_BOOSTS);
+				// Sounds of all collision passes, once each
+				PlayCollisionSounds(&gameState->collisions, audio);
 				break;
 			}
 		case STATE_UPGRADE:
 			{
 				LoopSoundtrack(&audio->music[audio->currentSongtrackID]);
-				if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_P)) {
+				if (InputPressed(input, INPUT_PAUSE)) {
 					gameState->state = STATE_PAUSED;
 					gameState->lastState = STATE_UPGRADE;
 					gameState->stateChanged = true;
@@ -1479,15 +2647,15 @@ void UpdateGame(GameMemory* gameMemory)
 					StopSound(audio->sounds[SOUND_SHIELD]);
 				}
 
-				Vector2 mousePos = GetMousePosition();
+				Vector2 mousePos = input->mousePosition;
 				bool clickedUpgrade = false;
 				int lastUpgrade = gameState->pickedUpgrade; 
-				if (IsKeyPressed(KEY_LEFT)) 
+				if (InputPressed(input, INPUT_SELECT_LEFT)) 
 				{
 					PlaySound(audio->sounds[SOUND_CARDSELECT]);
 					gameState->pickedUpgrade = (Upgrade)((gameState->pickedUpgrade - 1 + UPGRADE_COUNT) % UPGRADE_COUNT);
 				} 
-				else if (IsKeyPressed(KEY_RIGHT)) 
+				else if (InputPressed(input, INPUT_SELECT_RIGHT)) 
 				{
 					PlaySound(audio->sounds[SOUND_CARDSELECT]);
 					gameState->pickedUpgrade = (Upgrade)((gameState->pickedUpgrade + 1) % UPGRADE_COUNT);
@@ -1501,23 +2669,16 @@ void UpdateGame(GameMemory* gameMemory)
 					options->disableCursor = false;
 				}
 				options->lastMousePos = mousePos;
-				int mouseOverUpgrade = -1;
-				for (int i = 0; i < UPGRADE_COUNT; i++) 
+				int mouseOverUpgrade = input->hoveredUpgrade;
+				if (mouseOverUpgrade != -1 && !options->disableCursor)
 				{
-					if (CheckCollisionPointRec(mousePos, gameState->upgradeCards[i].rect))
+					gameState->pickedUpgrade = mouseOverUpgrade; 
+					if (lastUpgrade != gameState->pickedUpgrade) 
 					{
-						mouseOverUpgrade = i;
-						if (!options->disableCursor) {
-							gameState->pickedUpgrade = i; 
-							if (lastUpgrade != gameState->pickedUpgrade) 
-							{
-								PlaySound(audio->sounds[SOUND_CARDSELECT]);
-							}
-						}
-						// break;
+						PlaySound(audio->sounds[SOUND_CARDSELECT]);
 					}
 				}
-				if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && mouseOverUpgrade != -1)
+				if (InputPressed(input, INPUT_CLICK) && mouseOverUpgrade != -1)
 				{
 					gameState->pickedUpgrade = mouseOverUpgrade;
 					clickedUpgrade = true;
@@ -1525,7 +2686,7 @@ void UpdateGame(GameMemory* gameMemory)
 					// printf("selectedUpgrade: %d\n", gameState->pickedUpgrade);
 				}
 				// printf("clickedUpgrade: %d\n", clickedUpgrade);
-				if (IsKeyPressed(KEY_ENTER) || clickedUpgrade) {
+				if (InputPressed(input, INPUT_CONFIRM) || clickedUpgrade) {
 					if (gameState->pickedUpgrade == UPGRADE_MULTISHOT) {
 						gameState->player.bulletCount += 2;
 					} else if (gameState->pickedUpgrade == UPGRADE_DAMAGE) {
@@ -1541,30 +2702,28 @@ void UpdateGame(GameMemory* gameMemory)
 		case STATE_GAME_OVER:
 			{
 				LoopSoundtrack(&audio->music[audio->currentSongtrackID]);
-				if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_P)) {
+				if (InputPressed(input, INPUT_PAUSE)) {
 					gameState->state = STATE_PAUSED;
 					gameState->lastState = STATE_GAME_OVER;
 					gameState->stateChanged = true;
 				}
-				if (IsKeyPressed(KEY_ENTER)) {
+				if (InputPressed(input, INPUT_CONFIRM)) {
 #ifdef PLATFORM_WEB
 					GameState gameState = {0};
 					Audio audio = {0};
-					InitializeOptions(gameMemory->options);
-					InitializeGameState(gameMemory->gameState);
+					RestartOptions(gameMemory->options);
+					InitializeGameState(gameMemory->gameState, NextGameSeed(gameMemory->gameState));
 					CloseAudioDevice();
 					InitializeAudio(gameMemory->audio, gameMemory->options);
 					// gameMemory->options = &options;
-					RenderTexture2D scene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
-					RenderTexture2D litScene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
-					SpriteMask spriteMasks[SPRITE_COUNT];
-					TextureAtlas atlas = initTextureAtlas(spriteMasks);
-					gameMemory->scene = &scene;
-					gameMemory->litScene = &litScene;
-
-					// Write the initialized state to gameMemory
-					gameMemory->atlas = &atlas;
-					gameMemory->spriteMasks = spriteMasks;
+					// Write the initialized state to the memory owned by the platform layer
+					*gameMemory->scene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
+					*gameMemory->litScene = LoadRenderTexture(gameMemory->options->screenWidth, gameMemory->options->screenHeight);
+					for (int i = 0; i < SPRITE_COUNT; i++)
+					{
+						freeSpriteMask(&gameMemory->spriteMasks[i]);
+					}
+					*gameMemory->atlas = initTextureAtlas(gameMemory->spriteMasks);
 					gameMemory->options->previousWidth  = VIRTUAL_WIDTH;
 					gameMemory->options->previousHeight = VIRTUAL_HEIGHT;
 					*gameMemory->shader = LoadShader(0, TextFormat("./src/shaders/default_web.glsl", GLSL_VERSION));
@@ -1574,8 +2733,8 @@ void UpdateGame(GameMemory* gameMemory)
 					gameMemory->gameState->state = STATE_RUNNING;
 					gameMemory->gameState->stateChanged = true;
 #else
-					InitializeOptions(options);
-					InitializeGameState(gameState);
+					RestartOptions(options);
+					InitializeGameState(gameState, NextGameSeed(gameState));
 					gameState->state = STATE_RUNNING;
 					gameState->stateChanged = true;
 #endif
@@ -1606,7 +2765,7 @@ void UpdateGame(GameMemory* gameMemory)
 					SetFxVolume(audio, options->fxVolume);
 					options->fxVolumeChanged = false;
 				}
-				if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_P)) 
+				if (InputPressed(input, INPUT_PAUSE)) 
 				{
 					gameState->state = gameState->lastState;
 					gameState->stateChanged = true;
@@ -1615,24 +2774,259 @@ void UpdateGame(GameMemory* gameMemory)
 			}
 	}
 }
-void DrawEmitter(TextureAtlas* atlas, const ParticleEmitter* e)
+// Snapshot of the positions before a tick, used to interpolate when drawing
+void StorePreviousPositions(GameState* gameState)
+{
+	gameState->player.previousPosition = gameState->player.position;
+	StorePreviousTransforms(&gameState->enemies);
+	StorePreviousTransforms(&gameState->bullets);
+	StorePreviousTransforms(&gameState->asteroids);
+	StorePreviousTransforms(&gameState->boosts);
+	for (int i = 0; i < gameState->starCount; i++)
+	{
+		gameState->stars[i].previousPosition = gameState->stars[i].position;
+	}
+	for (int i = 0; i < gameState->particleEmitterCount; i++)
+	{
+		ParticleEmitter* e = &gameState->particleEmitters[i];
+		for (int j = 0; j < e->particleCount; j++)
+		{
+			e->particles[j].previousPosition = e->particles[j].position;
+		}
+	}
+}
+
+// Bytes of entity state a tick streams through: the player, the columns and
+// per-kind data of every live entity, the live stars and particles. The rest
+// of GameState and the broadphase are left out.
+size_t EntityBytesTouched(const GameState* gameState)
+{
+	size_t bytes = sizeof(Player);
+	bytes += gameState->enemies.count * (ArchetypeEntityBytes(&gameState->enemies) + sizeof(Enemy));
+	bytes += gameState->bullets.count * (ArchetypeEntityBytes(&gameState->bullets) + sizeof(Bullet));
+	bytes += gameState->asteroids.count * (ArchetypeEntityBytes(&gameState->asteroids) + sizeof(Asteroid));
+	bytes += gameState->boosts.count * ArchetypeEntityBytes(&gameState->boosts);
+	bytes += gameState->starCount * sizeof(Star);
+	for (int i = 0; i < gameState->particleEmitterCount; i++)
+	{
+		const ParticleEmitter* e = &gameState->particleEmitters[i];
+		bytes += sizeof(ParticleEmitter) - sizeof(e->particles) + e->particleCount * sizeof(Particle);
+	}
+	return bytes;
+}
+
+// Component columns of an archetype, column by column
+uint64_t ChecksumArchetype(uint64_t hash, const Archetype* archetype)
+{
+	const int count = archetype->count;
+	hash = ChecksumInt(hash, count);
+	for (int i = 0; i < count; i++) hash = ChecksumVector2(hash, archetype->position[i]);
+	for (int i = 0; i < count; i++) hash = ChecksumFloat(hash, archetype->rotation[i]);
+	for (int i = 0; i < count; i++) hash = ChecksumVector2(hash, archetype->velocity[i]);
+	for (int i = 0; i < count; i++) hash = ChecksumFloat(hash, archetype->angularVelocity[i]);
+	for (int i = 0; i < count; i++) hash = ChecksumFloat(hash, archetype->size[i]);
+	for (int i = 0; i < count; i++) hash = ChecksumInt(hash, archetype->sprite[i]);
+	for (int i = 0; i < count; i++) hash = ChecksumRectangle(hash, archetype->collider[i]);
+	for (int i = 0; i < count; i++) hash = ChecksumFloat(hash, archetype->health[i]);
+	return hash;
+}
+
+// Hash of everything the simulation reads back on the next tick. Left out:
+// previous positions (a copy for interpolation), asteroid selection and
+// currentCollision (debug drawing), upgrade card rects (layout from the draw
+// pass) and timeScale, which only paces the render accumulator.
+uint64_t GameStateChecksum(const GameState* gameState)
+{
+	uint64_t hash = CHECKSUM_SEED;
+	hash = ChecksumU64(hash, (uint64_t)gameState->tick);
+	hash = ChecksumInt(hash, gameState->state);
+	hash = ChecksumInt(hash, gameState->lastState);
+	hash = ChecksumInt(hash, gameState->experience);
+	hash = ChecksumInt(hash, gameState->score);
+	hash = ChecksumFloat(hash, gameState->time);
+	hash = ChecksumInt(hash, gameState->pickedUpgrade);
+	hash = ChecksumInt(hash, gameState->maxPlayerBullets);
+	// Timers
+	hash = ChecksumFloat(hash, gameState->enemySpawnRate);
+	hash = ChecksumFloat(hash, gameState->enemySpawnTime);
+	hash = ChecksumFloat(hash, gameState->spawnTime);
+	hash = ChecksumFloat(hash, gameState->asteroidSpawnRate);
+	hash = ChecksumFloat(hash, gameState->boostSpawnTime);
+	hash = ChecksumFloat(hash, gameState->boostSpawnRate);
+	hash = ChecksumFloat(hash, gameState->starTime);
+	hash = ChecksumFloat(hash, gameState->starSpawnRate);
+	hash = ChecksumInt(hash, gameState->initStars);
+	// Random streams
+	for (int i = 0; i < RNG_STREAM_COUNT; i++)
+	{
+		for (int j = 0; j < 4; j++) hash = ChecksumU32(hash, gameState->rng[i].s[j]);
+	}
+	// Player
+	const Player* player = &gameState->player;
+	hash = ChecksumFloat(hash, player->velocity);
+	hash = ChecksumVector2(hash, player->position);
+	hash = ChecksumInt(hash, player->health);
+	hash = ChecksumInt(hash, player->sprite);
+	hash = ChecksumInt(hash, player->size);
+	hash = ChecksumInt(hash, player->animationFrames);
+	hash = ChecksumFloat(hash, player->invulTime);
+	hash = ChecksumFloat(hash, player->invulDuration);
+	hash = ChecksumInt(hash, player->bulletCount);
+	hash = ChecksumFloat(hash, player->fireRate);
+	hash = ChecksumFloat(hash, player->shootTime);
+	hash = ChecksumFloat(hash, player->damageMulti);
+	hash = ChecksumInt(hash, player->shieldEnabled);
+	hash = ChecksumFloat(hash, player->shieldTime);
+	hash = ChecksumRectangle(hash, player->collider);
+	hash = ChecksumInt(hash, player->level);
+	// Enemies
+	hash = ChecksumArchetype(hash, &gameState->enemies);
+	for (int i = 0; i < gameState->enemies.count; i++)
+	{
+		const Enemy* enemy = &gameState->enemyData[i];
+		hash = ChecksumFloat(hash, enemy->phase);
+		hash = ChecksumFloat(hash, enemy->phaseRate);
+		hash = ChecksumFloat(hash, enemy->fireRate);
+		hash = ChecksumFloat(hash, enemy->shootTime);
+		hash = ChecksumFloat(hash, enemy->damageMulti);
+		hash = ChecksumInt(hash, enemy->bulletCount);
+	}
+	// Bullets
+	hash = ChecksumArchetype(hash, &gameState->bullets);
+	for (int i = 0; i < gameState->bullets.count; i++)
+	{
+		const Bullet* bullet = &gameState->bulletData[i];
+		hash = ChecksumFloat(hash, bullet->damage);
+		hash = ChecksumU32(hash, bullet->owner.slot);
+		hash = ChecksumU32(hash, bullet->owner.generation);
+	}
+	// Asteroids
+	hash = ChecksumArchetype(hash, &gameState->asteroids);
+	for (int i = 0; i < gameState->asteroids.count; i++)
+	{
+		const Asteroid* asteroid = &gameState->asteroidData[i];
+		hash = ChecksumInt(hash, asteroid->dying);
+		hash = ChecksumFloat(hash, asteroid->deathTime);
+	}
+	// Boosts
+	hash = ChecksumArchetype(hash, &gameState->boosts);
+	// Explosions
+	hash = ChecksumInt(hash, gameState->explosionCount);
+	for (int i = 0; i < gameState->explosionCount; i++)
+	{
+		const Explosion* explosion = &gameState->explosions[i];
+		hash = ChecksumVector2(hash, explosion->position);
+		hash = ChecksumVector2(hash, explosion->velocity);
+		hash = ChecksumFloat(hash, explosion->age);
+	}
+	// Stars
+	hash = ChecksumInt(hash, gameState->starCount);
+	for (int i = 0; i < gameState->starCount; i++)
+	{
+		const Star* star = &gameState->stars[i];
+		hash = ChecksumVector2(hash, star->position);
+		hash = ChecksumFloat(hash, star->size);
+		hash = ChecksumFloat(hash, star->velocity);
+		hash = ChecksumFloat(hash, star->alpha);
+		hash = ChecksumInt(hash, star->sprite);
+	}
+	// Particle emitters
+	hash = ChecksumInt(hash, gameState->particleEmitterCount);
+	for (int i = 0; i < gameState->particleEmitterCount; i++)
+	{
+		const ParticleEmitter* e = &gameState->particleEmitters[i];
+		hash = ChecksumVector2(hash, e->position);
+		hash = ChecksumInt(hash, e->maxParticleCount);
+		hash = ChecksumFloat(hash, e->spawnRate);
+		hash = ChecksumFloat(hash, e->spawnTimer);
+		hash = ChecksumFloat(hash, e->age);
+		hash = ChecksumFloat(hash, e->lifetime);
+		hash = ChecksumInt(hash, e->particleCount);
+		for (int j = 0; j < e->particleCount; j++)
+		{
+			const Particle* p = &e->particles[j];
+			hash = ChecksumVector2(hash, p->position);
+			hash = ChecksumVector2(hash, p->velocity);
+			hash = ChecksumVector2(hash, p->acceleration);
+			hash = ChecksumFloat(hash, p->angularVelocity);
+			hash = ChecksumFloat(hash, p->rotation);
+			hash = ChecksumFloat(hash, p->age);
+			hash = ChecksumFloat(hash, p->lifetime);
+		}
+	}
+	return hash;
+}
+
+// Advances the simulation by exactly one fixed step
+void SimulateTick(GameMemory* gameMemory, float dt)
+{
+	GameState* gameState = gameMemory->gameState;
+	Replay* replay = gameMemory->replay;
+	if (replay->mode == REPLAY_PLAYING)
+	{
+		ReplayTick tick;
+		if (ReplayPlaybackTick(replay, &tick))
+		{
+			gameState->input = (GameInput){
+				.down = tick.down,
+				.pressed = tick.pressed,
+				.mousePosition = (Vector2){tick.mouseX, tick.mouseY},
+				.hoveredUpgrade = tick.hoveredUpgrade,
+			};
+		}
+		else
+		{
+			replay->mode = REPLAY_OFF;
+			TraceLog(LOG_INFO, "Replay finished after %u ticks", replay->tickCount);
+		}
+	}
+	else if (replay->mode == REPLAY_RECORDING)
+	{
+		ReplayRecordTick(replay, (ReplayTick){
+				.down = (uint16_t)gameState->input.down,
+				.pressed = (uint16_t)gameState->input.pressed,
+				.mouseX = gameState->input.mousePosition.x,
+				.mouseY = gameState->input.mousePosition.y,
+				.hoveredUpgrade = (int8_t)gameState->input.hoveredUpgrade,
+				});
+	}
+	StorePreviousPositions(gameState);
+	gameState->dt = dt;
+	gameState->time += dt;
+	ProfileBegin(gameMemory->profiler, PROFILE_UPDATE);
+	UpdateGame(gameMemory);
+	CompactEntities(gameState);
+	ProfileEnd(gameMemory->profiler, PROFILE_UPDATE);
+	gameMemory->profiler->frames[gameMemory->profiler->current].ticks++;
+	gameState->input.pressed = 0;
+	gameState->tick++;
+	if (gameMemory->checksumLog)
+	{
+		fprintf(gameMemory->checksumLog, "%ld %016llx\n", gameState->tick, (unsigned long long)GameStateChecksum(gameState));
+	}
+}
+
+void DrawEmitter(TextureAtlas* atlas, const ParticleEmitter* e, float alpha)
 {
+	const Rectangle coords = SpriteCoords[e->particleTemplate.sprite];
+	const Vector2 sizeRange = e->particleTemplate.sizeRange;
 	// Draw particles 
 	for (int i = 0; i < e->particleCount; i++)
 	{
 		const Particle* p = &e->particles[i];
+		const Vector2 position = Vector2Lerp(p->previousPosition, p->position, alpha);
 		// float t = p->age / p->lifetime;
 		float t = EaseInOutCubic(p->age / p->lifetime);
-		Color c = p->startColor;
+		Color c = e->particleTemplate.startColor;
 		c.a = (unsigned char)(255 * (1.0f - t)); // fade out
-		float scale = p->sizeRange.x + t * ( p->sizeRange.y - p->sizeRange.x);
+		float scale = sizeRange.x + t * ( sizeRange.y - sizeRange.x);
 		DrawTexturePro(atlas->textureAtlas, 
-				p->sprite.coords,
+				coords,
 				(Rectangle){
-				.x = p->position.x - p->sprite.coords.width/2.0f,
-				.y = p->position.y - p->sprite.coords.height/2.0f,
-				.width = p->sprite.coords.width * scale,
-				.height = p->sprite.coords.height * scale,
+				.x = position.x - coords.width/2.0f,
+				.y = position.y - coords.height/2.0f,
+				.width = coords.width * scale,
+				.height = coords.height * scale,
 				},
 				(Vector2){0,0}, 
 				p->rotation, 
@@ -1643,6 +3037,7 @@ void DrawEmitter(TextureAtlas* atlas, const ParticleEmitter* e)
 void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, RenderTexture2D* scene, Shader* shader, Shader* explosionShader, Shader* outlineShader)
 {
 	int progressLoc = GetShaderLocation(*explosionShader, "progress");
+	const float alpha = gameState->renderAlpha;
 	BeginTextureMode(*scene);
 
 	switch (gameState->state) {
@@ -1653,7 +3048,7 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 				for (int i = 0; i < gameState->particleEmitterCount; i++)
 				{
 					BeginShaderMode(*shader);
-					DrawEmitter(atlas, &gameState->particleEmitters[i]);
+					DrawEmitter(atlas, &gameState->particleEmitters[i], gameState->renderAlpha);
 					EndShaderMode();
 				}
 				break;
@@ -1666,21 +3061,21 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 				if (options->showDebugInfo)
 				{
 					DrawRectangleLinesEx(gameState->player.collider, 2.0, GREEN);
-					for (int i = 0; i < gameState->bulletCount; i++)
+					for (int i = 0; i < gameState->bullets.count; i++)
 					{
-						DrawRectangleLinesEx(gameState->bullets[i].collider, 2.0, PURPLE);
+						DrawRectangleLinesEx(gameState->bullets.collider[i], 2.0, PURPLE);
 					}
-					for (int i = 0; i < gameState->asteroidCount; i++)
+					for (int i = 0; i < gameState->asteroids.count; i++)
 					{
-						DrawRectangleLinesEx(gameState->asteroids[i].collider, 2.0, RED);
+						DrawRectangleLinesEx(gameState->asteroids.collider[i], 2.0, RED);
 					}
-					for (int i = 0; i < gameState->boostCount; i++)
+					for (int i = 0; i < gameState->boosts.count; i++)
 					{
-						DrawRectangleLinesEx(gameState->boosts[i].collider, 2.0, YELLOW);
+						DrawRectangleLinesEx(gameState->boosts.collider[i], 2.0, YELLOW);
 					}
-					for (int i = 0; i < gameState->enemyCount; i++)
+					for (int i = 0; i < gameState->enemies.count; i++)
 					{
-						DrawRectangleLinesEx(gameState->enemies[i].collider, 2.0, BLUE);
+						DrawRectangleLinesEx(gameState->enemies.collider[i], 2.0, BLUE);
 					}
 					DrawRectangleRec(gameState->currentCollision, RED);
 					gameState->currentCollision = (Rectangle){0,0,0,0};
@@ -1692,24 +3087,31 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 					for (int starIndex = 0; starIndex < gameState->starCount; starIndex++)
 					{
 						Star* star = &gameState->stars[starIndex];
+						const Vector2 position = Vector2Lerp(star->previousPosition, star->position, alpha);
 
-						const int texture_x = star->position.x - star->sprite.coords.width / 2.0 * star->size;
-						const int texture_y = star->position.y - star->sprite.coords.height / 2.0 * star->size;
+						const Rectangle coords = SpriteCoords[star->sprite];
+						const int texture_x = position.x - coords.width / 2.0 * star->size;
+						const int texture_y = position.y - coords.height / 2.0 * star->size;
 						Color starColor = ColorAlpha(WHITE, star->alpha);
-						DrawTextureRec(atlas->textureAtlas, getSprite(SPRITE_STAR1).coords, (Vector2) {texture_x, texture_y}, starColor);
+						DrawTextureRec(atlas->textureAtlas, SpriteCoords[SPRITE_STAR1], (Vector2) {texture_x, texture_y}, starColor);
 					}
 				}
 				// Only after drawing stars with alpha values. Otherwise alpha needs to be passed to the shader?
 				// Draw asteroids
 				{
-					for (int asteroidIndex = 0; asteroidIndex < gameState->asteroidCount; asteroidIndex++)
+					const Archetype* asteroids = &gameState->asteroids;
+					for (int asteroidIndex = 0; asteroidIndex < asteroids->count; asteroidIndex++)
 					{
-						Asteroid* asteroid = &gameState->asteroids[asteroidIndex];
-						float width = asteroid->sprite.coords.width * asteroid->size;
-						float height = asteroid->sprite.coords.height * asteroid->size;
+						const Asteroid* asteroid = &gameState->asteroidData[asteroidIndex];
+						const Vector2 position = Vector2Lerp(asteroids->previousPosition[asteroidIndex], asteroids->position[asteroidIndex], alpha);
+						const float rotation = Lerp(asteroids->previousRotation[asteroidIndex], asteroids->rotation[asteroidIndex], alpha);
+						const Rectangle coords = SpriteCoords[asteroids->sprite[asteroidIndex]];
+						const Vector2 pivot = {asteroids->collider[asteroidIndex].width/2.0f, asteroids->collider[asteroidIndex].height/2.0f};
+						float width = coords.width * asteroids->size[asteroidIndex];
+						float height = coords.height * asteroids->size[asteroidIndex];
 						Rectangle asteroidDrawRect = {
-							.x = asteroid->position.x,
-							.y = asteroid->position.y, 
+							.x = position.x,
+							.y = position.y, 
 							.width = width,
 							.height = height, 
 						};
@@ -1719,18 +3121,17 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 							BeginShaderMode(*explosionShader);
 							float progress = Remap(asteroid->deathTime,0.0f,0.5f,0.0f,1.0f);		
 							SetShaderValue(*explosionShader, progressLoc, &progress, SHADER_UNIFORM_FLOAT);
-							DrawTexturePro(atlas->textureAtlas, asteroid->sprite.coords, asteroidDrawRect, 
-									(Vector2){asteroid->collider.width/2.0f, asteroid->collider.height/2.0f}, asteroid->rotation, WHITE);
+							DrawTexturePro(atlas->textureAtlas, coords, asteroidDrawRect, pivot, rotation, WHITE);
 							EndShaderMode();
 						} else {
 							if (0) {
 								Color outlineColor = WHITE;
 								float outlineWidth = 1.0f;
 								DrawTextureWithOutlinePro(atlas->textureAtlas,
-										asteroid->sprite.coords,
+										coords,
 										asteroidDrawRect, 
-										(Vector2){asteroid->collider.width/2.0f, asteroid->collider.height/2.0f}, 
-										asteroid->rotation,
+										pivot, 
+										rotation,
 										WHITE, 
 										outlineColor,
 										outlineWidth, 
@@ -1739,10 +3140,10 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 								// SetShaderValue(*shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 								BeginShaderMode(*shader);
 								DrawTexturePro(atlas->textureAtlas, 
-										asteroid->sprite.coords, 
+										coords, 
 										asteroidDrawRect, 
-										(Vector2){asteroid->collider.width/2.0f, asteroid->collider.height/2.0f}, 
-										asteroid->rotation, 
+										pivot, 
+										rotation, 
 										WHITE);
 								EndShaderMode();
 							}
@@ -1753,88 +3154,84 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 				}
 				// Draw Bullets
 				{
-					for (int bulletIndex = 0; bulletIndex < gameState->bulletCount; bulletIndex++)
+					const Archetype* bullets = &gameState->bullets;
+					for (int bulletIndex = 0; bulletIndex < bullets->count; bulletIndex++)
 					{
-						Bullet* bullet = &gameState->bullets[bulletIndex];
-						Vector2 texSize = { bullet->collider.width, bullet->collider.height };
+						const Vector2 position = Vector2Lerp(bullets->previousPosition[bulletIndex], bullets->position[bulletIndex], alpha);
+						Rectangle bulletDrawRect = bullets->collider[bulletIndex];
+						bulletDrawRect.x += position.x - bullets->position[bulletIndex].x;
+						bulletDrawRect.y += position.y - bullets->position[bulletIndex].y;
 						// SetShaderValue(*shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 						// Change the frame per second speed of animation
 						// atlas->animations[SpriteToAnimation[SPRITE_BULLET]].framesPerSecond = 14;
 						bool flipY = false;
-						if (bullet->owner != &gameState->player) flipY = true;
+						if (!HandleIsNone(gameState->bulletData[bulletIndex].owner)) flipY = true;
 						BeginShaderMode(*shader);
 						DrawSpriteAnimationPro(&atlas->textureAtlas, 
 								&atlas->animations[SpriteToAnimation[SPRITE_BULLET]],
-								bullet->collider, 
+								bulletDrawRect, 
 								(Vector2){0, 0}, 
-								bullet->rotation, 
+								bullets->rotation[bulletIndex], 
 								WHITE, 
 								false, 
-								flipY);
+								flipY,
+								gameState->time);
 						EndShaderMode();
 					}
 				}
 				// Draw boosts
 				{
-					for (int boostIndex = 0; boostIndex < gameState->boostCount; boostIndex++)
+					const Archetype* boosts = &gameState->boosts;
+					for (int boostIndex = 0; boostIndex < boosts->count; boostIndex++)
 					{
-						Boost* boost = &gameState->boosts[boostIndex];
-						float width = boost->sprite.coords.width / boost->sprite.numFrames * boost->size;
-						float height = boost->sprite.coords.height * boost->size;
+						const Vector2 position = Vector2Lerp(boosts->previousPosition[boostIndex], boosts->position[boostIndex], alpha);
+						const Rectangle collider = boosts->collider[boostIndex];
+						float width = collider.width;
+						float height = collider.height;
 						Rectangle boostDrawRect = {
-							.x = boost->position.x,
-							.y = boost->position.y, 
+							.x = position.x,
+							.y = position.y, 
 							.width = width,
 							.height = height, 
 						};
-						Vector2 texSize = { boost->collider.width, boost->collider.height };
-						Vector2 pivot = { boost->collider.width / 2.0f, boost->collider.height / 2.0f };
+						Vector2 pivot = { collider.width / 2.0f, collider.height / 2.0f };
 						// SetShaderValue(*shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 						// Rectangle destination = {texture_x, texture_y, width, height}; // origin in coordinates and scale
 						BeginShaderMode(*shader);
-						DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_SCRAPMETAL]], boostDrawRect, pivot, boost->rotation, WHITE, false, false);
+						DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_SCRAPMETAL]], boostDrawRect, pivot, boosts->rotation[boostIndex], WHITE, false, false, gameState->time);
 						EndShaderMode();
 						// DrawRectangleLines(boostDrawRect.x, boostDrawRect.y, boostDrawRect.width, boostDrawRect.height, RED);
-						// DrawRectangleLines(boost->collider.x, boost->collider.y, boost->collider.width, boost->collider.height, GREEN);
+						// DrawRectangleLines(collider.x, collider.y, collider.width, collider.height, GREEN);
 					}
 				}
 				// Draw Enemies
 				{
-					for (int i = 0; i < gameState->enemyCount; i++)
+					const Archetype* enemies = &gameState->enemies;
+					for (int i = 0; i < enemies->count; i++)
 					{
-						Enemy* enemy = &gameState->enemies[i];
-						Vector2 texSize = { enemy->sprite.coords.width, enemy->sprite.coords.height };
+						const Vector2 position = Vector2Lerp(enemies->previousPosition[i], enemies->position[i], alpha);
+						Rectangle enemyDrawRect = enemies->collider[i];
+						enemyDrawRect.x += position.x - enemies->position[i].x;
+						enemyDrawRect.y += position.y - enemies->position[i].y;
 						// SetShaderValue(*shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 						BeginShaderMode(*shader);
-						DrawTexturePro(atlas->textureAtlas, enemy->sprite.coords, enemy->collider, (Vector2){0,0}, 0, WHITE);
+						DrawTexturePro(atlas->textureAtlas, SpriteCoords[enemies->sprite[i]], enemyDrawRect, (Vector2){0,0}, 0, WHITE);
 						EndShaderMode();
 					}
 					// char buffer[100] = {0};
 					// sprintf(buffer, "Timer: %.2f", gameState->enemySpawnTime);
 					// DrawTextEx(options->font, buffer, (Vector2){20,50}, 30, 1, WHITE);
-					// sprintf(buffer, "Count: %d", gameState->enemyCount);
+					// sprintf(buffer, "Count: %d", gameState->enemies.count);
 					// DrawTextEx(options->font, buffer, (Vector2){20,80}, 30, 1, WHITE);
 				}
 				// Draw explosions
 				{
-					Sprite sprite = getSprite(SPRITE_EXPLOSION);
-					atlas->animations[SpriteToAnimation[SPRITE_EXPLOSION]].framesPerSecond = 14;
-					float width  = sprite.coords.width / sprite.numFrames;
-					float height = sprite.coords.height;
+					atlas->animations[SpriteToAnimation[SPRITE_EXPLOSION]].framesPerSecond = EXPLOSION_FPS;
+					const float width  = SpriteFrameSize[SPRITE_EXPLOSION].x;
+					const float height = SpriteFrameSize[SPRITE_EXPLOSION].y;
 					for (int i = 0; i < gameState->explosionCount; i++)
 					{
-						Explosion* explosion = &gameState->explosions[i];
-						if (!explosion->active) 
-						{
-							// Replace with last explosion
-							if (gameState->explosionCount > 0)
-							{
-								*explosion = gameState->explosions[--gameState->explosionCount];
-							} else {
-								gameState->explosionCount = 0;
-							}
-							continue;
-						}
+						const Explosion* explosion = &gameState->explosions[i];
 
 						Rectangle dest = {
 							explosion->position.x - width/2,
@@ -1846,40 +3243,38 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 						// Vector2 texSize = { width, height };
 						// SetShaderValue(*shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 						BeginShaderMode(*shader);
-						bool finished = DrawSpriteAnimationOnce(
+						DrawSpriteAnimationOnce(
 								atlas->textureAtlas,
 								atlas->animations[SpriteToAnimation[SPRITE_EXPLOSION]],
 								dest,
 								(Vector2){0, 0},
 								0.0f,
 								WHITE,
-								explosion->startTime
+								explosion->age
 								);
 						EndShaderMode();
-
-						if (finished)
-							explosion->active = false;
 					}
 				}
 				// Draw Player
 				{
 					atlas->animations[SpriteToAnimation[SPRITE_PLAYER]].framesPerSecond = 14;
-					const int texture_x = gameState->player.position.x - gameState->player.sprite.coords.width * gameState->player.size / gameState->player.animationFrames / 2.0;
-					const int texture_y = gameState->player.position.y - gameState->player.sprite.coords.height * gameState->player.size / 2.0;
+					const Vector2 position = Vector2Lerp(gameState->player.previousPosition, gameState->player.position, alpha);
+					const int texture_x = position.x - SpriteFrameSize[gameState->player.sprite].x * gameState->player.size / 2.0;
+					const int texture_y = position.y - SpriteCoords[gameState->player.sprite].height * gameState->player.size / 2.0;
 					Rectangle playerDestination = {texture_x, texture_y, 
-						gameState->player.sprite.coords.width / gameState->player.animationFrames * gameState->player.size, 
-						gameState->player.sprite.coords.height * gameState->player.size}; // origin in coordinates and scale
+						SpriteFrameSize[gameState->player.sprite].x * gameState->player.size, 
+						SpriteCoords[gameState->player.sprite].height * gameState->player.size}; // origin in coordinates and scale
 					Vector2 origin = {0, 0}; // so it draws from top left of image
 					Vector2 texSize = { playerDestination.width, playerDestination.height };
 					// SetShaderValue(*shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 					if (gameState->player.invulTime <= 0.0f) {
 						BeginShaderMode(*shader);
-						DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_PLAYER]], playerDestination, origin, 0, WHITE, 0, 0);
+						DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_PLAYER]], playerDestination, origin, 0, WHITE, 0, 0, gameState->time);
 						EndShaderMode();
 					} else {
 						if (((int)(gameState->player.invulTime * 10)) % 2 == 0) {
 							BeginShaderMode(*shader);
-							DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_PLAYER]], playerDestination, origin, 0, WHITE, 0, 0);
+							DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_PLAYER]], playerDestination, origin, 0, WHITE, 0, 0, gameState->time);
 							EndShaderMode();
 						}
 					}
@@ -1890,18 +3285,17 @@ void DrawScene(GameState* gameState, Options* options, TextureAtlas* atlas, Rend
 					if (gameState->player.shieldEnabled)
 					{
 						atlas->animations[SpriteToAnimation[SPRITE_SHIELD]].framesPerSecond = 14;
-						Vector2 texSize = { getSprite(SpriteToAnimation[SPRITE_SHIELD]).coords.width / getSprite(SpriteToAnimation[SPRITE_SHIELD]).numFrames,
-							getSprite(SpriteToAnimation[SPRITE_SHIELD]).coords.height };
+						Vector2 texSize = SpriteFrameSize[SPRITE_SHIELD];
 						// SetShaderValue(*shader, texSizeLoc, &texSize, SHADER_UNIFORM_VEC2);
 						BeginShaderMode(*shader);
-						DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_SHIELD]], playerDestination, origin, 0, WHITE, false, false);
+						DrawSpriteAnimationPro(&atlas->textureAtlas, &atlas->animations[SpriteToAnimation[SPRITE_SHIELD]], playerDestination, origin, 0, WHITE, false, false, gameState->time);
 						EndShaderMode();
 					}
 				}
 				for (int i = 0; i < gameState->particleEmitterCount; i++)
 				{
 					BeginShaderMode(*shader);
-					DrawEmitter(atlas, &gameState->particleEmitters[i]);
+					DrawEmitter(atlas, &gameState->particleEmitters[i], gameState->renderAlpha);
 					EndShaderMode();
 				}	
 				break;
@@ -1946,32 +3340,37 @@ void DrawLightmap(GameState* gameState, Options* options, RenderTexture2D* litSc
 	// Prepare arrays
 	Vector2 lights[128];
 	int lc = 0;
+	const float alpha = gameState->renderAlpha;
 
-	for (int i = 0; i < gameState->bulletCount; i++) {
+	for (int i = 0; i < gameState->bullets.count; i++) {
 		// convert pixel -> normalized UV (0–1)
-		lights[lc].x = gameState->bullets[i].position.x / VIRTUAL_WIDTH;
-		lights[lc].y = 1.0f - gameState->bullets[i].position.y / VIRTUAL_HEIGHT;
+		Vector2 position = Vector2Lerp(gameState->bullets.previousPosition[i], gameState->bullets.position[i], alpha);
+		lights[lc].x = position.x / VIRTUAL_WIDTH;
+		lights[lc].y = 1.0f - position.y / VIRTUAL_HEIGHT;
 		lc++;
 	}
-	if (gameState->boostCount > 0) {
-		for (int i = 0; i < gameState->boostCount; i++) {
+	if (gameState->boosts.count > 0) {
+		for (int i = 0; i < gameState->boosts.count; i++) {
 			// convert pixel -> normalized UV (0–1)
-			lights[lc].x = gameState->boosts[i].position.x / VIRTUAL_WIDTH;
-			lights[lc].y = 1.0f - gameState->boosts[i].position.y / VIRTUAL_HEIGHT;
+			Vector2 position = Vector2Lerp(gameState->boosts.previousPosition[i], gameState->boosts.position[i], alpha);
+			lights[lc].x = position.x / VIRTUAL_WIDTH;
+			lights[lc].y = 1.0f - position.y / VIRTUAL_HEIGHT;
 			lc++;
 		}
 	}
-	if (gameState->enemyCount > 0) {
-		for (int i = 0; i < gameState->enemyCount; i++) {
+	if (gameState->enemies.count > 0) {
+		for (int i = 0; i < gameState->enemies.count; i++) {
 			// convert pixel -> normalized UV (0–1)
-			lights[lc].x = gameState->enemies[i].position.x / VIRTUAL_WIDTH;
-			lights[lc].y = 1.0f - gameState->enemies[i].position.y / VIRTUAL_HEIGHT;
+			Vector2 position = Vector2Lerp(gameState->enemies.previousPosition[i], gameState->enemies.position[i], alpha);
+			lights[lc].x = position.x / VIRTUAL_WIDTH;
+			lights[lc].y = 1.0f - position.y / VIRTUAL_HEIGHT;
 			lc++;
 		}
 	}
 
-	lights[lc].x = gameState->player.position.x / VIRTUAL_WIDTH;
-	lights[lc].y = 1.0f - gameState->player.position.y / VIRTUAL_HEIGHT;
+	Vector2 playerPosition = Vector2Lerp(gameState->player.previousPosition, gameState->player.position, alpha);
+	lights[lc].x = playerPosition.x / VIRTUAL_WIDTH;
+	lights[lc].y = 1.0f - playerPosition.y / VIRTUAL_HEIGHT;
 	lc++;
 	// Upload array
 	SetShaderValue(*lightShader, uLightCount, &lc, SHADER_UNIFORM_INT);
@@ -1994,16 +3393,16 @@ void DrawHealthBar(GameState* gameState, Options* options, TextureAtlas* atlas,
 	for (int i = 1; i <= gameState->player.health; i++)
 	{
 		const int texture_x = letterBoxOffsetX + i * 16 * scale;
-		const int texture_y = letterBoxOffsetY + getSprite(SPRITE_HEART).coords.height * scale;
+		const int texture_y = letterBoxOffsetY + SpriteCoords[SPRITE_HEART].height * scale;
 
 		const Rectangle heartRect = {
 			.x = texture_x,
 			.y = texture_y,
-			.width = (float)getSprite(SPRITE_HEART).coords.width * scale,
-			.height = (float)getSprite(SPRITE_HEART).coords.height * scale,
+			.width = (float)SpriteCoords[SPRITE_HEART].width * scale,
+			.height = (float)SpriteCoords[SPRITE_HEART].height * scale,
 		};
 		DrawTexturePro(atlas->textureAtlas, 
-				getSprite(SPRITE_HEART).coords, 
+				SpriteCoords[SPRITE_HEART], 
 				heartRect, 
 				(Vector2){0,0}, 
 				0, 
@@ -2020,9 +3419,10 @@ void DrawShieldText(GameState* gameState, Options* options, TextureAtlas* atlas,
 	float letterBoxOffsetY = (GetRenderHeight() - viewport.height) / 2.0f;
 
 	// const int texture_x = (letterboxWidth + gameState->player.position.x) * scale;
-	// const int texture_y = (letterboxHeight + gameState->player.position.y - gameState->player.sprite.coords.height * gameState->player.size / 2.0) * scale;
-	const int texture_x = letterBoxOffsetX + gameState->player.position.x * scale;
-	const int texture_y = letterBoxOffsetY + (gameState->player.position.y - gameState->player.sprite.coords.height * gameState->player.size / 2.0) * scale;
+	// const int texture_y = (letterboxHeight + gameState->player.position.y - SpriteCoords[gameState->player.sprite].height * gameState->player.size / 2.0) * scale;
+	const Vector2 playerPosition = Vector2Lerp(gameState->player.previousPosition, gameState->player.position, gameState->renderAlpha);
+	const int texture_x = letterBoxOffsetX + playerPosition.x * scale;
+	const int texture_y = letterBoxOffsetY + (playerPosition.y - SpriteCoords[gameState->player.sprite].height * gameState->player.size / 2.0) * scale;
 	char shieldText[100] = {0};
 	const float textSize = 18.0f*scale;
 	sprintf(shieldText, "%.2f", gameState->player.shieldTime);
@@ -2106,8 +3506,8 @@ void DrawUpgrades(GameState* gameState, Options* options, TextureAtlas* atlas, S
 	DrawTextWave(options->font, T(TXT_LEVEL_UP), (Vector2){letterBoxOffsetX + viewport.width/2.0f, letterBoxOffsetY + viewport.height/2.0f - 110.0f*scale}, 40*scale, WHITE, true, gameState->time, 3.0f, 3.0f, 0.5f, true);
 	DrawTextWave(options->font, T(TXT_CHOOSE_UPGRADE), (Vector2){letterBoxOffsetX + viewport.width/2.0f, letterBoxOffsetY + viewport.height/2.0f - 65.0f*scale}, 40*scale, WHITE, true, gameState->time, 3.0f, 3.0f, 0.5f, true);
 	float scaling = 3.0f;
-	const float width  = getSprite(SPRITE_UPGRADEMULTISHOT).coords.width;
-	const float height = getSprite(SPRITE_UPGRADEMULTISHOT).coords.height;
+	const float width  = SpriteCoords[SPRITE_UPGRADEMULTISHOT].width;
+	const float height = SpriteCoords[SPRITE_UPGRADEMULTISHOT].height;
 	const float pos_x  = letterBoxOffsetX + viewport.width/2 - width/2;
 	const float pos_y  = letterBoxOffsetY + viewport.height/2 - height/2 + 130*scale;
 	const int spacing_x = 240 * scale;
@@ -2146,11 +3546,11 @@ void DrawUpgrades(GameState* gameState, Options* options, TextureAtlas* atlas, S
 		if (gameState->pickedUpgrade == i) {
 			pulseScaling = 0.10f * sinf(gameState->time * 2.2f);
 			rotation = rotScal * cosf(gameState->time / timeScal);
-			*anim += gameState->dt * animSpeed;
+			*anim += gameState->frameTime * animSpeed;
 		} else {
 			pulseScaling = 0.0f;
 			rotation = 0.0f;
-			*anim -= gameState->dt * animSpeed;
+			*anim -= gameState->frameTime * animSpeed;
 		}
 		scaling = 3.0f + pulseScaling;
 		*anim = Clamp(*anim, 0.0f, 1.0f);
@@ -2189,7 +3589,7 @@ void DrawUpgrades(GameState* gameState, Options* options, TextureAtlas* atlas, S
 					255.0f 
 			};
 			DrawTextureWithOutlinePro(atlas->textureAtlas,
-					getSprite(upgradeToSprite[i]).coords,
+					SpriteCoords[upgradeToSprite[i]],
 					upgradeRect, 
 					pivot, 
 					rotation, 
@@ -2202,7 +3602,7 @@ void DrawUpgrades(GameState* gameState, Options* options, TextureAtlas* atlas, S
 		else 
 		{
 			BeginShaderMode(*shader);
-			DrawTexturePro(atlas->textureAtlas, getSprite(upgradeToSprite[i]).coords, 
+			DrawTexturePro(atlas->textureAtlas, SpriteCoords[upgradeToSprite[i]], 
 					upgradeRect, pivot, rotation, WHITE);
 			EndShaderMode();
 		}
@@ -2222,7 +3622,7 @@ void DrawUpgrades(GameState* gameState, Options* options, TextureAtlas* atlas, S
 	// EndShaderMode();
 }
 
-void DrawPauseMenu(GameState* gameState, Options* options, TextureAtlas* atlas)
+void DrawPauseMenu(GameState* gameState, Options* options, TextureAtlas* atlas, Profiler* profiler)
 {
 	const Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
 	float scale = viewport.width / VIRTUAL_WIDTH;
@@ -2291,6 +3691,11 @@ void DrawPauseMenu(GameState* gameState, Options* options, TextureAtlas* atlas)
 			3 * boxHeight / 12,
 			checkboxWidth, checkboxHeight},
 			T(TXT_SHOW_DEBUG_INFO), &options->showDebugInfo);
+	GuiCheckBox((Rectangle){boxPosX - sliderWidth / 2 + boxWidth / 6,
+			boxPosY - sliderHeight / 2 - boxHeight / 6 +
+			3 * boxHeight / 12,
+			checkboxWidth, checkboxHeight},
+			T(TXT_SHOW_PROFILER), &options->showProfiler);
 
 	if (GuiButton(
 				(Rectangle){boxPosX - boxWidth / 3 - buttonWidth / 2 + checkboxWidth,
@@ -2340,6 +3745,7 @@ void DrawPauseMenu(GameState* gameState, Options* options, TextureAtlas* atlas)
 				LocSetLanguage(LANG_ZH);
 				break;
 		}
+		double fontStart = PROFILER_CLOCK();
 		UnloadFont(options->font);
 		// options->font = LoadLanguageFont("./assets/fonts/UnifontExMono.ttf",
 		// options->maxFontSize, options->language);
@@ -2355,6 +3761,7 @@ void DrawPauseMenu(GameState* gameState, Options* options, TextureAtlas* atlas)
 		}
 		GuiSetFont(options->font);
 		options->lastLanguage = options->language;
+		ProfileEvent(profiler, TRACE_ASSET, "language font", fontStart);
 	}
 }
 
@@ -2366,6 +3773,70 @@ void DrawFPSInViewport(Rectangle viewport) {
 	DrawFPS(offsetX + 25 * scale, offsetY + 65 * scale);
 }
 
+// Per-phase frame times, averaged over the profiler history
+void DrawProfiler(const Profiler *profiler, const Options *options) {
+	Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
+	float scale = viewport.width / VIRTUAL_WIDTH;
+	float offsetX = (GetRenderWidth() - viewport.width) / 2.0f;
+	float offsetY = (GetRenderHeight() - viewport.height) / 2.0f;
+
+	const int textSize = GuiGetStyle(DEFAULT, TEXT_SIZE);
+	const int textSpacing = GuiGetStyle(DEFAULT, TEXT_SPACING);
+	GuiSetStyle(DEFAULT, TEXT_SIZE, 16 * scale);
+	GuiSetStyle(DEFAULT, TEXT_SPACING, GetDefaultSpacing(16 * scale));
+
+	const float rowHeight = 16.0f * scale;
+	const float nameWidth = 170.0f * scale;
+	const float valueWidth = 70.0f * scale;
+	const float barWidth = 90.0f * scale;
+	const float padding = 6.0f * scale;
+	const float headerHeight = RAYGUI_WINDOWBOX_STATUSBAR_HEIGHT;
+	Rectangle panel = {
+		.x = offsetX + 25 * scale,
+		.y = offsetY + 90 * scale,
+		.width = nameWidth + 2 * valueWidth + barWidth + 2 * padding,
+		.height = headerHeight + (PROFILE_COUNT + 4) * rowHeight + 2 * padding,
+	};
+	GuiPanel(panel, TextFormat("Profiler (%d frames)", profiler->frameCount));
+
+	// Bars are relative to the frame budget of a 60 Hz display
+	const float budget = 1.0f / 60.0f;
+	float x = panel.x + padding;
+	float y = panel.y + headerHeight + padding;
+	GuiLabel((Rectangle){x, y, nameWidth, rowHeight}, "phase");
+	GuiLabel((Rectangle){x + nameWidth, y, valueWidth, rowHeight}, "avg ms");
+	GuiLabel((Rectangle){x + nameWidth + valueWidth, y, valueWidth, rowHeight}, "max ms");
+	for (int phase = 0; phase < PROFILE_COUNT; phase++) {
+		float average, maximum;
+		ProfileStats(profiler, phase, &average, &maximum);
+		y += rowHeight;
+		GuiLabel((Rectangle){x, y, nameWidth, rowHeight},
+				TextFormat("%s%s", ProfileIsTotal(phase) ? "" : "  ", ProfilePhaseName((ProfilePhase)phase)));
+		GuiLabel((Rectangle){x + nameWidth, y, valueWidth, rowHeight}, TextFormat("%6.3f", average * 1000.0f));
+		GuiLabel((Rectangle){x + nameWidth + valueWidth, y, valueWidth, rowHeight}, TextFormat("%6.3f", maximum * 1000.0f));
+		float value = Clamp(average, 0.0f, budget);
+		GuiProgressBar((Rectangle){x + nameWidth + 2 * valueWidth, y + rowHeight / 4, barWidth, rowHeight / 2},
+				NULL, NULL, &value, 0.0f, budget);
+	}
+	// Context for the numbers above: simulation load and the last frame
+	const ProfileFrame *last = &profiler->frames[(profiler->current + PROFILE_HISTORY - 1) % PROFILE_HISTORY];
+	y += rowHeight;
+	GuiLabel((Rectangle){x, y, panel.width - 2 * padding, rowHeight},
+			TextFormat("ticks/frame %d  bullets %d  tick rate %d Hz", last->ticks, last->bulletCount, options->tickRate));
+	y += rowHeight;
+	GuiLabel((Rectangle){x, y, panel.width - 2 * padding, rowHeight},
+			TextFormat("%.0f ticks/s  turbo %s", profiler->ticksPerSecond,
+				options->turboTicks == 0 ? "off" : options->turboTicks == TURBO_UNLIMITED ? "unlimited" : TextFormat("x%d", options->turboTicks)));
+	y += rowHeight;
+	GuiLabel((Rectangle){x, y, panel.width - 2 * padding, rowHeight},
+			TextFormat("pairs %ld -> %ld -> %ld  midphase -%ld  pixel tests %ld", last->counters[PROFILE_PAIRS_BRUTE],
+				last->counters[PROFILE_PAIRS_CANDIDATE], last->counters[PROFILE_PAIRS_OVERLAP],
+				last->counters[PROFILE_MIDPHASE_REJECTS], last->counters[PROFILE_PIXEL_TESTS]));
+
+	GuiSetStyle(DEFAULT, TEXT_SIZE, textSize);
+	GuiSetStyle(DEFAULT, TEXT_SPACING, textSpacing);
+}
+
 void DrawEnemyHealthBar(GameState *gameState, Options *options,
 		TextureAtlas *atlas, Shader *shader) {
 	Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
@@ -2374,14 +3845,16 @@ void DrawEnemyHealthBar(GameState *gameState, Options *options,
 	float letterBoxOffsetY = (GetRenderHeight() - viewport.height) / 2.0f;
 	float recHeight = 10.0f;
 	float recWidth = 50.0f;
-	for (int i = 0; i < gameState->enemyCount; i++) {
-		Enemy *enemy = &gameState->enemies[i];
+	const Archetype *enemies = &gameState->enemies;
+	for (int i = 0; i < enemies->count; i++) {
+		Vector2 position = Vector2Lerp(enemies->previousPosition[i], enemies->position[i],
+				gameState->renderAlpha);
 		float recPosX =
-			letterBoxOffsetX + (enemy->position.x - recWidth / 2.0f) * scale;
+			letterBoxOffsetX + (position.x - recWidth / 2.0f) * scale;
 		float recPosY =
 			letterBoxOffsetY +
-			(enemy->position.y + enemy->sprite.coords.height - recHeight) * scale;
-		DrawRectangle(recPosX, recPosY, recWidth / 20.0f * enemy->health * scale,
+			(position.y + SpriteCoords[enemies->sprite[i]].height - recHeight) * scale;
+		DrawRectangle(recPosX, recPosY, recWidth / 20.0f * enemies->health[i] * scale,
 				recHeight * scale, RED);
 		DrawRectangleLines(recPosX, recPosY, recWidth * scale, recHeight * scale,
 				WHITE);
@@ -2389,7 +3862,7 @@ void DrawEnemyHealthBar(GameState *gameState, Options *options,
 }
 
 void DrawUI(GameState *gameState, Options *options, TextureAtlas *atlas,
-		Shader *shader, Shader *outlineShader) {
+		Shader *shader, Shader *outlineShader, Profiler *profiler) {
 	Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
 	switch (gameState->state) {
 		case STATE_RUNNING: 
@@ -2475,7 +3948,7 @@ void DrawUI(GameState *gameState, Options *options, TextureAtlas *atlas,
 				if (gameState->lastState == STATE_UPGRADE) {
 					DrawUpgrades(gameState, options, atlas, shader, outlineShader);
 				}
-				DrawPauseMenu(gameState, options, atlas);
+				DrawPauseMenu(gameState, options, atlas, profiler);
 				break;
 			}
 	}
@@ -2483,6 +3956,9 @@ void DrawUI(GameState *gameState, Options *options, TextureAtlas *atlas,
 	if (options->showDebugInfo) {
 		DrawFPSInViewport(viewport);
 	}
+	if (options->showProfiler) {
+		DrawProfiler(profiler, options);
+	}
 }
 
 void DrawComposite(RenderTexture2D *scene, Options *options,
@@ -2504,17 +3980,17 @@ void DrawCursor(GameState *gameState, Options *options, TextureAtlas *atlas,
 	HideCursor();
 	Vector2 mousePosition = GetMousePosition();
 	Rectangle sourceRect = {
-		.x = getSprite(SPRITE_CURSOR).coords.x,
-		.y = getSprite(SPRITE_CURSOR).coords.y,
-		.width = getSprite(SPRITE_CURSOR).coords.width,
-		.height = getSprite(SPRITE_CURSOR).coords.height,
+		.x = SpriteCoords[SPRITE_CURSOR].x,
+		.y = SpriteCoords[SPRITE_CURSOR].y,
+		.width = SpriteCoords[SPRITE_CURSOR].width,
+		.height = SpriteCoords[SPRITE_CURSOR].height,
 	};
 	float cursorScale = 1.0f;
 	Rectangle destRect = {
 		.x = mousePosition.x,
 		.y = mousePosition.y,
-		.width = (float)getSprite(SPRITE_CURSOR).coords.width * cursorScale,
-		.height = (float)getSprite(SPRITE_CURSOR).coords.height * cursorScale,
+		.width = (float)SpriteCoords[SPRITE_CURSOR].width * cursorScale,
+		.height = (float)SpriteCoords[SPRITE_CURSOR].height * cursorScale,
 	};
 	DrawTexturePro(atlas->textureAtlas, sourceRect, destRect, (Vector2){0, 0}, 0,
 			WHITE);
@@ -2530,30 +4006,120 @@ void DrawGame(GameMemory *gameMemory) {
 	Shader *lightShader = gameMemory->lightShader;
 	Shader *explosionShader = gameMemory->explosionShader;
 	Shader *outlineShader = gameMemory->outlineShader;
+	Profiler *profiler = gameMemory->profiler;
 
+	ProfileBegin(profiler, PROFILE_DRAW);
+	ProfileBegin(profiler, PROFILE_LIGHTMAP);
 	DrawLightmap(gameState, options, litScene, lightShader);
+	ProfileEnd(profiler, PROFILE_LIGHTMAP);
+	ProfileBegin(profiler, PROFILE_SCENE);
 	DrawScene(gameState, options, atlas, scene, shader, explosionShader,
 			outlineShader);
+	ProfileEnd(profiler, PROFILE_SCENE);
 
 	BeginDrawing();
 	{
 		ClearBackground(BLACK);
+		ProfileBegin(profiler, PROFILE_COMPOSITE);
 		DrawComposite(scene, options, litScene, gameState, lightShader);
-		DrawUI(gameState, options, atlas, shader, outlineShader);
+		ProfileEnd(profiler, PROFILE_COMPOSITE);
+		ProfileBegin(profiler, PROFILE_UI);
+		DrawUI(gameState, options, atlas, shader, outlineShader, profiler);
 		DrawCursor(gameState, options, atlas, shader, outlineShader);
+		ProfileEnd(profiler, PROFILE_UI);
+	}
+	EndDrawing();
+	ProfileEnd(profiler, PROFILE_DRAW);
+}
+
+// Stand-in frame for unlimited turbo, the scene is not drawn at all
+void DrawTurboStatus(GameMemory *gameMemory) {
+	GameState *gameState = gameMemory->gameState;
+	Options *options = gameMemory->options;
+	Rectangle viewport = GetScaledViewport(GetRenderWidth(), GetRenderHeight());
+	float scale = viewport.width / VIRTUAL_WIDTH;
+	float offsetX = (GetRenderWidth() - viewport.width) / 2.0f;
+	float offsetY = (GetRenderHeight() - viewport.height) / 2.0f;
+	float fontSize = 24 * scale;
+
+	BeginDrawing();
+	{
+		ClearBackground(BLACK);
+		const char *lines[] = {
+			"TURBO (unlimited), press N to leave",
+			TextFormat("%.0f ticks/s (%.0fx real time)", gameMemory->profiler->ticksPerSecond,
+					gameMemory->profiler->ticksPerSecond / Clamp(options->tickRate, MIN_TICK_RATE, MAX_TICK_RATE)),
+			TextFormat("tick %ld  level %d  score %d", gameState->tick, gameState->player.level, gameState->score),
+			TextFormat("bullets %d  asteroids %d  enemies %d", gameState->bullets.count, gameState->asteroids.count, gameState->enemies.count),
+		};
+		for (int i = 0; i < (int)(sizeof(lines) / sizeof(lines[0])); i++) {
+			DrawTextEx(options->font, lines[i], (Vector2){offsetX + 25 * scale, offsetY + (65 + i * 30) * scale},
+					fontSize, GetDefaultSpacing(fontSize), WHITE);
+		}
 	}
 	EndDrawing();
 }
 
 void UpdateDrawFrame(GameMemory *gameMemory) {
-	gameMemory->gameState->dt = GetFrameTime() * gameMemory->gameState->timeScale;
-	gameMemory->gameState->time += gameMemory->gameState->dt;
+	GameState *gameState = gameMemory->gameState;
+	const int tickRate = Clamp(gameMemory->options->tickRate, MIN_TICK_RATE, MAX_TICK_RATE);
+	const float tickDt = 1.0f / tickRate;
+
+	ProfileFrameBegin(gameMemory->profiler);
+	gameState->frameTime = GetFrameTime();
 	HandleResize(gameMemory->options);
-	UpdateGame(gameMemory);
+	HandleDebugKeys(gameMemory);
+	PollGameInput(gameState);
+
+	const int turboTicks = gameMemory->options->turboTicks;
+	if (turboTicks == TURBO_UNLIMITED) {
+		// Simulate until the frame budget is spent, then only present a status line
+		const double deadline = PROFILER_CLOCK() + TURBO_FRAME_BUDGET;
+		do {
+			if (StepModeHolds(gameState)) break;
+			SimulateTick(gameMemory, tickDt);
+		} while (PROFILER_CLOCK() < deadline && !gameState->shouldExit);
+		gameState->tickAccumulator = 0.0f;
+		gameState->renderAlpha = 1.0f;
+		DrawTurboStatus(gameMemory);
+		ProfileFrameEnd(gameMemory->profiler, gameState->bullets.count);
+		return;
+	} else if (turboTicks > 0) {
+		// A fixed number of ordinary ticks per frame, independent of the frame time
+		for (int i = 0; i < turboTicks; i++) {
+			if (StepModeHolds(gameState)) break;
+			SimulateTick(gameMemory, tickDt);
+		}
+		gameState->tickAccumulator = 0.0f;
+		gameState->renderAlpha = 1.0f;
+	} else {
+		// Run as many fixed ticks as the scaled frame time allows. After a long
+		// stall (breakpoint, window drag) drop the backlog instead of spiralling.
+		gameState->tickAccumulator += gameState->frameTime * gameState->timeScale;
+		int ticks = 0;
+		while (gameState->tickAccumulator >= tickDt && ticks < MAX_TICKS_PER_FRAME) {
+			if (StepModeHolds(gameState)) {
+				// Held ticks are not owed, rendering stays on the last one
+				gameState->tickAccumulator = tickDt;
+				break;
+			}
+			SimulateTick(gameMemory, tickDt);
+			gameState->tickAccumulator -= tickDt;
+			ticks++;
+		}
+		if (ticks == MAX_TICKS_PER_FRAME) {
+			gameState->tickAccumulator = fminf(gameState->tickAccumulator, tickDt);
+		}
+		gameState->renderAlpha = Clamp(gameState->tickAccumulator / tickDt, 0.0f, 1.0f);
+	}
+
 	DrawGame(gameMemory);
 #ifndef PLATFORM_WEB
 	if (gameMemory->gameState->gifRecorder.recording) {
+		double gifStart = PROFILER_CLOCK();
 		GifRecordUpdate(&gameMemory->gameState->gifRecorder);
+		ProfileEvent(gameMemory->profiler, TRACE_GIF, "gif frame", gifStart);
 	}
 #endif
+	ProfileFrameEnd(gameMemory->profiler, gameState->bullets.count);
 }
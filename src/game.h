@@ -12,6 +12,17 @@
 #include "audio.h"
 #include "assetsUtils.h"
 #include "localization.h"
+#include "rng.h"
+#include "replay.h"
+#include "profiler.h"
+#include "checksum.h"
+#include "arena.h"
+#include "pool.h"
+#include "archetype.h"
+#include "bulletKernel.h"
+#include "spatialHash.h"
+#include "collisionEvents.h"
+#include "jobs.h"
 
 #include "raymath.h"
 #include "raylib.h"
@@ -40,14 +51,28 @@
 // #define VIRTUAL_WIDTH (940.0f)
 // #define VIRTUAL_HEIGHT (540.0f)
 #define WINDOW_TITLE ("Asteroids")
-#define MAX_BULLETS (1000)
-#define MAX_ASTEROIDS (100)
-#define MAX_EXPLOSIONS (20)
+// Default entity capacities, config.ini overrides them (see PoolConfig)
+#define DEFAULT_BULLET_CAPACITY (1000)
+#define DEFAULT_ASTEROID_CAPACITY (100)
+#define DEFAULT_EXPLOSION_CAPACITY (20)
+#define DEFAULT_ENEMY_CAPACITY (3)
+#define DEFAULT_BOOST_CAPACITY (1)
+#define DEFAULT_EMITTER_CAPACITY (10)
 #define MAX_STARS (50)
-#define MAX_BOOSTS (1)
-#define MAX_ENEMIES (3)
 #define MAX_PARTICLES (200)
-#define MAX_PARTICLE_EMITTERS (10)
+// Arena the platform layer allocates for the entity storage, the default
+// capacities take about half a megabyte of it
+#define GAME_ARENA_SIZE (64 * 1024 * 1024)
+// Fixed timestep simulation
+#define DEFAULT_TICK_RATE (60)
+#define MIN_TICK_RATE (10)
+#define MAX_TICK_RATE (1000)
+#define MAX_TICKS_PER_FRAME (8)
+// Turbo runs ordinary fixed ticks, just more of them per presented frame.
+// Unlimited turbo skips drawing and simulates for TURBO_FRAME_BUDGET seconds
+// between status frames so the window stays responsive.
+#define TURBO_UNLIMITED (-1)
+#define TURBO_FRAME_BUDGET (0.05)
 
 #ifdef PLATFORM_WEB
 	#define TARGET_FPS (60)
@@ -64,7 +89,9 @@
 	#define GLSL_VERSION 330
 #endif
 
+#ifndef ASSERT
 #define ASSERT(x) if (!(x)) { printf("Assertion failed on line %d: %s\n", __LINE__, #x); exit(1); }
+#endif
 
 typedef enum State
 {
@@ -83,13 +110,78 @@ typedef enum Upgrade
     UPGRADE_COUNT,
 } Upgrade;
 
-typedef struct Particle {
-	Vector2 position;
-	Vector2 velocity;
-	Vector2 acceleration;
-	float angularVelocity;
-	float rotation;
-	Sprite sprite;
+// Input is sampled once per rendered frame and consumed once per simulation tick
+typedef enum InputButton
+{
+	INPUT_UP,
+	INPUT_DOWN,
+	INPUT_LEFT,
+	INPUT_RIGHT,
+	INPUT_SHOOT,
+	INPUT_PAUSE,
+	INPUT_CONFIRM,
+	INPUT_SELECT_LEFT,
+	INPUT_SELECT_RIGHT,
+	INPUT_CLICK,
+	INPUT_COUNT,
+} InputButton;
+
+// Entity storage carved from the arena at startup, one pool per kind
+typedef enum PoolKind
+{
+	POOL_BULLETS,
+	POOL_ASTEROIDS,
+	POOL_EXPLOSIONS,
+	POOL_ENEMIES,
+	POOL_BOOSTS,
+	POOL_EMITTERS,
+	POOL_KIND_COUNT,
+} PoolKind;
+
+// Growth policy of a pool: it starts at capacity and doubles, up to limit,
+// whenever a spawn finds it full. A limit equal to the capacity never grows.
+// The spawn rules of enemies, asteroids and boosts stop at the capacity, so
+// only bullets, explosions and emitters ever grow. Set in config.ini as
+// "<name>Capacity <capacity> [limit]", for example "bulletCapacity 1000 4000".
+typedef struct PoolConfig {
+	int capacity;
+	int limit;
+} PoolConfig;
+
+static inline const char* PoolName(PoolKind kind)
+{
+	static const char* names[POOL_KIND_COUNT] = {
+		[POOL_BULLETS]    = "bullet",
+		[POOL_ASTEROIDS]  = "asteroid",
+		[POOL_EXPLOSIONS] = "explosion",
+		[POOL_ENEMIES]    = "enemy",
+		[POOL_BOOSTS]     = "boost",
+		[POOL_EMITTERS]   = "emitter",
+	};
+	return names[kind];
+}
+
+static const PoolConfig defaultPoolConfigs[POOL_KIND_COUNT] = {
+	[POOL_BULLETS]    = {DEFAULT_BULLET_CAPACITY, DEFAULT_BULLET_CAPACITY},
+	[POOL_ASTEROIDS]  = {DEFAULT_ASTEROID_CAPACITY, DEFAULT_ASTEROID_CAPACITY},
+	[POOL_EXPLOSIONS] = {DEFAULT_EXPLOSION_CAPACITY, DEFAULT_EXPLOSION_CAPACITY},
+	[POOL_ENEMIES]    = {DEFAULT_ENEMY_CAPACITY, DEFAULT_ENEMY_CAPACITY},
+	[POOL_BOOSTS]     = {DEFAULT_BOOST_CAPACITY, DEFAULT_BOOST_CAPACITY},
+	[POOL_EMITTERS]   = {DEFAULT_EMITTER_CAPACITY, DEFAULT_EMITTER_CAPACITY},
+};
+
+typedef struct GameInput {
+	unsigned int down;    // bit per InputButton, held this tick
+	unsigned int pressed; // bit per InputButton, went down since the last tick
+	Vector2 mousePosition; // virtual coordinates
+	int hoveredUpgrade;    // upgrade card under the mouse, -1 if none
+} GameInput;
+
+// What the particles of an emitter have in common: the sprite and the
+// ranges every new particle is drawn from. Kept once per emitter instead of
+// in every particle.
+typedef struct ParticleTemplate {
+	SpriteID sprite;
 	Vector4 positionRange;
 	Vector4 velocityRange;
 	Vector4 accelerationRange;
@@ -98,13 +190,23 @@ typedef struct Particle {
 	Vector2 sizeRange;
 	Color startColor;
 	Color endColor;
+	float lifetime;
+} ParticleTemplate;
+
+typedef struct Particle {
+	Vector2 position;
+	Vector2 previousPosition;
+	Vector2 velocity;
+	Vector2 acceleration;
+	float angularVelocity;
+	float rotation;
 	float age;
 	float lifetime;
 } Particle;
 
 typedef struct ParticleEmitter {
 	Particle particles[MAX_PARTICLES];
-	Particle templateParticle;
+	ParticleTemplate particleTemplate;
 	Vector2 position;
 	int particleCount;
 	int maxParticleCount;
@@ -123,60 +225,43 @@ typedef struct UpgradeCard {
 
 typedef struct Star {
     Vector2 position;
+    Vector2 previousPosition;
     float size;
     float velocity;
     int imgIndex;
     float alpha;
-    Sprite sprite;
+    SpriteID sprite;
 } Star;
 
+// Per-kind data of the archetype entities, the shared components
+// (position, velocity, collider, ...) live in the Archetype columns
 typedef struct Asteroid {
-    Vector2 position;
-    float health;
-    float size;
-    Vector2 velocity;
-    float angularVelocity;
-    float rotation;
-    Sprite sprite;
-	Rectangle collider;
 	bool dying;
 	float deathTime;
 	bool selected;
 } Asteroid;
 
-typedef struct Boost {
-	Vector2 position;
-	Vector2 velocity;
-	float size;
-	float rotation;
-	float angularVelocity;
-	Sprite sprite;
-	Rectangle collider;
-} Boost;
-
 typedef struct Bullet {
-    Vector2 position;
-    Vector2 velocity;
     float damage;
-    Sprite sprite;
-    float rotation;
-	float size;
-	Rectangle collider;
-	void* owner;
+	EntityHandle owner; // enemy that fired it, ENTITY_NONE for the player's bullets
 } Bullet;
 
+// Explosions age with the simulation and are removed once their animation
+// played through, SpriteNumFrames[SPRITE_EXPLOSION] frames at EXPLOSION_FPS
+#define EXPLOSION_FPS (14)
+
 typedef struct Explosion {
     Vector2 position;
 	Vector2 velocity;
-    float startTime;
-    bool active;
+	float age;
 } Explosion;
 
 typedef struct Player {
     float velocity;
     Vector2 position;
+    Vector2 previousPosition;
     int health;
-    Sprite sprite;
+    SpriteID sprite;
     int size;
     int animationFrames;
     float invulTime;
@@ -192,18 +277,12 @@ typedef struct Player {
 } Player;
 
 typedef struct Enemy {
-    Vector2 velocity;
-    Vector2 position;
 	float phase;
-    float health;
-    Sprite sprite;
-    int size;
-    int animationFrames;
+	float phaseRate; // radians per second of the sideways sweep
     float fireRate;
     float shootTime;
     float damageMulti;
 	int bulletCount;
-	Rectangle collider;
 } Enemy;
 
 typedef struct Options {
@@ -228,6 +307,10 @@ typedef struct Options {
 	bool musicVolumeChanged;
 	bool fxVolumeChanged;
 	bool showDebugInfo;
+	bool showProfiler;
+	int turboTicks; // ticks per frame in turbo mode, 0 when off or TURBO_UNLIMITED
+	int tickRate;
+	PoolConfig pools[POOL_KIND_COUNT];
 } Options;
 
 
@@ -240,25 +323,34 @@ typedef struct GameState {
 	float timeScale;
     // Player
     Player player;
-	Enemy enemies[MAX_ENEMIES];
-	int enemyCount;
+	Archetype enemies;
+	Enemy* enemyData;
 	float enemySpawnRate;
 	float enemySpawnTime;
 	// Projectiles
-    Bullet bullets[MAX_BULLETS];
-    int bulletCount;
-	Explosion explosions[MAX_EXPLOSIONS];
+	Archetype bullets;
+	Bullet* bulletData;
+	float bulletMaxSpeed; // fastest bullet spawned so far, widens the swept broadphase queries
+	Explosion* explosions;
 	int explosionCount;
+	EntityPool explosionPool;
     // asteroids
-    Asteroid asteroids[MAX_ASTEROIDS];
-    int asteroidCount;
+	Archetype asteroids;
+	Asteroid* asteroidData;
 	float spawnTime;
 	float asteroidSpawnRate;
 	// Boosts
-	Boost boosts[MAX_BOOSTS];
-	int boostCount;
+	Archetype boosts;
 	float boostSpawnTime;
 	float boostSpawnRate;
+	// Collision broadphase, rebuilt from the colliders before every pass that uses it
+	SpatialHash bulletHash;
+	SpatialHash asteroidHash;
+	SpatialHash boostHash;
+	// Hits of the collision pass running, applied by ResolveCollisions
+	CollisionEvents collisions;
+	// Queues of the detection jobs, merged into collisions after every pass
+	CollisionEvents collisionChunks[COLLISION_JOB_CHUNKS];
     // Parallax background stars
     Star stars[MAX_STARS];
     int starCount;
@@ -269,13 +361,28 @@ typedef struct GameState {
 	int maxPlayerBullets;
 	float dt;
 	float time;
+	// Fixed timestep
+	GameInput input;
+	float tickAccumulator;
+	float renderAlpha; // fraction of a tick between the previous and current simulation state
+	float frameTime;   // unscaled real time of the last rendered frame
+	long tick;
 	UpgradeCard upgradeCards[UPGRADE_COUNT];
     bool shouldExit;
     Rectangle currentCollision;
 	bool stateChanged;
 	GifRecorder gifRecorder;
-	ParticleEmitter particleEmitters[MAX_PARTICLE_EMITTERS];
+	ParticleEmitter* particleEmitters;
 	int particleEmitterCount;
+	int particleEmitterCapacity;
+	// Entity storage, carved from the arena by InitializeGameState at the
+	// capacities in pools. Both survive the reset, the arena is the platform's.
+	MemoryArena* arena;
+	PoolConfig pools[POOL_KIND_COUNT];
+	long poolExhausted[POOL_KIND_COUNT]; // spawns dropped because the pool was full and could not grow
+	// Random streams, all derived from seed
+	uint64_t seed;
+	Rng rng[RNG_STREAM_COUNT];
 } GameState;
 
 typedef struct GameMemory
@@ -291,6 +398,11 @@ typedef struct GameMemory
     Shader* lightShader;
     Shader* explosionShader;
 	Shader* outlineShader;
+	Replay* replay;
+	Profiler* profiler;
+	JobSystem* jobs;   // NULL runs the update's job graphs on the game thread
+	MemoryArena* arena; // entity storage, GAME_ARENA_SIZE allocated by the platform
+	FILE* checksumLog; // per-tick GameState checksums are written here when set
 } GameMemory;
 
 
@@ -0,0 +1,253 @@
+// Headless simulation driver.
+// Links the game code directly (no hot reloading) against platformHeadless.h
+// instead of raylib, so it runs without a window, GPU or audio device.
+// Input comes from a small scripted pilot, time from a simulated clock.
+// Every loop iteration is one fixed simulation tick at --tick-rate.
+// --record saves the pilot's input as a replay, --replay feeds a recorded
+// session (see replay.h) back instead of the pilot. --trace captures the whole
+// run, asset loading included, as a Chrome trace (see trace.h). --checksum
+// writes the GameState checksum of every tick ("-" for stdout), diff two of
+// them to find the first tick where runs diverge. --jobs starts worker
+// threads for the update's job graphs, the checksums do not change with it.
+//
+// Usage: asteroids_headless [--ticks N] [--tick-rate HZ] [--seed S] [--record FILE] [--replay FILE] [--trace FILE]
+//                           [--checksum FILE] [--jobs N] [--idle] [--draw] [--verbose]
+#define RAYMATH_STATIC_INLINE
+#include "platformHeadless.h"
+#include "game.c"
+#include "platformJobs.h"
+
+typedef struct HeadlessOptions {
+	long ticks;
+	float tickRate;
+	uint64_t seed;
+	const char* recordPath;
+	const char* replayPath;
+	const char* tracePath;
+	const char* checksumPath;
+	int jobs;
+	bool idle;
+	bool draw;
+} HeadlessOptions;
+
+// Scripted pilot: starts the game, keeps shooting while sweeping left and
+// right, always takes the selected upgrade and restarts after game over.
+static void HeadlessPilot(GameState* gameState, long tick, int tickRate)
+{
+	HeadlessReleaseAll();
+	bool confirm = (tick % 2) == 0; // needs a release in between to count as a new press
+	switch (gameState->state)
+	{
+		case STATE_MAIN_MENU:
+		case STATE_UPGRADE:
+		case STATE_GAME_OVER:
+			HeadlessSetKey(KEY_ENTER, confirm);
+			break;
+		case STATE_RUNNING:
+			HeadlessSetKey(KEY_SPACE, true);
+			HeadlessSetKey(((tick / (2 * tickRate)) % 2) ? KEY_A : KEY_D, true);
+			HeadlessSetKey(((tick / (3 * tickRate)) % 2) ? KEY_W : KEY_S, true);
+			break;
+		case STATE_PAUSED:
+			HeadlessSetKey(KEY_P, confirm);
+			break;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	HeadlessOptions headlessOptions = {
+		.ticks = -1,
+		.tickRate = 60.0f,
+		.seed = 1,
+		.idle = false,
+		.draw = false,
+	};
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) headlessOptions.ticks = atol(argv[++i]);
+		else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) headlessOptions.tickRate = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) headlessOptions.seed = strtoull(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) headlessOptions.recordPath = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) headlessOptions.replayPath = argv[++i];
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) headlessOptions.tracePath = argv[++i];
+		else if (strcmp(argv[i], "--checksum") == 0 && i + 1 < argc) headlessOptions.checksumPath = argv[++i];
+		else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) headlessOptions.jobs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--idle") == 0) headlessOptions.idle = true;
+		else if (strcmp(argv[i], "--draw") == 0) headlessOptions.draw = true;
+		else if (strcmp(argv[i], "--verbose") == 0) headless.logLevel = LOG_INFO;
+		else
+		{
+			printf("Usage: %s [--ticks N] [--tick-rate HZ] [--seed S] [--record FILE] [--replay FILE] [--trace FILE] [--checksum FILE] [--jobs N] [--idle] [--draw] [--verbose]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (headlessOptions.tickRate <= 0.0f) headlessOptions.tickRate = 60.0f;
+
+	GameState gameState = {0};
+	Options options = {0};
+	Audio audio = {0};
+	TextureAtlas atlas = {0};
+	SpriteMask spriteMasks[SPRITE_COUNT] = {0};
+	RenderTexture2D scene = {0};
+	RenderTexture2D litScene = {0};
+	Shader shader = {0};
+	Shader explosionShader = {0};
+	Shader lightShader = {0};
+	Shader outlineShader = {0};
+	Replay replay = {0};
+	Profiler profiler = {0};
+
+	GameMemory gameMemory = {0};
+	gameMemory.gameState = &gameState;
+	gameMemory.options = &options;
+	gameMemory.audio = &audio;
+	gameMemory.atlas = &atlas;
+	gameMemory.spriteMasks = spriteMasks;
+	gameMemory.scene = &scene;
+	gameMemory.litScene = &litScene;
+	gameMemory.shader = &shader;
+	gameMemory.explosionShader = &explosionShader;
+	gameMemory.lightShader = &lightShader;
+	gameMemory.outlineShader = &outlineShader;
+	gameMemory.replay = &replay;
+	gameMemory.profiler = &profiler;
+	// Entity storage, carved by the game at the capacities in config.ini
+	void* arenaMemory = calloc(1, GAME_ARENA_SIZE);
+	MemoryArena arena;
+	ArenaInit(&arena, arenaMemory, GAME_ARENA_SIZE);
+	gameMemory.arena = &arena;
+	JobSystem jobs;
+	JobSystemStart(&jobs, headlessOptions.jobs);
+	gameMemory.jobs = &jobs;
+
+	if (headlessOptions.tracePath) TraceStart(&profiler.trace, PROFILER_CLOCK());
+	InitGame(&gameMemory);
+	if (!spriteMasks[SPRITE_PLAYER].bits || atlas.textureAtlas.width == 0)
+	{
+		printf("Failed to load the texture atlas, run from the repository root\n");
+		return 1;
+	}
+
+	if (headlessOptions.replayPath)
+	{
+		if (!StartReplayPlayback(&gameMemory, headlessOptions.replayPath)) return 1;
+		headlessOptions.seed = replay.seed;
+		headlessOptions.tickRate = (float)replay.tickRate;
+		headlessOptions.idle = true;
+		if (headlessOptions.ticks < 0) headlessOptions.ticks = replay.tickCount;
+	}
+	else
+	{
+		// Fixed seed instead of the wall clock so runs are reproducible
+		InitializeGameState(&gameState, headlessOptions.seed);
+		options.tickRate = (int)headlessOptions.tickRate;
+		if (headlessOptions.recordPath) RecordReplayFrom(&replay, &gameState, options.tickRate);
+	}
+	if (headlessOptions.ticks < 0) headlessOptions.ticks = 36000;
+	if (headlessOptions.checksumPath)
+	{
+		bool toStdout = strcmp(headlessOptions.checksumPath, "-") == 0;
+		gameMemory.checksumLog = toStdout ? stdout : fopen(headlessOptions.checksumPath, "w");
+		if (gameMemory.checksumLog == NULL)
+		{
+			printf("Error: could not open checksum log %s\n", headlessOptions.checksumPath);
+			return 1;
+		}
+	}
+	const float dt = 1.0f / headlessOptions.tickRate;
+	long deaths = 0;
+	int maxBullets = 0;
+	int maxAsteroids = 0;
+	double updateTime = 0.0;
+	double touchedBytes = 0.0;
+	size_t maxTouchedBytes = 0;
+	double start = HeadlessWallTime();
+	for (long tick = 0; tick < headlessOptions.ticks; tick++)
+	{
+		HeadlessBeginFrame(dt);
+		if (!headlessOptions.idle)
+		{
+			HeadlessPilot(&gameState, tick, (int)headlessOptions.tickRate);
+		}
+		State previousState = gameState.state;
+
+		double updateStart = HeadlessWallTime();
+		if (headlessOptions.draw)
+		{
+			UpdateDrawFrame(&gameMemory);
+		}
+		else
+		{
+			ProfileFrameBegin(&profiler);
+			PollGameInput(&gameState);
+			SimulateTick(&gameMemory, dt);
+			ProfileFrameEnd(&profiler, gameState.bullets.count);
+		}
+		updateTime += HeadlessWallTime() - updateStart;
+
+		if (gameState.state == STATE_GAME_OVER && previousState != STATE_GAME_OVER) deaths++;
+		maxBullets = MAX(maxBullets, gameState.bullets.count);
+		maxAsteroids = MAX(maxAsteroids, gameState.asteroids.count);
+		const size_t touched = EntityBytesTouched(&gameState);
+		touchedBytes += touched;
+		maxTouchedBytes = MAX(maxTouchedBytes, touched);
+	}
+	double wall = HeadlessWallTime() - start;
+
+	printf("ticks:          %ld (%.1f s simulated at %.0f Hz)\n", headlessOptions.ticks, headlessOptions.ticks * dt, headlessOptions.tickRate);
+	printf("seed:           %llu\n", (unsigned long long)headlessOptions.seed);
+	printf("wall time:      %.3f s\n", wall);
+	printf("update:         %.0f ns/tick\n", headlessOptions.ticks > 0 ? updateTime * 1e9 / headlessOptions.ticks : 0.0);
+	printf("ticks/s:        %.0f\n", wall > 0.0 ? headlessOptions.ticks / wall : 0.0);
+	printf("score:          %d (level %d, %ld deaths)\n", gameState.score, gameState.player.level, deaths);
+	printf("max bullets:    %d\n", maxBullets);
+	printf("max asteroids:  %d\n", maxAsteroids);
+	printf("arena:          %zu KB used, %zu KB at most, of %zu KB\n", arena.used / 1024, arena.peak / 1024, arena.size / 1024);
+	for (int kind = 0; kind < POOL_KIND_COUNT; kind++)
+	{
+		if (gameState.poolExhausted[kind] == 0) continue;
+		printf("pool full:      %ld %s spawns dropped in the last game (capacity %d, limit %d)\n", gameState.poolExhausted[kind],
+				PoolName((PoolKind)kind), gameState.pools[kind].capacity, gameState.pools[kind].limit);
+	}
+	if (gameState.collisions.dropped > 0)
+	{
+		printf("queue full:     %ld collision hits dropped in the last game (queue of %d)\n", gameState.collisions.dropped, gameState.collisions.capacity);
+	}
+	printf("state size:     GameState %zu, Player %zu, Star %zu, Particle %zu, ParticleEmitter %zu bytes\n",
+			sizeof(GameState), sizeof(Player), sizeof(Star), sizeof(Particle), sizeof(ParticleEmitter));
+	printf("touched:        %.0f bytes/tick of entity state on average, %zu at most\n",
+			headlessOptions.ticks > 0 ? touchedBytes / headlessOptions.ticks : 0.0, maxTouchedBytes);
+	printf("sounds played:  %llu\n", headless.soundsPlayed);
+	printf("draw calls:     %llu\n", headless.drawCalls);
+	if (jobs.workerCount > 0)
+	{
+		long executed = 0;
+		long stolen = 0;
+		for (int worker = 0; worker <= jobs.workerCount; worker++)
+		{
+			executed += jobs.stats[worker].executed;
+			stolen += jobs.stats[worker].stolen;
+		}
+		printf("jobs:           %ld on %d workers, %ld stolen\n", executed, jobs.workerCount + 1, stolen);
+	}
+	printf("checksum:       %016llx\n", (unsigned long long)GameStateChecksum(&gameState));
+
+	if (headlessOptions.recordPath && replay.mode == REPLAY_RECORDING)
+	{
+		StopReplayRecording(&gameMemory, headlessOptions.recordPath);
+		printf("recorded:       %u ticks to %s\n", replay.tickCount, headlessOptions.recordPath);
+	}
+	if (headlessOptions.tracePath && TraceStop(&profiler.trace, headlessOptions.tracePath))
+	{
+		printf("traced:         %u events to %s\n", profiler.trace.eventCount, headlessOptions.tracePath);
+	}
+	if (gameMemory.checksumLog && gameMemory.checksumLog != stdout) fclose(gameMemory.checksumLog);
+	gameMemory.checksumLog = NULL;
+	ReplayFree(&replay);
+	TraceFree(&profiler.trace);
+	Cleanup(&gameMemory);
+	JobSystemStop(&jobs);
+	free(arenaMemory);
+	return 0;
+}
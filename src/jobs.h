@@ -0,0 +1,239 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Job system for the independent phases of a tick. The update builds a
+// JobGraph, each job a function with its data and the jobs it has to wait
+// for, and JobGraphRun returns once every job has run. Jobs of one graph only
+// touch disjoint parts of GameState, so the order they happen to run in does
+// not change the result and the join is deterministic.
+//
+// Every worker owns a Chase-Lev deque: it pushes and pops jobs at the bottom,
+// idle workers steal from the top of the others. A finished job pushes the
+// dependents it released onto its own worker's deque. The thread calling
+// JobGraphRun is worker 0 and works on the graph until it is done.
+//
+// The worker threads belong to the platform layer (platformJobs.h), so a hot
+// reload never unloads code a thread is running; game code only ever sits on
+// the stack of a worker while a graph runs. Without workers (no JobSystem,
+// or the web build) a graph runs on the calling thread in the order the jobs
+// were added.
+#define JOB_MAX_WORKERS (16)
+#define JOB_DEQUE_CAPACITY (256) // power of two
+#define JOB_GRAPH_MAX_JOBS (64)
+#define JOB_MAX_DEPENDENTS (8)
+// Failed searches for a job before a waiting thread gives up its core
+#define JOB_SPIN (64)
+
+// Same as game.h, the platform layer includes this header without it
+#ifndef ASSERT
+#define ASSERT(x) if (!(x)) { printf("Assertion failed on line %d: %s\n", __LINE__, #x); exit(1); }
+#endif
+
+typedef void (*JobFunc)(void* data);
+
+typedef struct JobGraph JobGraph;
+
+typedef struct Job {
+	JobFunc func;
+	JobGraph* graph;
+	void* data;
+	int tag;     // for the caller, game.c keeps the profiler phase here
+	int waiting; // dependencies that have not finished yet
+	int dependentCount;
+	uint8_t dependents[JOB_MAX_DEPENDENTS];
+	double start; // when the job ran, on PROFILER_CLOCK
+	double end;
+} Job;
+
+struct JobGraph {
+	Job jobs[JOB_GRAPH_MAX_JOBS];
+	int count;
+	int remaining; // jobs that have not finished yet
+};
+
+typedef struct JobDeque {
+	long top __attribute__((aligned(64))); // stolen from here
+	long bottom __attribute__((aligned(64))); // owner pushes and pops here
+	Job* items[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+typedef struct JobWorkerStats {
+	long executed;
+	long stolen;
+} __attribute__((aligned(64))) JobWorkerStats;
+
+typedef struct JobSystem JobSystem;
+struct JobSystem {
+	int workerCount; // threads besides the one running the game
+	bool quit;
+	long generation; // bumped whenever jobs were published
+	int sleeping;    // workers waiting for the next generation
+	void (*wake)(JobSystem* system);  // wakes the sleeping workers
+	void (*yield)(JobSystem* system); // lets other threads run while waiting for a job
+	void* platform;
+	JobDeque deques[JOB_MAX_WORKERS + 1];
+	JobWorkerStats stats[JOB_MAX_WORKERS + 1];
+};
+
+// Graph building
+
+static inline void JobGraphReset(JobGraph* graph)
+{
+	graph->count = 0;
+	graph->remaining = 0;
+}
+
+// Returns the index of the job for JobDepends. A graph that does not fit
+// would run jobs out of order, so overflowing JOB_GRAPH_MAX_JOBS or
+// JOB_MAX_DEPENDENTS stops the game.
+static inline int JobAdd(JobGraph* graph, JobFunc func, void* data, int tag)
+{
+	ASSERT(graph->count < JOB_GRAPH_MAX_JOBS);
+	const int index = graph->count++;
+	graph->jobs[index] = (Job){ .func = func, .graph = graph, .data = data, .tag = tag };
+	return index;
+}
+
+// Job waits for dependency, which has to be added before it
+static inline void JobDepends(JobGraph* graph, int job, int dependency)
+{
+	ASSERT(dependency >= 0 && dependency < job && job < graph->count);
+	Job* before = &graph->jobs[dependency];
+	ASSERT(before->dependentCount < JOB_MAX_DEPENDENTS);
+	before->dependents[before->dependentCount++] = (uint8_t)job;
+	graph->jobs[job].waiting++;
+}
+
+// Deque, Chase and Lev with the C11 orderings of Le et al.
+
+static inline bool JobDequePush(JobDeque* deque, Job* job)
+{
+	const long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+	const long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+	if (bottom - top >= JOB_DEQUE_CAPACITY) return false;
+	__atomic_store_n(&deque->items[bottom & (JOB_DEQUE_CAPACITY - 1)], job, __ATOMIC_RELAXED);
+	// Publishes the job, and the graph it points into, to the thieves
+	__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+static inline Job* JobDequePop(JobDeque* deque)
+{
+	const long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+	__atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	long top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+	if (top > bottom)
+	{
+		__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	Job* job = __atomic_load_n(&deque->items[bottom & (JOB_DEQUE_CAPACITY - 1)], __ATOMIC_RELAXED);
+	if (top == bottom)
+	{
+		// Last job, race the thieves for it
+		if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) job = NULL;
+		__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+	}
+	return job;
+}
+
+static inline Job* JobDequeSteal(JobDeque* deque)
+{
+	long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	const long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+	if (top >= bottom) return NULL;
+	Job* job = __atomic_load_n(&deque->items[top & (JOB_DEQUE_CAPACITY - 1)], __ATOMIC_RELAXED);
+	if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) return NULL;
+	return job;
+}
+
+// Execution
+
+static inline void JobPause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+// Own deque first, then the others starting after the worker's own
+static inline Job* JobFind(JobSystem* system, int worker)
+{
+	Job* job = JobDequePop(&system->deques[worker]);
+	if (job) return job;
+	for (int i = 1; i <= system->workerCount; i++)
+	{
+		const int victim = (worker + i) % (system->workerCount + 1);
+		job = JobDequeSteal(&system->deques[victim]);
+		if (job)
+		{
+			system->stats[worker].stolen++;
+			return job;
+		}
+	}
+	return NULL;
+}
+
+static inline void JobExecute(JobSystem* system, int worker, Job* job)
+{
+	JobGraph* graph = job->graph;
+	job->start = PROFILER_CLOCK();
+	job->func(job->data);
+	job->end = PROFILER_CLOCK();
+	system->stats[worker].executed++;
+	for (int d = 0; d < job->dependentCount; d++)
+	{
+		Job* dependent = &graph->jobs[job->dependents[d]];
+		if (__atomic_sub_fetch(&dependent->waiting, 1, __ATOMIC_ACQ_REL) == 0)
+		{
+			if (!JobDequePush(&system->deques[worker], dependent)) JobExecute(system, worker, dependent);
+		}
+	}
+	__atomic_sub_fetch(&graph->remaining, 1, __ATOMIC_RELEASE);
+}
+
+// Runs every job of the graph and returns once all of them have finished
+static inline void JobGraphRun(JobSystem* system, JobGraph* graph)
+{
+	if (system == NULL || system->workerCount == 0)
+	{
+		// Dependencies always come first, so the order they were added in works
+		double now = PROFILER_CLOCK();
+		for (int i = 0; i < graph->count; i++)
+		{
+			Job* job = &graph->jobs[i];
+			job->start = now;
+			job->func(job->data);
+			job->end = now = PROFILER_CLOCK();
+		}
+		return;
+	}
+	__atomic_store_n(&graph->remaining, graph->count, __ATOMIC_RELAXED);
+	// Back to front, so worker 0 pops them in the order they were added while thieves start at the end
+	for (int i = graph->count - 1; i >= 0; i--)
+	{
+		Job* job = &graph->jobs[i];
+		if (job->waiting == 0 && !JobDequePush(&system->deques[0], job)) JobExecute(system, 0, job);
+	}
+	__atomic_add_fetch(&system->generation, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&system->sleeping, __ATOMIC_SEQ_CST) > 0) system->wake(system);
+	int idle = 0;
+	while (__atomic_load_n(&graph->remaining, __ATOMIC_ACQUIRE) > 0)
+	{
+		Job* job = JobFind(system, 0);
+		if (job)
+		{
+			JobExecute(system, 0, job);
+			idle = 0;
+		}
+		else if (++idle < JOB_SPIN) JobPause();
+		else system->yield(system);
+	}
+}
@@ -27,6 +27,9 @@ time_t GetLastWriteTime(const char* path)
 #else
 #include "platformUnix.h"
 #endif
+#if !defined(PLATFORM_WEB) && !__EMSCRIPTEN__
+#include "platformJobs.h"
+#endif
 
 int main()
 {
@@ -34,13 +37,15 @@ int main()
 	Options options = {0};
 	Audio audio = {0};
 	TextureAtlas atlas = {0};
-	SpriteMask spriteMasks[] = {0};
+	SpriteMask spriteMasks[SPRITE_COUNT] = {0};
 	RenderTexture2D scene = {0};
 	RenderTexture2D litScene = {0};
 	Shader shader = {0};
 	Shader explosionShader = {0};
 	Shader lightShader = {0};
 	Shader outlineShader = {0};
+	Replay replay = {0};
+	Profiler profiler = {0};
 
 	GameMemory gameMemory = {0}; 
 	gameMemory.gameState = &gameState;
@@ -54,6 +59,13 @@ int main()
 	gameMemory.explosionShader = &explosionShader;
 	gameMemory.lightShader = &lightShader;
 	gameMemory.outlineShader = &outlineShader;
+	gameMemory.replay = &replay;
+	gameMemory.profiler = &profiler;
+	// Entity storage, carved by the game at the capacities in config.ini
+	void* arenaMemory = calloc(1, GAME_ARENA_SIZE);
+	MemoryArena arena;
+	ArenaInit(&arena, arenaMemory, GAME_ARENA_SIZE);
+	gameMemory.arena = &arena;
 
 	// InitAudioDevice();
 #if defined(PLATFORM_WEB)
@@ -74,6 +86,11 @@ int main()
 
 	emscripten_set_main_loop(WebWrapper, TARGET_FPS, 1);
 #else
+	JobSystem jobs;
+	JobSystemStart(&jobs, JobDefaultWorkerCount());
+	printf("Job system: %d worker threads\n", jobs.workerCount);
+	gameMemory.jobs = &jobs;
+
 	GameCode game = LoadGameCode();
 	if (game.Init) game.Init(&gameMemory);
 	// printf("WindowShouldClose: %d\n", WindowShouldClose());
@@ -90,11 +107,13 @@ int main()
 		{
 
 			printf("Hot reloading game...\n");
+			double reloadStart = PROFILER_CLOCK();
 
 			shader = LoadShader(0, TextFormat("./src/shaders/default.glsl", GLSL_VERSION));
 			lightShader = LoadShader(0, TextFormat("./src/shaders/light.glsl", GLSL_VERSION));
 			outlineShader = LoadShader(0, TextFormat("./src/shaders/outline.glsl", GLSL_VERSION));
 			explosionShader = LoadShader(0, TextFormat("./src/shaders/explode.glsl", GLSL_VERSION));
+			ProfileEvent(&profiler, TRACE_ASSET, "shaders", reloadStart);
 
 			// CloseAudioDevice();
 			UnloadGameCode(&game);
@@ -103,14 +122,18 @@ int main()
 			{
 				game = newGame; 
 			}
+			ProfileEvent(&profiler, TRACE_RELOAD, "hot reload", reloadStart);
 			// printf("Reload done!\n");
 		}
 		if (game.Update) game.Update(&gameMemory);
 	}
+	JobSystemStop(&jobs);
 #endif
 	if (game.Cleanup) game.Cleanup(&gameMemory);
 	printf("Unloading game...\n");
 	UnloadGameCode(&game);
+	TraceFree(&profiler.trace);
+	free(arenaMemory);
 #ifndef PLATFORM_WINDOWS
 	CloseWindow();
 #endif
@@ -0,0 +1,409 @@
+// Microbenchmarks for the hot kernels, isolated from the rest of the frame.
+// Built like the headless driver, so fonts use platformHeadless.h metrics and
+// the sprite masks are the real ones decoded from the atlas.
+// Every kernel runs a warmup, then a fixed number of timed samples. Each
+// sample is a fixed batch of calls, calibrated once so a sample takes about
+// 50 us. The report gives median and p99 ns per call and items per second.
+//
+// Usage: asteroids_microbench [--samples N] [--warmup N] [--filter TEXT] [--cpu N] [--csv FILE]
+#define _GNU_SOURCE
+#define RAYMATH_STATIC_INLINE
+#include "platformHeadless.h"
+#include "game.c"
+
+#include <sched.h>
+
+#define MICRO_SAMPLE_TARGET_NS (50000.0)
+#define MICRO_MAX_SAMPLES (100000)
+#define MICRO_TEXT_CAPACITY (8192)
+
+typedef void (*MicroKernelFn)(void* context);
+
+typedef struct MicroKernel {
+	const char* name;
+	const char* unit; // what one item is
+	MicroKernelFn run;
+	void* context;
+	double itemsPerCall;
+	bool (*available)(void* context); // NULL if the kernel always runs
+} MicroKernel;
+
+typedef struct MicroResult {
+	const MicroKernel* kernel;
+	long batch;
+	int samples;
+	double medianNs;
+	double p99Ns;
+	double itemsPerSecond;
+} MicroResult;
+
+// Keeps results alive so the compiler cannot drop the calls
+static volatile int microSink;
+
+static int MicroCompareDouble(const void* a, const void* b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+static MicroResult MicroRun(const MicroKernel* kernel, int warmup, int samples)
+{
+	MicroResult result = { .kernel = kernel, .samples = samples, .batch = 1 };
+
+	// Calibrate the batch size, this doubles as warmup
+	for (;;)
+	{
+		double start = HeadlessWallTime();
+		for (long i = 0; i < result.batch; i++) kernel->run(kernel->context);
+		double ns = (HeadlessWallTime() - start) * 1e9;
+		if (ns >= MICRO_SAMPLE_TARGET_NS || result.batch >= (1l << 24)) break;
+		result.batch *= 2;
+	}
+	for (int w = 0; w < warmup; w++)
+	{
+		for (long i = 0; i < result.batch; i++) kernel->run(kernel->context);
+	}
+
+	double* perCall = (double*)malloc(samples * sizeof(double));
+	for (int s = 0; s < samples; s++)
+	{
+		double start = HeadlessWallTime();
+		for (long i = 0; i < result.batch; i++) kernel->run(kernel->context);
+		perCall[s] = (HeadlessWallTime() - start) * 1e9 / result.batch;
+	}
+	qsort(perCall, samples, sizeof(double), MicroCompareDouble);
+	result.medianNs = perCall[samples / 2];
+	result.p99Ns = perCall[MIN(samples - 1, (int)(samples * 0.99))];
+	result.itemsPerSecond = result.medianNs > 0.0 ? kernel->itemsPerCall * 1e9 / result.medianNs : 0.0;
+	free(perCall);
+	return result;
+}
+
+// pixelPerfectCollision
+typedef struct MicroCollision {
+	const SpriteMask* bullet;
+	const SpriteMask* asteroid;
+	Rectangle bulletRect;
+	Rectangle asteroidRect;
+	Rectangle overlap;
+	float bulletRotation;
+	float asteroidRotation;
+} MicroCollision;
+
+// Places a bullet over the asteroid, relative position (0,0) is the
+// top-left corner of the asteroid and (1,1) the bottom-right one
+static MicroCollision MicroCollisionSetup(SpriteMask* masks, Vector2 at, float bulletRotation, float asteroidRotation)
+{
+	MicroCollision c = {
+		.bullet = &masks[SPRITE_BULLET],
+		.asteroid = &masks[SPRITE_ASTEROID1],
+		.bulletRotation = bulletRotation,
+		.asteroidRotation = asteroidRotation,
+	};
+	const float asteroidSize = 2.0f;
+	const float bulletSize = 0.75f;
+	c.asteroidRect = (Rectangle){ 600.0f, 300.0f, c.asteroid->width * asteroidSize, c.asteroid->height * asteroidSize };
+	float width = c.bullet->width * bulletSize;
+	float height = c.bullet->height * bulletSize;
+	c.bulletRect = (Rectangle){
+		c.asteroidRect.x + at.x * c.asteroidRect.width - width / 2.0f,
+		c.asteroidRect.y + at.y * c.asteroidRect.height - height / 2.0f,
+		width, height,
+	};
+	c.overlap = GetCollisionRec(c.asteroidRect, c.bulletRect);
+	return c;
+}
+
+// The same pair with its rotated masks swapped for the pre-rotated ones
+static MicroCollision MicroCollisionPreRotated(MicroCollision c)
+{
+	UsePreRotatedMask(&c.bullet, &c.bulletRect, &c.bulletRotation);
+	UsePreRotatedMask(&c.asteroid, &c.asteroidRect, &c.asteroidRotation);
+	return c;
+}
+
+static void MicroCollisionRun(void* context)
+{
+	MicroCollision* c = (MicroCollision*)context;
+	microSink += pixelPerfectCollision(c->bullet, c->asteroid,
+			c->bulletRect, c->asteroidRect, c->overlap, c->bulletRotation, c->asteroidRotation);
+}
+
+// masksMayCollide, the midphase in front of pixelPerfectCollision
+static void MicroMidphaseRun(void* context)
+{
+	MicroCollision* c = (MicroCollision*)context;
+	microSink += masksMayCollide(c->bullet, c->asteroid, c->bulletRect, c->asteroidRect, c->bulletRotation, c->asteroidRotation);
+}
+
+// UpdateEmitter
+typedef struct MicroEmitter {
+	ParticleEmitter emitter;
+	Rng rng;
+} MicroEmitter;
+
+static void MicroEmitterSetup(MicroEmitter* m)
+{
+	*m = (MicroEmitter){0};
+	RngSeed(&m->rng, 1, RNG_PARTICLES);
+	ParticleEmitter* e = &m->emitter;
+	e->maxParticleCount = MAX_PARTICLES;
+	e->spawnRate = 1.0f;
+	e->lifetime = 0.0f; // no spawning, the particle count stays at MAX_PARTICLES
+	for (int i = 0; i < MAX_PARTICLES; i++)
+	{
+		Vector2 position = {(float)RngInt(&m->rng, 0, VIRTUAL_WIDTH), (float)RngInt(&m->rng, 0, VIRTUAL_HEIGHT)};
+		e->particles[e->particleCount++] = (Particle){
+			.position = position,
+			.previousPosition = position,
+			.velocity = {(float)RngInt(&m->rng, -100, 100), (float)RngInt(&m->rng, -100, 100)},
+			.angularVelocity = (float)RngInt(&m->rng, -200, 200),
+			.lifetime = 1e30f,
+		};
+	}
+}
+
+static void MicroEmitterRun(void* context)
+{
+	MicroEmitter* m = (MicroEmitter*)context;
+	UpdateEmitter(&m->emitter, 1.0f / DEFAULT_TICK_RATE, &m->rng);
+	microSink += m->emitter.particleCount;
+}
+
+// Bullet integrate-and-cull kernel, one variant per context
+typedef struct MicroBullets {
+	BulletKernelKind kind;
+	Vector2 position[DEFAULT_BULLET_CAPACITY];
+	Vector2 velocity[DEFAULT_BULLET_CAPACITY];
+	float size[DEFAULT_BULLET_CAPACITY];
+	Rectangle collider[DEFAULT_BULLET_CAPACITY];
+	uint64_t alive[BULLET_MASK_WORDS(DEFAULT_BULLET_CAPACITY)];
+} MicroBullets;
+
+static void MicroBulletsSetup(MicroBullets* m, BulletKernelKind kind)
+{
+	Rng rng;
+	RngSeed(&rng, 1, RNG_GAMEPLAY);
+	m->kind = kind;
+	for (int i = 0; i < DEFAULT_BULLET_CAPACITY; i++)
+	{
+		m->position[i] = (Vector2){(float)RngInt(&rng, 0, VIRTUAL_WIDTH), (float)RngInt(&rng, 0, VIRTUAL_HEIGHT)};
+		// Bullets fly out on one side and come back on the other, so the alive mask stays mixed
+		m->velocity[i] = (Vector2){(float)RngInt(&rng, -100, 100), (float)RngInt(&rng, -500, 500)};
+		m->size[i] = 0.75f * (0.5f + RngFloat(&rng));
+	}
+}
+
+static void MicroBulletsRun(void* context)
+{
+	MicroBullets* m = (MicroBullets*)context;
+	const Rectangle bounds = {0, 0, VIRTUAL_WIDTH, VIRTUAL_HEIGHT};
+	microSink += BulletKernelGet(m->kind)(m->position, m->velocity, m->size, m->collider, m->alive,
+			DEFAULT_BULLET_CAPACITY, 1.0f / DEFAULT_TICK_RATE, (Vector2){16.0f, 24.0f}, bounds);
+	if (m->position[0].y < -VIRTUAL_HEIGHT || m->position[0].y > 2 * VIRTUAL_HEIGHT)
+	{
+		for (int i = 0; i < DEFAULT_BULLET_CAPACITY; i++) m->velocity[i] = Vector2Negate(m->velocity[i]);
+	}
+}
+
+static bool MicroBulletsAvailable(void* context)
+{
+	return BulletKernelSupported(((MicroBullets*)context)->kind);
+}
+
+// Text
+typedef struct MicroText {
+	Font font;
+	const char* text;
+	float fontSize;
+	float maxWidth;
+	char out[MICRO_TEXT_CAPACITY];
+} MicroText;
+
+static void MicroTWrapRun(void* context)
+{
+	MicroText* t = (MicroText*)context;
+	microSink += TWrap(t->out, sizeof(t->out), t->font, t->text, t->maxWidth, t->fontSize, GetDefaultSpacing(t->fontSize));
+}
+
+static void MicroTFWrapRun(void* context)
+{
+	MicroText* t = (MicroText*)context;
+	microSink += TFWrap(t->out, sizeof(t->out), t->font, t->maxWidth, t->fontSize, GetDefaultSpacing(t->fontSize), TXT_SCORE, 1234567)[0];
+}
+
+static void MicroTextWaveRun(void* context)
+{
+	MicroText* t = (MicroText*)context;
+	microSink += (int)MeasureTextWaveWidth(t->font, t->text, t->fontSize, GetDefaultSpacing(t->fontSize));
+}
+
+// All Chinese strings joined by spaces, repeated up to the given byte length
+static void MicroBuildCjkText(char* out, int capacity)
+{
+	int length = 0;
+	out[0] = 0;
+	while (length < capacity - 64)
+	{
+		for (int id = 1; id < TXT_COUNT && length < capacity - 64; id++)
+		{
+			length += snprintf(out + length, capacity - length, "%s ", gText[LANG_ZH][id]);
+		}
+	}
+}
+
+static void MicroWriteCsv(const char* path, const MicroResult* results, int count)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		printf("Error: could not open %s\n", path);
+		return;
+	}
+	fprintf(file, "kernel,unit,items_per_call,batch,samples,median_ns,p99_ns,items_per_second\n");
+	for (int i = 0; i < count; i++)
+	{
+		const MicroResult* r = &results[i];
+		fprintf(file, "%s,%s,%.0f,%ld,%d,%.1f,%.1f,%.0f\n", r->kernel->name, r->kernel->unit, r->kernel->itemsPerCall,
+				r->batch, r->samples, r->medianNs, r->p99Ns, r->itemsPerSecond);
+	}
+	fclose(file);
+}
+
+int main(int argc, char** argv)
+{
+	int samples = 200;
+	int warmup = 20;
+	int cpu = -1;
+	const char* filter = NULL;
+	const char* csvPath = NULL;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) samples = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmup = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+		else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) cpu = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csvPath = argv[++i];
+		else
+		{
+			printf("Usage: %s [--samples N] [--warmup N] [--filter TEXT] [--cpu N] [--csv FILE]\n", argv[0]);
+			return 1;
+		}
+	}
+	samples = Clamp(samples, 1, MICRO_MAX_SAMPLES);
+	if (cpu >= 0)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		if (sched_setaffinity(0, sizeof(set), &set) != 0) printf("Warning: could not pin to cpu %d\n", cpu);
+	}
+
+	GameState gameState = {0};
+	Options options = {0};
+	Audio audio = {0};
+	TextureAtlas atlas = {0};
+	SpriteMask spriteMasks[SPRITE_COUNT] = {0};
+	RenderTexture2D scene = {0};
+	RenderTexture2D litScene = {0};
+	Shader shader = {0};
+	Shader explosionShader = {0};
+	Shader lightShader = {0};
+	Shader outlineShader = {0};
+	Replay replay = {0};
+	Profiler profiler = {0};
+
+	GameMemory gameMemory = {0};
+	gameMemory.gameState = &gameState;
+	gameMemory.options = &options;
+	gameMemory.audio = &audio;
+	gameMemory.atlas = &atlas;
+	gameMemory.spriteMasks = spriteMasks;
+	gameMemory.scene = &scene;
+	gameMemory.litScene = &litScene;
+	gameMemory.shader = &shader;
+	gameMemory.explosionShader = &explosionShader;
+	gameMemory.lightShader = &lightShader;
+	gameMemory.outlineShader = &outlineShader;
+	gameMemory.replay = &replay;
+	gameMemory.profiler = &profiler;
+	// Entity storage, carved by the game at the capacities in config.ini
+	void* arenaMemory = calloc(1, GAME_ARENA_SIZE);
+	MemoryArena arena;
+	ArenaInit(&arena, arenaMemory, GAME_ARENA_SIZE);
+	gameMemory.arena = &arena;
+
+	InitGame(&gameMemory);
+	if (!spriteMasks[SPRITE_PLAYER].bits || atlas.textureAtlas.width == 0)
+	{
+		printf("Failed to load the texture atlas, run from the repository root\n");
+		return 1;
+	}
+
+	// A hit returns at the first opaque pixel pair, a miss scans the whole overlap
+	MicroCollision collisionHit = MicroCollisionSetup(spriteMasks, (Vector2){0.5f, 0.5f}, 0.0f, 0.0f);
+	MicroCollision collisionMiss = MicroCollisionSetup(spriteMasks, (Vector2){0.02f, 0.02f}, 0.0f, 0.0f);
+	MicroCollision collisionHitRotated = MicroCollisionSetup(spriteMasks, (Vector2){0.5f, 0.5f}, 15.0f, 37.0f);
+	MicroCollision collisionMissRotated = MicroCollisionSetup(spriteMasks, (Vector2){0.02f, 0.02f}, 15.0f, 37.0f);
+	MicroCollision collisionHitPreRotated = MicroCollisionPreRotated(collisionHitRotated);
+	MicroCollision collisionMissPreRotated = MicroCollisionPreRotated(collisionMissRotated);
+
+	static MicroEmitter emitter;
+	MicroEmitterSetup(&emitter);
+
+	static MicroBullets bullets[BULLET_KERNEL_COUNT];
+	for (int kind = 0; kind < BULLET_KERNEL_COUNT; kind++) MicroBulletsSetup(&bullets[kind], (BulletKernelKind)kind);
+
+	static char cjkText[4096];
+	MicroBuildCjkText(cjkText, sizeof(cjkText));
+	LocSetLanguage(LANG_ZH);
+	static MicroText text;
+	text.font = options.font;
+	text.text = cjkText;
+	text.fontSize = 24.0f;
+	text.maxWidth = 600.0f;
+	double cjkCodepoints = (double)GetCodepointCount(cjkText);
+
+	static MicroText waveText;
+	waveText = text;
+	waveText.text = gText[LANG_ZH][TXT_CHOOSE_UPGRADE];
+	waveText.fontSize = 40.0f;
+
+	const MicroKernel kernels[] = {
+		{"collision_hit",             "call",      MicroCollisionRun, &collisionHit,         1.0},
+		{"collision_miss",            "call",      MicroCollisionRun, &collisionMiss,        1.0},
+		{"collision_hit_rotated",     "call",      MicroCollisionRun, &collisionHitRotated,  1.0},
+		{"collision_miss_rotated",    "call",      MicroCollisionRun, &collisionMissRotated, 1.0},
+		{"collision_hit_prerotated",  "call",      MicroCollisionRun, &collisionHitPreRotated,  1.0},
+		{"collision_miss_prerotated", "call",      MicroCollisionRun, &collisionMissPreRotated, 1.0},
+		{"midphase_hit_rotated",      "call",      MicroMidphaseRun,  &collisionHitRotated,  1.0},
+		{"midphase_miss_rotated",     "call",      MicroMidphaseRun,  &collisionMissRotated, 1.0},
+		{"update_emitter_200",        "particle",  MicroEmitterRun,   &emitter,              (double)MAX_PARTICLES},
+		{"bullets_scalar_1000",       "bullet",    MicroBulletsRun,   &bullets[BULLET_KERNEL_SCALAR], (double)DEFAULT_BULLET_CAPACITY},
+		{"bullets_sse2_1000",         "bullet",    MicroBulletsRun,   &bullets[BULLET_KERNEL_SSE2],   (double)DEFAULT_BULLET_CAPACITY, MicroBulletsAvailable},
+		{"bullets_avx_1000",          "bullet",    MicroBulletsRun,   &bullets[BULLET_KERNEL_AVX],    (double)DEFAULT_BULLET_CAPACITY, MicroBulletsAvailable},
+		{"twrap_cjk",                 "codepoint", MicroTWrapRun,     &text,                 cjkCodepoints},
+		{"tfwrap_cjk",                "call",      MicroTFWrapRun,    &text,                 1.0},
+		{"text_wave_advance_cjk",     "codepoint", MicroTextWaveRun,  &waveText,             (double)GetCodepointCount(waveText.text)},
+	};
+	const int kernelCount = (int)(sizeof(kernels) / sizeof(kernels[0]));
+
+	MicroResult results[sizeof(kernels) / sizeof(kernels[0])];
+	int resultCount = 0;
+	printf("%-24s %10s %12s %12s %16s\n", "kernel", "batch", "median ns", "p99 ns", "items/s");
+	for (int k = 0; k < kernelCount; k++)
+	{
+		if (filter && strstr(kernels[k].name, filter) == NULL) continue;
+		if (kernels[k].available && !kernels[k].available(kernels[k].context)) continue;
+		MicroResult r = MicroRun(&kernels[k], warmup, samples);
+		results[resultCount++] = r;
+		printf("%-24s %10ld %12.1f %12.1f %12.3g %-9s\n", kernels[k].name, r.batch, r.medianNs, r.p99Ns, r.itemsPerSecond, kernels[k].unit);
+	}
+	if (csvPath) MicroWriteCsv(csvPath, results, resultCount);
+
+	LocSetLanguage(LANG_EN);
+	Cleanup(&gameMemory);
+	free(arenaMemory);
+	return 0;
+}
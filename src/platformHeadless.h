@@ -0,0 +1,979 @@
+// Headless platform: implements the part of the raylib API the game uses
+// without a window, GPU or audio device.
+// - input is injected by the driver through HeadlessSetKey/HeadlessSetMouse
+// - time only advances when the driver calls HeadlessBeginFrame
+// - audio goes to a null sink that only counts what would have been played
+// - drawing calls are no-ops that only get counted
+// Images are decoded on the CPU so sprite masks (and therefore collisions)
+// match the windowed build exactly.
+#pragma once
+
+#include "raylib.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+
+#define HEADLESS_MAX_KEYS (512)
+#define HEADLESS_MAX_TEXTURES (64)
+
+typedef struct HeadlessPlatform {
+	double time;
+	float frameTime;
+	bool keysDown[HEADLESS_MAX_KEYS];
+	bool keysDownPrevious[HEADLESS_MAX_KEYS];
+	bool mouseDown[MOUSE_BUTTON_MIDDLE + 1];
+	bool mouseDownPrevious[MOUSE_BUTTON_MIDDLE + 1];
+	Vector2 mousePosition;
+	int renderWidth;
+	int renderHeight;
+	int logLevel;
+	unsigned int nextTextureId;
+	Image textures[HEADLESS_MAX_TEXTURES];
+	// Null sinks
+	unsigned long long soundsPlayed;
+	unsigned long long drawCalls;
+} HeadlessPlatform;
+
+static HeadlessPlatform headless = {
+	.renderWidth = 1440,
+	.renderHeight = 810,
+	.logLevel = LOG_WARNING,
+	.nextTextureId = 1,
+};
+
+// ---------------------------------------------------------------------------
+// Driver interface
+// ---------------------------------------------------------------------------
+static inline void HeadlessBeginFrame(float dt)
+{
+	memcpy(headless.keysDownPrevious, headless.keysDown, sizeof(headless.keysDown));
+	memcpy(headless.mouseDownPrevious, headless.mouseDown, sizeof(headless.mouseDown));
+	headless.frameTime = dt;
+	headless.time += dt;
+}
+
+static inline void HeadlessSetKey(int key, bool down)
+{
+	if (key >= 0 && key < HEADLESS_MAX_KEYS) headless.keysDown[key] = down;
+}
+
+static inline void HeadlessSetMouse(Vector2 position, bool leftDown)
+{
+	headless.mousePosition = position;
+	headless.mouseDown[MOUSE_BUTTON_LEFT] = leftDown;
+}
+
+static inline void HeadlessReleaseAll()
+{
+	memset(headless.keysDown, 0, sizeof(headless.keysDown));
+	memset(headless.mouseDown, 0, sizeof(headless.mouseDown));
+}
+
+// Monotonic wall clock in seconds, for the drivers' own measurements
+static inline double HeadlessWallTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// GetTime() is the simulated clock here, profile against the wall clock instead
+#define PROFILER_CLOCK() HeadlessWallTime()
+
+// ---------------------------------------------------------------------------
+// DEFLATE / PNG decoding
+// Only what we need: zlib streams and 8 bit, non-interlaced RGB(A) PNGs
+// (which is what aseprite exports for the atlas).
+// ---------------------------------------------------------------------------
+typedef struct HeadlessHuffman {
+	unsigned short counts[16];
+	unsigned short symbols[288];
+} HeadlessHuffman;
+
+typedef struct HeadlessInflate {
+	const unsigned char* src;
+	const unsigned char* srcEnd;
+	unsigned int bitBuffer;
+	int bitCount;
+	unsigned char* out;
+	size_t outLength;
+	size_t outCapacity;
+	bool failed;
+} HeadlessInflate;
+
+static unsigned int InflateBits(HeadlessInflate* s, int count)
+{
+	while (s->bitCount < count)
+	{
+		unsigned int byte = 0;
+		if (s->src < s->srcEnd) byte = *s->src++;
+		else s->failed = true;
+		s->bitBuffer |= byte << s->bitCount;
+		s->bitCount += 8;
+	}
+	unsigned int value = s->bitBuffer & ((1u << count) - 1u);
+	s->bitBuffer >>= count;
+	s->bitCount -= count;
+	return value;
+}
+
+static void InflateBuildHuffman(HeadlessHuffman* h, const unsigned char* lengths, int count)
+{
+	unsigned short offsets[16];
+	memset(h->counts, 0, sizeof(h->counts));
+	for (int i = 0; i < count; i++) h->counts[lengths[i]]++;
+	h->counts[0] = 0;
+	offsets[1] = 0;
+	for (int i = 1; i < 15; i++) offsets[i + 1] = offsets[i] + h->counts[i];
+	for (int i = 0; i < count; i++)
+	{
+		if (lengths[i]) h->symbols[offsets[lengths[i]]++] = (unsigned short)i;
+	}
+}
+
+static int InflateDecodeSymbol(HeadlessInflate* s, const HeadlessHuffman* h)
+{
+	int code = 0, first = 0, index = 0;
+	for (int length = 1; length < 16; length++)
+	{
+		code |= (int)InflateBits(s, 1);
+		int count = h->counts[length];
+		if (code - first < count) return h->symbols[index + (code - first)];
+		index += count;
+		first += count;
+		first <<= 1;
+		code <<= 1;
+	}
+	s->failed = true;
+	return 0;
+}
+
+static void InflatePush(HeadlessInflate* s, unsigned char byte)
+{
+	if (s->outLength == s->outCapacity)
+	{
+		s->outCapacity = s->outCapacity ? s->outCapacity * 2 : 4096;
+		s->out = (unsigned char*)realloc(s->out, s->outCapacity);
+	}
+	s->out[s->outLength++] = byte;
+}
+
+static void InflateBlock(HeadlessInflate* s, const HeadlessHuffman* lengths, const HeadlessHuffman* distances)
+{
+	static const unsigned short lengthBase[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+	static const unsigned char lengthExtra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+	static const unsigned short distanceBase[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+	static const unsigned char distanceExtra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+	while (!s->failed)
+	{
+		int symbol = InflateDecodeSymbol(s, lengths);
+		if (symbol < 256)
+		{
+			InflatePush(s, (unsigned char)symbol);
+			continue;
+		}
+		if (symbol == 256) return;
+		symbol -= 257;
+		if (symbol >= 29) { s->failed = true; return; }
+		size_t length = lengthBase[symbol] + InflateBits(s, lengthExtra[symbol]);
+		int distanceSymbol = InflateDecodeSymbol(s, distances);
+		if (distanceSymbol >= 30) { s->failed = true; return; }
+		size_t distance = distanceBase[distanceSymbol] + InflateBits(s, distanceExtra[distanceSymbol]);
+		if (distance > s->outLength) { s->failed = true; return; }
+		for (size_t i = 0; i < length; i++)
+		{
+			InflatePush(s, s->out[s->outLength - distance]);
+		}
+	}
+}
+
+// Inflate a raw DEFLATE stream, returns malloc'd data or NULL
+static unsigned char* InflateRaw(const unsigned char* data, size_t size, size_t sizeHint, size_t* outSize)
+{
+	static const unsigned char codeLengthOrder[19] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+	HeadlessInflate s = { .src = data, .srcEnd = data + size };
+	if (sizeHint > 0)
+	{
+		s.outCapacity = sizeHint;
+		s.out = (unsigned char*)malloc(sizeHint);
+	}
+	HeadlessHuffman lengths, distances;
+	int last = 0;
+	while (!last && !s.failed)
+	{
+		last = (int)InflateBits(&s, 1);
+		int type = (int)InflateBits(&s, 2);
+		if (type == 0)
+		{
+			s.bitBuffer = 0;
+			s.bitCount = 0;
+			if (s.srcEnd - s.src < 4) { s.failed = true; break; }
+			unsigned int length = s.src[0] | (s.src[1] << 8);
+			s.src += 4;
+			if ((size_t)(s.srcEnd - s.src) < length) { s.failed = true; break; }
+			for (unsigned int i = 0; i < length; i++) InflatePush(&s, s.src[i]);
+			s.src += length;
+		}
+		else if (type == 1)
+		{
+			unsigned char fixed[288 + 30];
+			for (int i = 0; i < 144; i++) fixed[i] = 8;
+			for (int i = 144; i < 256; i++) fixed[i] = 9;
+			for (int i = 256; i < 280; i++) fixed[i] = 7;
+			for (int i = 280; i < 288; i++) fixed[i] = 8;
+			for (int i = 0; i < 30; i++) fixed[288 + i] = 5;
+			InflateBuildHuffman(&lengths, fixed, 288);
+			InflateBuildHuffman(&distances, fixed + 288, 30);
+			InflateBlock(&s, &lengths, &distances);
+		}
+		else if (type == 2)
+		{
+			int literalCount = (int)InflateBits(&s, 5) + 257;
+			int distanceCount = (int)InflateBits(&s, 5) + 1;
+			int codeLengthCount = (int)InflateBits(&s, 4) + 4;
+			unsigned char codeLengths[19] = {0};
+			for (int i = 0; i < codeLengthCount; i++) codeLengths[codeLengthOrder[i]] = (unsigned char)InflateBits(&s, 3);
+			HeadlessHuffman codeLengthHuffman;
+			InflateBuildHuffman(&codeLengthHuffman, codeLengths, 19);
+
+			unsigned char bitLengths[288 + 32] = {0};
+			int n = 0;
+			while (n < literalCount + distanceCount && !s.failed)
+			{
+				int symbol = InflateDecodeSymbol(&s, &codeLengthHuffman);
+				if (symbol < 16) { bitLengths[n++] = (unsigned char)symbol; continue; }
+				int repeat = 0;
+				unsigned char value = 0;
+				if (symbol == 16)
+				{
+					if (n == 0) { s.failed = true; break; }
+					value = bitLengths[n - 1];
+					repeat = 3 + (int)InflateBits(&s, 2);
+				}
+				else if (symbol == 17) repeat = 3 + (int)InflateBits(&s, 3);
+				else repeat = 11 + (int)InflateBits(&s, 7);
+				if (n + repeat > literalCount + distanceCount) { s.failed = true; break; }
+				while (repeat--) bitLengths[n++] = value;
+			}
+			InflateBuildHuffman(&lengths, bitLengths, literalCount);
+			InflateBuildHuffman(&distances, bitLengths + literalCount, distanceCount);
+			InflateBlock(&s, &lengths, &distances);
+		}
+		else
+		{
+			s.failed = true;
+		}
+	}
+	if (s.failed)
+	{
+		free(s.out);
+		return NULL;
+	}
+	*outSize = s.outLength;
+	return s.out;
+}
+
+static inline unsigned int ReadBigEndian32(const unsigned char* p)
+{
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static inline int PaethPredictor(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+	if (pa <= pb && pa <= pc) return a;
+	if (pb <= pc) return b;
+	return c;
+}
+
+// Decode a PNG file into an RGBA8 image
+static Image HeadlessLoadPNG(const char* fileName)
+{
+	Image image = {0};
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+	{
+		TraceLog(LOG_WARNING, "HEADLESS: Failed to open %s", fileName);
+		return image;
+	}
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	unsigned char* data = (unsigned char*)malloc(fileSize);
+	fread(data, 1, fileSize, file);
+	fclose(file);
+
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	if (fileSize < 8 || memcmp(data, signature, 8) != 0)
+	{
+		TraceLog(LOG_WARNING, "HEADLESS: %s is not a PNG file", fileName);
+		free(data);
+		return image;
+	}
+
+	int width = 0, height = 0, colorType = 0, bitDepth = 0, interlace = 0;
+	unsigned char* idat = NULL;
+	size_t idatSize = 0;
+	long offset = 8;
+	while (offset + 12 <= fileSize)
+	{
+		unsigned int length = ReadBigEndian32(data + offset);
+		const unsigned char* type = data + offset + 4;
+		const unsigned char* chunk = data + offset + 8;
+		if (offset + 12 + (long)length > fileSize) break;
+		if (memcmp(type, "IHDR", 4) == 0)
+		{
+			width = (int)ReadBigEndian32(chunk);
+			height = (int)ReadBigEndian32(chunk + 4);
+			bitDepth = chunk[8];
+			colorType = chunk[9];
+			interlace = chunk[12];
+		}
+		else if (memcmp(type, "IDAT", 4) == 0)
+		{
+			idat = (unsigned char*)realloc(idat, idatSize + length);
+			memcpy(idat + idatSize, chunk, length);
+			idatSize += length;
+		}
+		else if (memcmp(type, "IEND", 4) == 0)
+		{
+			break;
+		}
+		offset += 12 + length;
+	}
+	free(data);
+
+	int channels = (colorType == 6) ? 4 : (colorType == 2) ? 3 : 0;
+	if (channels == 0 || bitDepth != 8 || interlace != 0 || idatSize < 2)
+	{
+		TraceLog(LOG_WARNING, "HEADLESS: Unsupported PNG format in %s", fileName);
+		free(idat);
+		return image;
+	}
+
+	size_t stride = (size_t)width * channels;
+	size_t rawSize = 0;
+	// Skip the 2 byte zlib header, the adler checksum at the end is ignored
+	unsigned char* raw = InflateRaw(idat + 2, idatSize - 2, (stride + 1) * height, &rawSize);
+	free(idat);
+	if (!raw || rawSize < (stride + 1) * height)
+	{
+		TraceLog(LOG_WARNING, "HEADLESS: Failed to inflate %s", fileName);
+		free(raw);
+		return image;
+	}
+
+	unsigned char* pixels = (unsigned char*)malloc((size_t)width * height * 4);
+	unsigned char* previous = (unsigned char*)calloc(stride, 1);
+	unsigned char* current = (unsigned char*)malloc(stride);
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* row = raw + y * (stride + 1);
+		int filter = row[0];
+		for (size_t x = 0; x < stride; x++)
+		{
+			int a = (x >= (size_t)channels) ? current[x - channels] : 0;
+			int b = previous[x];
+			int c = (x >= (size_t)channels) ? previous[x - channels] : 0;
+			int value = row[1 + x];
+			switch (filter)
+			{
+				case 1: value += a; break;
+				case 2: value += b; break;
+				case 3: value += (a + b) / 2; break;
+				case 4: value += PaethPredictor(a, b, c); break;
+				default: break;
+			}
+			current[x] = (unsigned char)value;
+		}
+		for (int x = 0; x < width; x++)
+		{
+			unsigned char* dst = pixels + ((size_t)y * width + x) * 4;
+			const unsigned char* src = current + x * channels;
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+			dst[3] = (channels == 4) ? src[3] : 255;
+		}
+		unsigned char* swap = previous;
+		previous = current;
+		current = swap;
+	}
+	free(previous);
+	free(current);
+	free(raw);
+
+	image.data = pixels;
+	image.width = width;
+	image.height = height;
+	image.mipmaps = 1;
+	image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+	return image;
+}
+
+// ---------------------------------------------------------------------------
+// Window, timing and misc core
+// ---------------------------------------------------------------------------
+void InitWindow(int width, int height, const char* title) { }
+void CloseWindow(void) { }
+bool WindowShouldClose(void) { return false; }
+void SetConfigFlags(unsigned int flags) { }
+void SetTargetFPS(int fps) { }
+void SetWindowMinSize(int width, int height) { }
+void SetWindowPosition(int x, int y) { }
+Vector2 GetWindowPosition(void) { return (Vector2){0, 0}; }
+bool IsWindowState(unsigned int flag) { return false; }
+void SetWindowState(unsigned int flags) { }
+void ClearWindowState(unsigned int flags) { }
+void ToggleFullscreen(void) { }
+void HideCursor(void) { }
+void SetExitKey(int key) { }
+int GetScreenWidth(void) { return headless.renderWidth; }
+int GetRenderWidth(void) { return headless.renderWidth; }
+int GetRenderHeight(void) { return headless.renderHeight; }
+double GetTime(void) { return headless.time; }
+float GetFrameTime(void) { return headless.frameTime; }
+const char* GetApplicationDirectory(void) { return "./"; }
+const char* GetClipboardText(void) { return ""; }
+
+void TraceLog(int logLevel, const char* text, ...)
+{
+	if (logLevel < headless.logLevel) return;
+	static const char* prefixes[] = { "", "TRACE: ", "DEBUG: ", "INFO: ", "WARNING: ", "ERROR: ", "FATAL: ", "" };
+	printf("%s", prefixes[logLevel >= 0 && logLevel <= LOG_NONE ? logLevel : 0]);
+	va_list args;
+	va_start(args, text);
+	vprintf(text, args);
+	va_end(args);
+	printf("\n");
+	if (logLevel == LOG_FATAL) exit(EXIT_FAILURE);
+}
+
+int GetRandomValue(int min, int max)
+{
+	if (min > max)
+	{
+		int tmp = max;
+		max = min;
+		min = tmp;
+	}
+	return rand() % (abs(max - min) + 1) + min;
+}
+
+const char* TextFormat(const char* text, ...)
+{
+	static char buffers[4][1024];
+	static int index = 0;
+	char* buffer = buffers[index];
+	index = (index + 1) % 4;
+	va_list args;
+	va_start(args, text);
+	vsnprintf(buffer, sizeof(buffers[0]), text, args);
+	va_end(args);
+	return buffer;
+}
+
+int TextToInteger(const char* text) { return atoi(text); }
+float TextToFloat(const char* text) { return (float)atof(text); }
+
+const char* GetDirectoryPath(const char* filePath)
+{
+	static char path[512];
+	strncpy(path, filePath, sizeof(path) - 1);
+	path[sizeof(path) - 1] = '\0';
+	char* slash = strrchr(path, '/');
+	if (slash) *slash = '\0';
+	else strcpy(path, ".");
+	return path;
+}
+
+bool SaveFileData(const char* fileName, void* data, int dataSize)
+{
+	FILE* file = fopen(fileName, "wb");
+	if (!file) return false;
+	fwrite(data, 1, dataSize, file);
+	fclose(file);
+	return true;
+}
+
+char* LoadFileText(const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (!file) return NULL;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	char* text = (char*)malloc(size + 1);
+	size = (long)fread(text, 1, size, file);
+	text[size] = '\0';
+	fclose(file);
+	return text;
+}
+
+void UnloadFileText(char* text) { free(text); }
+
+unsigned char* DecompressData(const unsigned char* compData, int compDataSize, int* dataSize)
+{
+	size_t size = 0;
+	unsigned char* data = InflateRaw(compData, compDataSize, 0, &size);
+	*dataSize = (int)size;
+	return data;
+}
+
+// ---------------------------------------------------------------------------
+// Input (injected)
+// ---------------------------------------------------------------------------
+bool IsKeyDown(int key) { return key >= 0 && key < HEADLESS_MAX_KEYS && headless.keysDown[key]; }
+bool IsKeyPressed(int key) { return IsKeyDown(key) && !headless.keysDownPrevious[key]; }
+bool IsMouseButtonDown(int button) { return button >= 0 && button <= MOUSE_BUTTON_MIDDLE && headless.mouseDown[button]; }
+bool IsMouseButtonPressed(int button) { return IsMouseButtonDown(button) && !headless.mouseDownPrevious[button]; }
+bool IsMouseButtonReleased(int button) { return button >= 0 && button <= MOUSE_BUTTON_MIDDLE && !headless.mouseDown[button] && headless.mouseDownPrevious[button]; }
+Vector2 GetMousePosition(void) { return headless.mousePosition; }
+float GetMouseWheelMove(void) { return 0.0f; }
+int GetCharPressed(void) { return 0; }
+
+// ---------------------------------------------------------------------------
+// Collision helpers (same math as raylib's rshapes.c)
+// ---------------------------------------------------------------------------
+bool CheckCollisionRecs(Rectangle rec1, Rectangle rec2)
+{
+	return (rec1.x < (rec2.x + rec2.width) && (rec1.x + rec1.width) > rec2.x) &&
+		(rec1.y < (rec2.y + rec2.height) && (rec1.y + rec1.height) > rec2.y);
+}
+
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec)
+{
+	return (point.x >= rec.x) && (point.x < (rec.x + rec.width)) && (point.y >= rec.y) && (point.y < (rec.y + rec.height));
+}
+
+bool CheckCollisionPointLine(Vector2 point, Vector2 p1, Vector2 p2, int threshold)
+{
+	bool collision = false;
+	float dxc = point.x - p1.x;
+	float dyc = point.y - p1.y;
+	float dxl = p2.x - p1.x;
+	float dyl = p2.y - p1.y;
+	float cross = dxc*dyl - dyc*dxl;
+	if (fabsf(cross) < (threshold*fmaxf(fabsf(dxl), fabsf(dyl))))
+	{
+		if (fabsf(dxl) >= fabsf(dyl)) collision = (dxl > 0)? ((p1.x <= point.x) && (point.x <= p2.x)) : ((p2.x <= point.x) && (point.x <= p1.x));
+		else collision = (dyl > 0)? ((p1.y <= point.y) && (point.y <= p2.y)) : ((p2.y <= point.y) && (point.y <= p1.y));
+	}
+	return collision;
+}
+
+Rectangle GetCollisionRec(Rectangle rec1, Rectangle rec2)
+{
+	Rectangle overlap = {0};
+	float left = (rec1.x > rec2.x)? rec1.x : rec2.x;
+	float right1 = rec1.x + rec1.width;
+	float right2 = rec2.x + rec2.width;
+	float right = (right1 < right2)? right1 : right2;
+	float top = (rec1.y > rec2.y)? rec1.y : rec2.y;
+	float bottom1 = rec1.y + rec1.height;
+	float bottom2 = rec2.y + rec2.height;
+	float bottom = (bottom1 < bottom2)? bottom1 : bottom2;
+	if ((left < right) && (top < bottom))
+	{
+		overlap.x = left;
+		overlap.y = top;
+		overlap.width = right - left;
+		overlap.height = bottom - top;
+	}
+	return overlap;
+}
+
+// ---------------------------------------------------------------------------
+// Colors
+// ---------------------------------------------------------------------------
+Color ColorAlpha(Color color, float alpha)
+{
+	if (alpha < 0.0f) alpha = 0.0f;
+	else if (alpha > 1.0f) alpha = 1.0f;
+	color.a = (unsigned char)(255.0f*alpha);
+	return color;
+}
+
+Color Fade(Color color, float alpha) { return ColorAlpha(color, alpha); }
+
+Color GetColor(unsigned int hexValue)
+{
+	return (Color){ (unsigned char)(hexValue >> 24), (unsigned char)(hexValue >> 16), (unsigned char)(hexValue >> 8), (unsigned char)hexValue };
+}
+
+Color ColorFromHSV(float hue, float saturation, float value)
+{
+	Color color = { 0, 0, 0, 255 };
+	float offsets[3] = { 5.0f, 3.0f, 1.0f };
+	unsigned char* channels[3] = { &color.r, &color.g, &color.b };
+	for (int i = 0; i < 3; i++)
+	{
+		float k = fmodf((offsets[i] + hue/60.0f), 6);
+		float t = 4.0f - k;
+		k = (t < k)? t : k;
+		k = (k < 1)? k : 1;
+		k = (k > 0)? k : 0;
+		*channels[i] = (unsigned char)((value - value*saturation*k)*255.0f);
+	}
+	return color;
+}
+
+// ---------------------------------------------------------------------------
+// Images and textures
+// ---------------------------------------------------------------------------
+static inline Texture2D HeadlessRegisterTexture(Image image)
+{
+	Texture2D texture = {0};
+	texture.id = headless.nextTextureId++;
+	texture.width = image.width;
+	texture.height = image.height;
+	texture.mipmaps = 1;
+	texture.format = image.format;
+	if (texture.id < HEADLESS_MAX_TEXTURES) headless.textures[texture.id] = image;
+	else free(image.data);
+	return texture;
+}
+
+Texture2D LoadTexture(const char* fileName)
+{
+	TraceLog(LOG_INFO, "HEADLESS: Loading texture %s", fileName);
+	return HeadlessRegisterTexture(HeadlessLoadPNG(fileName));
+}
+
+Texture2D LoadTextureFromImage(Image image)
+{
+	// Only the handle is needed, pixel data stays with the caller
+	return HeadlessRegisterTexture((Image){ .width = image.width, .height = image.height, .mipmaps = 1, .format = image.format });
+}
+
+void UnloadTexture(Texture2D texture)
+{
+	if (texture.id > 0 && texture.id < HEADLESS_MAX_TEXTURES)
+	{
+		free(headless.textures[texture.id].data);
+		headless.textures[texture.id] = (Image){0};
+	}
+}
+
+void SetTextureFilter(Texture2D texture, int filter) { }
+
+RenderTexture2D LoadRenderTexture(int width, int height)
+{
+	RenderTexture2D target = {0};
+	target.id = headless.nextTextureId++;
+	target.texture = (Texture2D){ .id = target.id, .width = width, .height = height, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+	return target;
+}
+
+Image LoadImageFromTexture(Texture2D texture)
+{
+	Image image = {0};
+	if (texture.id == 0 || texture.id >= HEADLESS_MAX_TEXTURES) return image;
+	Image source = headless.textures[texture.id];
+	if (!source.data) return image;
+	size_t size = (size_t)source.width * source.height * 4;
+	image = source;
+	image.data = malloc(size);
+	memcpy(image.data, source.data, size);
+	return image;
+}
+
+Image LoadImageFromScreen(void)
+{
+	Image image = { .width = headless.renderWidth, .height = headless.renderHeight, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+	image.data = calloc((size_t)image.width * image.height, 4);
+	return image;
+}
+
+void UnloadImage(Image image) { free(image.data); }
+
+void ImageFormat(Image* image, int newFormat)
+{
+	if (image->format != newFormat && image->data)
+	{
+		TraceLog(LOG_WARNING, "HEADLESS: ImageFormat conversion %d -> %d not supported", image->format, newFormat);
+	}
+}
+
+Image ImageFromImage(Image image, Rectangle rec)
+{
+	Image result = { .width = (int)rec.width, .height = (int)rec.height, .mipmaps = 1, .format = image.format };
+	result.data = calloc((size_t)result.width * result.height, 4);
+	if (!image.data) return result;
+	for (int y = 0; y < result.height; y++)
+	{
+		int sy = y + (int)rec.y;
+		if (sy < 0 || sy >= image.height) continue;
+		for (int x = 0; x < result.width; x++)
+		{
+			int sx = x + (int)rec.x;
+			if (sx < 0 || sx >= image.width) continue;
+			memcpy((unsigned char*)result.data + ((size_t)y * result.width + x) * 4,
+					(unsigned char*)image.data + ((size_t)sy * image.width + sx) * 4, 4);
+		}
+	}
+	return result;
+}
+
+Color* LoadImageColors(Image image)
+{
+	size_t size = (size_t)image.width * image.height * sizeof(Color);
+	Color* colors = (Color*)malloc(size);
+	if (image.data) memcpy(colors, image.data, size);
+	else memset(colors, 0, size);
+	return colors;
+}
+
+void UnloadImageColors(Color* colors) { free(colors); }
+void TakeScreenshot(const char* fileName) { }
+
+// ---------------------------------------------------------------------------
+// Text
+// Fonts get synthetic metrics: half-width latin glyphs, full-width CJK glyphs.
+// ---------------------------------------------------------------------------
+int GetCodepointNext(const char* text, int* codepointSize)
+{
+	const unsigned char* ptr = (const unsigned char*)text;
+	int codepoint = 0x3f;
+	*codepointSize = 1;
+	if (0xf0 == (0xf8 & ptr[0]))
+	{
+		if (((ptr[1] & 0xC0) ^ 0x80) || ((ptr[2] & 0xC0) ^ 0x80) || ((ptr[3] & 0xC0) ^ 0x80)) return codepoint;
+		codepoint = ((0x07 & ptr[0]) << 18) | ((0x3f & ptr[1]) << 12) | ((0x3f & ptr[2]) << 6) | (0x3f & ptr[3]);
+		*codepointSize = 4;
+	}
+	else if (0xe0 == (0xf0 & ptr[0]))
+	{
+		if (((ptr[1] & 0xC0) ^ 0x80) || ((ptr[2] & 0xC0) ^ 0x80)) return codepoint;
+		codepoint = ((0x0f & ptr[0]) << 12) | ((0x3f & ptr[1]) << 6) | (0x3f & ptr[2]);
+		*codepointSize = 3;
+	}
+	else if (0xc0 == (0xe0 & ptr[0]))
+	{
+		if ((ptr[1] & 0xC0) ^ 0x80) return codepoint;
+		codepoint = ((0x1f & ptr[0]) << 6) | (0x3f & ptr[1]);
+		*codepointSize = 2;
+	}
+	else if (0x00 == (0x80 & ptr[0]))
+	{
+		codepoint = ptr[0];
+		*codepointSize = 1;
+	}
+	return codepoint;
+}
+
+int GetCodepoint(const char* text, int* codepointSize) { return GetCodepointNext(text, codepointSize); }
+
+int GetCodepointPrevious(const char* text, int* codepointSize)
+{
+	const char* ptr = text;
+	int codepoint = 0x3f;
+	int count = 0;
+	*codepointSize = 0;
+	do
+	{
+		ptr--;
+		count++;
+	} while ((count < 4) && ((0x80 & *ptr) && ((*ptr & 0xC0) == 0x80)));
+	codepoint = GetCodepointNext(ptr, codepointSize);
+	if (codepoint != 0) *codepointSize = count;
+	return codepoint;
+}
+
+const char* CodepointToUTF8(int codepoint, int* utf8Size)
+{
+	static char utf8[6] = {0};
+	int size = 0;
+	memset(utf8, 0, sizeof(utf8));
+	if (codepoint <= 0x7f) { utf8[0] = (char)codepoint; size = 1; }
+	else if (codepoint <= 0x7ff) { utf8[0] = (char)(((codepoint >> 6) & 0x1f) | 0xc0); utf8[1] = (char)((codepoint & 0x3f) | 0x80); size = 2; }
+	else if (codepoint <= 0xffff) { utf8[0] = (char)(((codepoint >> 12) & 0x0f) | 0xe0); utf8[1] = (char)(((codepoint >> 6) & 0x3f) | 0x80); utf8[2] = (char)((codepoint & 0x3f) | 0x80); size = 3; }
+	else if (codepoint <= 0x10ffff) { utf8[0] = (char)(((codepoint >> 18) & 0x07) | 0xf0); utf8[1] = (char)(((codepoint >> 12) & 0x3f) | 0x80); utf8[2] = (char)(((codepoint >> 6) & 0x3f) | 0x80); utf8[3] = (char)((codepoint & 0x3f) | 0x80); size = 4; }
+	*utf8Size = size;
+	return utf8;
+}
+
+int* LoadCodepoints(const char* text, int* count)
+{
+	int length = (int)strlen(text);
+	int* codepoints = (int*)calloc(length + 1, sizeof(int));
+	int codepointCount = 0;
+	int codepointSize = 0;
+	for (int i = 0; i < length; i += codepointSize)
+	{
+		codepoints[codepointCount++] = GetCodepointNext(&text[i], &codepointSize);
+	}
+	*count = codepointCount;
+	return codepoints;
+}
+
+void UnloadCodepoints(int* codepoints) { free(codepoints); }
+
+int GetCodepointCount(const char* text)
+{
+	int length = 0;
+	int codepointSize = 0;
+	for (const char* ptr = text; *ptr != '\0'; ptr += codepointSize, length++)
+	{
+		GetCodepointNext(ptr, &codepointSize);
+	}
+	return length;
+}
+
+Font LoadFontEx(const char* fileName, int fontSize, int* codepoints, int codepointCount)
+{
+	Font font = {0};
+	int count = (codepoints && codepointCount > 0) ? codepointCount : 95;
+	font.baseSize = fontSize;
+	font.glyphCount = count;
+	font.glyphs = (GlyphInfo*)calloc(count, sizeof(GlyphInfo));
+	font.recs = (Rectangle*)calloc(count, sizeof(Rectangle));
+	for (int i = 0; i < count; i++)
+	{
+		int codepoint = (codepoints && codepointCount > 0) ? codepoints[i] : 32 + i;
+		int advance = (codepoint >= 0x2E80) ? fontSize : fontSize / 2;
+		font.glyphs[i].value = codepoint;
+		font.glyphs[i].advanceX = advance;
+		font.recs[i] = (Rectangle){ 0, 0, (float)advance, (float)fontSize };
+	}
+	font.texture = (Texture2D){ .id = headless.nextTextureId++, .width = 1, .height = 1, .mipmaps = 1 };
+	return font;
+}
+
+Font GetFontDefault(void)
+{
+	static Font font = {0};
+	if (font.glyphCount == 0) font = LoadFontEx(NULL, 10, NULL, 0);
+	return font;
+}
+
+void UnloadFont(Font font)
+{
+	free(font.glyphs);
+	free(font.recs);
+}
+
+int GetGlyphIndex(Font font, int codepoint)
+{
+	int index = 0;
+	int fallbackIndex = 0;
+	for (int i = 0; i < font.glyphCount; i++)
+	{
+		if (font.glyphs[i].value == 63) fallbackIndex = i;
+		if (font.glyphs[i].value == codepoint)
+		{
+			index = i;
+			break;
+		}
+	}
+	if ((index == 0) && (font.glyphs[0].value != codepoint)) index = fallbackIndex;
+	return index;
+}
+
+Vector2 MeasureTextEx(Font font, const char* text, float fontSize, float spacing)
+{
+	Vector2 textSize = {0};
+	if ((font.texture.id == 0) || (text == NULL) || (text[0] == '\0')) return textSize;
+
+	const float textLineSpacing = 2.0f;
+	int size = (int)strlen(text);
+	int tempByteCounter = 0;
+	int byteCounter = 0;
+	float textWidth = 0.0f;
+	float tempTextWidth = 0.0f;
+	float textHeight = fontSize;
+	float scaleFactor = fontSize/(float)font.baseSize;
+
+	for (int i = 0; i < size;)
+	{
+		byteCounter++;
+		int codepointByteCount = 0;
+		int letter = GetCodepointNext(&text[i], &codepointByteCount);
+		int index = GetGlyphIndex(font, letter);
+		i += codepointByteCount;
+		if (letter != '\n')
+		{
+			if (font.glyphs[index].advanceX > 0) textWidth += font.glyphs[index].advanceX;
+			else textWidth += (font.recs[index].width + font.glyphs[index].offsetX);
+		}
+		else
+		{
+			if (tempTextWidth < textWidth) tempTextWidth = textWidth;
+			byteCounter = 0;
+			textWidth = 0;
+			textHeight += (fontSize + textLineSpacing);
+		}
+		if (tempByteCounter < byteCounter) tempByteCounter = byteCounter;
+	}
+	if (tempTextWidth < textWidth) tempTextWidth = textWidth;
+	textSize.x = tempTextWidth*scaleFactor + (float)((tempByteCounter - 1)*spacing);
+	textSize.y = textHeight;
+	return textSize;
+}
+
+// ---------------------------------------------------------------------------
+// Drawing (null renderer)
+// ---------------------------------------------------------------------------
+void BeginDrawing(void) { }
+void EndDrawing(void) { }
+void ClearBackground(Color color) { }
+void BeginTextureMode(RenderTexture2D target) { }
+void EndTextureMode(void) { }
+void BeginShaderMode(Shader shader) { }
+void EndShaderMode(void) { }
+void BeginBlendMode(int mode) { }
+void EndBlendMode(void) { }
+void SetShapesTexture(Texture2D texture, Rectangle source) { }
+void DrawFPS(int posX, int posY) { headless.drawCalls++; }
+void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) { headless.drawCalls++; }
+void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint) { headless.drawCalls++; }
+void DrawRectangle(int posX, int posY, int width, int height, Color color) { headless.drawCalls++; }
+void DrawRectangleRec(Rectangle rec, Color color) { headless.drawCalls++; }
+void DrawRectangleLines(int posX, int posY, int width, int height, Color color) { headless.drawCalls++; }
+void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) { headless.drawCalls++; }
+void DrawRectangleGradientV(int posX, int posY, int width, int height, Color top, Color bottom) { headless.drawCalls++; }
+void DrawRectangleGradientEx(Rectangle rec, Color topLeft, Color bottomLeft, Color topRight, Color bottomRight) { headless.drawCalls++; }
+void DrawTextEx(Font font, const char* text, Vector2 position, float fontSize, float spacing, Color tint) { headless.drawCalls++; }
+void DrawTextPro(Font font, const char* text, Vector2 position, Vector2 origin, float rotation, float fontSize, float spacing, Color tint) { headless.drawCalls++; }
+void DrawTextCodepoint(Font font, int codepoint, Vector2 position, float fontSize, Color tint) { headless.drawCalls++; }
+
+// ---------------------------------------------------------------------------
+// Shaders
+// ---------------------------------------------------------------------------
+Shader LoadShader(const char* vsFileName, const char* fsFileName) { return (Shader){0}; }
+void UnloadShader(Shader shader) { }
+int GetShaderLocation(Shader shader, const char* uniformName) { return -1; }
+void SetShaderValue(Shader shader, int locIndex, const void* value, int uniformType) { }
+void SetShaderValueV(Shader shader, int locIndex, const void* value, int uniformType, int count) { }
+
+// ---------------------------------------------------------------------------
+// Audio (null sink)
+// ---------------------------------------------------------------------------
+void InitAudioDevice(void) { }
+void CloseAudioDevice(void) { }
+bool IsAudioDeviceReady(void) { return true; }
+Sound LoadSound(const char* fileName) { return (Sound){ .frameCount = 1 }; }
+bool IsSoundValid(Sound sound) { return true; }
+void UnloadSound(Sound sound) { }
+void PlaySound(Sound sound) { headless.soundsPlayed++; }
+void StopSound(Sound sound) { }
+void PauseSound(Sound sound) { }
+void ResumeSound(Sound sound) { }
+bool IsSoundPlaying(Sound sound) { return false; }
+void SetSoundVolume(Sound sound, float volume) { }
+void SetSoundPitch(Sound sound, float pitch) { }
+Music LoadMusicStream(const char* fileName) { return (Music){ .frameCount = 1 }; }
+bool IsMusicValid(Music music) { return true; }
+void UnloadMusicStream(Music music) { }
+void PlayMusicStream(Music music) { }
+bool IsMusicStreamPlaying(Music music) { return true; }
+void UpdateMusicStream(Music music) { }
+void ResumeMusicStream(Music music) { }
+void SeekMusicStream(Music music, float position) { }
+void SetMusicVolume(Music music, float volume) { }
+float GetMusicTimePlayed(Music music) { return 0.0f; }
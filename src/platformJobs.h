@@ -0,0 +1,216 @@
+// Worker threads of the job system (see jobs.h), started by the platform
+// layer so they outlive hot reloads of the game code. A worker keeps looking
+// for jobs for a while after it ran out, then sleeps until JobGraphRun
+// publishes the next graph. Windows uses its own threads and condition
+// variables, so the MSVC build needs no pthreads; everything else uses
+// pthreads. Not used by the web build, which runs every graph on the game
+// thread.
+#pragma once
+
+#include <stdio.h>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOGDI
+#define NOGDI
+#endif
+#ifndef NOUSER
+#define NOUSER
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "jobs.h"
+
+// Failed searches for a job before a worker goes to sleep
+#define JOB_SLEEP_AFTER (4096)
+
+#ifdef _WIN32
+typedef HANDLE JobThread;
+typedef CRITICAL_SECTION JobMutex;
+typedef CONDITION_VARIABLE JobCondition;
+#else
+typedef pthread_t JobThread;
+typedef pthread_mutex_t JobMutex;
+typedef pthread_cond_t JobCondition;
+#endif
+
+typedef struct JobThreads {
+	JobThread threads[JOB_MAX_WORKERS];
+	int workers[JOB_MAX_WORKERS];
+	JobSystem* system;
+	JobMutex mutex;
+	JobCondition wakeup;
+} JobThreads;
+
+static JobThreads jobThreads;
+
+// Threading primitives
+
+#ifdef _WIN32
+static inline void JobMutexInit(JobMutex* mutex) { InitializeCriticalSection(mutex); }
+static inline void JobMutexDestroy(JobMutex* mutex) { DeleteCriticalSection(mutex); }
+static inline void JobMutexLock(JobMutex* mutex) { EnterCriticalSection(mutex); }
+static inline void JobMutexUnlock(JobMutex* mutex) { LeaveCriticalSection(mutex); }
+static inline void JobConditionInit(JobCondition* condition) { InitializeConditionVariable(condition); }
+static inline void JobConditionDestroy(JobCondition* condition) { (void)condition; }
+static inline void JobConditionWait(JobCondition* condition, JobMutex* mutex) { SleepConditionVariableCS(condition, mutex, INFINITE); }
+static inline void JobConditionBroadcast(JobCondition* condition) { WakeAllConditionVariable(condition); }
+static inline void JobThreadYield(void) { SwitchToThread(); }
+#else
+static inline void JobMutexInit(JobMutex* mutex) { pthread_mutex_init(mutex, NULL); }
+static inline void JobMutexDestroy(JobMutex* mutex) { pthread_mutex_destroy(mutex); }
+static inline void JobMutexLock(JobMutex* mutex) { pthread_mutex_lock(mutex); }
+static inline void JobMutexUnlock(JobMutex* mutex) { pthread_mutex_unlock(mutex); }
+static inline void JobConditionInit(JobCondition* condition) { pthread_cond_init(condition, NULL); }
+static inline void JobConditionDestroy(JobCondition* condition) { pthread_cond_destroy(condition); }
+static inline void JobConditionWait(JobCondition* condition, JobMutex* mutex) { pthread_cond_wait(condition, mutex); }
+static inline void JobConditionBroadcast(JobCondition* condition) { pthread_cond_broadcast(condition); }
+static inline void JobThreadYield(void) { sched_yield(); }
+#endif
+
+static void JobThreadsWake(JobSystem* system)
+{
+	JobThreads* threads = (JobThreads*)system->platform;
+	// Taking the mutex means a worker is either still before its generation
+	// check or already waiting, so it cannot miss the broadcast
+	JobMutexLock(&threads->mutex);
+	JobConditionBroadcast(&threads->wakeup);
+	JobMutexUnlock(&threads->mutex);
+}
+
+static void JobThreadsYield(JobSystem* system)
+{
+	(void)system;
+	JobThreadYield();
+}
+
+static void JobWorkerLoop(int worker)
+{
+	JobSystem* system = jobThreads.system;
+	long seen = __atomic_load_n(&system->generation, __ATOMIC_SEQ_CST);
+	int idle = 0;
+	while (!__atomic_load_n(&system->quit, __ATOMIC_ACQUIRE))
+	{
+		Job* job = JobFind(system, worker);
+		if (job)
+		{
+			JobExecute(system, worker, job);
+			idle = 0;
+		}
+		else if (++idle < JOB_SLEEP_AFTER)
+		{
+			if (idle % JOB_SPIN == 0) JobThreadYield();
+			else JobPause();
+		}
+		else
+		{
+			JobMutexLock(&jobThreads.mutex);
+			__atomic_add_fetch(&system->sleeping, 1, __ATOMIC_SEQ_CST);
+			while (__atomic_load_n(&system->generation, __ATOMIC_SEQ_CST) == seen && !__atomic_load_n(&system->quit, __ATOMIC_ACQUIRE))
+			{
+				JobConditionWait(&jobThreads.wakeup, &jobThreads.mutex);
+			}
+			__atomic_sub_fetch(&system->sleeping, 1, __ATOMIC_SEQ_CST);
+			seen = __atomic_load_n(&system->generation, __ATOMIC_SEQ_CST);
+			JobMutexUnlock(&jobThreads.mutex);
+			idle = 0;
+		}
+	}
+}
+
+#ifdef _WIN32
+static DWORD WINAPI JobWorkerMain(LPVOID argument)
+{
+	JobWorkerLoop(*(int*)argument);
+	return 0;
+}
+
+static inline bool JobThreadStart(JobThread* thread, int* worker)
+{
+	*thread = CreateThread(NULL, 0, JobWorkerMain, worker, 0, NULL);
+	return *thread != NULL;
+}
+
+static inline void JobThreadJoin(JobThread thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+#else
+static void* JobWorkerMain(void* argument)
+{
+	JobWorkerLoop(*(int*)argument);
+	return NULL;
+}
+
+static inline bool JobThreadStart(JobThread* thread, int* worker)
+{
+	return pthread_create(thread, NULL, JobWorkerMain, worker) == 0;
+}
+
+static inline void JobThreadJoin(JobThread thread)
+{
+	pthread_join(thread, NULL);
+}
+#endif
+
+// One worker per core besides the game thread
+static inline int JobDefaultWorkerCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const int cores = (int)info.dwNumberOfProcessors;
+#else
+	const int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return cores > 1 ? cores - 1 : 0;
+}
+
+// Falls back to running every graph on the game thread if the threads cannot be started
+static inline void JobSystemStart(JobSystem* system, int workerCount)
+{
+	memset(system, 0, sizeof(*system));
+	workerCount = workerCount < 0 ? 0 : workerCount > JOB_MAX_WORKERS ? JOB_MAX_WORKERS : workerCount;
+	if (workerCount == 0) return;
+	system->workerCount = workerCount;
+	system->wake = JobThreadsWake;
+	system->yield = JobThreadsYield;
+	system->platform = &jobThreads;
+	jobThreads.system = system;
+	JobMutexInit(&jobThreads.mutex);
+	JobConditionInit(&jobThreads.wakeup);
+	for (int i = 0; i < workerCount; i++)
+	{
+		jobThreads.workers[i] = i + 1;
+		if (!JobThreadStart(&jobThreads.threads[i], &jobThreads.workers[i]))
+		{
+			printf("Could not start job worker %d, running jobs on the game thread\n", i + 1);
+			__atomic_store_n(&system->quit, true, __ATOMIC_RELEASE);
+			JobThreadsWake(system);
+			for (int j = 0; j < i; j++) JobThreadJoin(jobThreads.threads[j]);
+			JobConditionDestroy(&jobThreads.wakeup);
+			JobMutexDestroy(&jobThreads.mutex);
+			system->workerCount = 0;
+			system->quit = false;
+			return;
+		}
+	}
+}
+
+static inline void JobSystemStop(JobSystem* system)
+{
+	if (system->workerCount == 0) return;
+	__atomic_store_n(&system->quit, true, __ATOMIC_RELEASE);
+	JobThreadsWake(system);
+	for (int i = 0; i < system->workerCount; i++) JobThreadJoin(jobThreads.threads[i]);
+	JobConditionDestroy(&jobThreads.wakeup);
+	JobMutexDestroy(&jobThreads.mutex);
+	system->workerCount = 0;
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "arena.h"
+
+// Bookkeeping for an entity array in GameState. The entities themselves stay
+// densely packed in their own array (index 0..count-1), the pool maps stable
+// slots to those dense indices so a handle keeps referring to the same entity
+// while others are removed around it.
+//
+// Removal is deferred: PoolRemove only marks the entity, every pass of the
+// same tick skips it via PoolAlive, and PoolCompact swaps the survivors
+// together at the end of the tick. Nothing moves while a pass is iterating.
+//
+// The arrays are carved from the game's arena at the capacity the
+// configuration asks for. PoolGrow moves them to larger ones when a pool runs
+// full and is allowed to grow; slots and dense indices stay as they were, so
+// handles remain valid. POOL_MAX_CAPACITY is the ceiling for any pool: it
+// keeps slots in 16 bits and bounds the candidate bitsets on the stack.
+#define POOL_MAX_CAPACITY (8192)
+
+typedef struct EntityHandle {
+	uint16_t slot;
+	uint16_t generation; // 0 never refers to a live entity
+} EntityHandle;
+
+#define ENTITY_NONE ((EntityHandle){0, 0})
+
+static inline bool HandleIsNone(EntityHandle handle)
+{
+	return handle.generation == 0;
+}
+
+typedef struct EntityPool {
+	int capacity;
+	int freeCount;
+	int removedCount;
+	uint16_t* generation; // per slot, bumped when the slot is freed
+	uint16_t* slotToDense;
+	uint16_t* denseToSlot;
+	uint16_t* freeSlots;
+	bool* removed; // per dense index, waiting for PoolCompact
+} EntityPool;
+
+static inline int PoolClampCapacity(int capacity)
+{
+	return capacity < 1 ? 1 : capacity > POOL_MAX_CAPACITY ? POOL_MAX_CAPACITY : capacity;
+}
+
+// Carves the arrays for capacity slots, false if the arena is full
+static inline bool PoolCarve(EntityPool* pool, MemoryArena* arena, int capacity)
+{
+	pool->generation = (uint16_t*)ArenaPush(arena, capacity * sizeof(uint16_t));
+	pool->slotToDense = (uint16_t*)ArenaPush(arena, capacity * sizeof(uint16_t));
+	pool->denseToSlot = (uint16_t*)ArenaPush(arena, capacity * sizeof(uint16_t));
+	pool->freeSlots = (uint16_t*)ArenaPush(arena, capacity * sizeof(uint16_t));
+	pool->removed = (bool*)ArenaPush(arena, capacity * sizeof(bool));
+	return pool->removed != NULL;
+}
+
+// Adds the slots from..to-1 to the free list, below the ones already in it
+static inline void PoolFreeNewSlots(EntityPool* pool, int from, int to)
+{
+	// Hand out low slots first so runs with the same history get the same handles
+	memmove(pool->freeSlots + (to - from), pool->freeSlots, pool->freeCount * sizeof(uint16_t));
+	for (int i = 0; i < to - from; i++)
+	{
+		pool->freeSlots[i] = (uint16_t)(to - 1 - i);
+		pool->generation[from + i] = 1;
+	}
+	pool->freeCount += to - from;
+}
+
+// Carves the arrays from the arena and frees every slot, false if the arena is full
+static inline bool PoolInit(EntityPool* pool, MemoryArena* arena, int capacity)
+{
+	memset(pool, 0, sizeof(*pool));
+	capacity = PoolClampCapacity(capacity);
+	if (!PoolCarve(pool, arena, capacity)) return false;
+	pool->capacity = capacity;
+	PoolFreeNewSlots(pool, 0, capacity);
+	return true;
+}
+
+// Moves the pool to arrays for a larger capacity. Leaves the pool and the
+// arena as they were and returns false if the arena has no room for them.
+static inline bool PoolGrow(EntityPool* pool, MemoryArena* arena, int capacity)
+{
+	capacity = PoolClampCapacity(capacity);
+	if (capacity <= pool->capacity) return false;
+	const size_t mark = arena->used;
+	EntityPool grown = *pool;
+	if (!PoolCarve(&grown, arena, capacity))
+	{
+		arena->used = mark;
+		return false;
+	}
+	const size_t slots = pool->capacity * sizeof(uint16_t);
+	memcpy(grown.generation, pool->generation, slots);
+	memcpy(grown.slotToDense, pool->slotToDense, slots);
+	memcpy(grown.denseToSlot, pool->denseToSlot, slots);
+	memcpy(grown.freeSlots, pool->freeSlots, pool->freeCount * sizeof(uint16_t));
+	memcpy(grown.removed, pool->removed, pool->capacity * sizeof(bool));
+	grown.capacity = capacity;
+	PoolFreeNewSlots(&grown, pool->capacity, capacity);
+	*pool = grown;
+	return true;
+}
+
+static inline void PoolRelocate(EntityPool* pool, ptrdiff_t delta)
+{
+	ARENA_RELOCATE(pool->generation, delta);
+	ARENA_RELOCATE(pool->slotToDense, delta);
+	ARENA_RELOCATE(pool->denseToSlot, delta);
+	ARENA_RELOCATE(pool->freeSlots, delta);
+	ARENA_RELOCATE(pool->removed, delta);
+}
+
+// Appends an entity slot and bumps count, returns the dense index the caller
+// writes the entity to, or -1 if the pool is full
+static inline int PoolAdd(EntityPool* pool, int* count)
+{
+	if (pool->freeCount == 0 || *count >= pool->capacity) return -1;
+	const int index = (*count)++;
+	const uint16_t slot = pool->freeSlots[--pool->freeCount];
+	pool->slotToDense[slot] = (uint16_t)index;
+	pool->denseToSlot[index] = slot;
+	pool->removed[index] = false;
+	return index;
+}
+
+static inline bool PoolAlive(const EntityPool* pool, int index)
+{
+	return !pool->removed[index];
+}
+
+// Marks the entity at a dense index for removal, removing twice is harmless
+static inline void PoolRemove(EntityPool* pool, int index)
+{
+	if (pool->removed[index]) return;
+	pool->removed[index] = true;
+	pool->removedCount++;
+}
+
+static inline EntityHandle PoolHandle(const EntityPool* pool, int index)
+{
+	const uint16_t slot = pool->denseToSlot[index];
+	return (EntityHandle){slot, pool->generation[slot]};
+}
+
+// Dense index of a handle, -1 once the entity has been removed
+static inline int PoolLookup(const EntityPool* pool, EntityHandle handle)
+{
+	if (handle.generation == 0 || handle.slot >= pool->capacity) return -1;
+	if (pool->generation[handle.slot] != handle.generation) return -1;
+	const int index = pool->slotToDense[handle.slot];
+	return pool->removed[index] ? -1 : index;
+}
+
+// Moves the entity at dense index from to index to, in whatever storage the pool indexes
+typedef void (*PoolMoveFunc)(void* context, int to, int from);
+
+// Frees the removed entities and closes the gaps. Walking from the back means
+// the element moved into a gap is always one that survives.
+static inline void PoolCompactWith(EntityPool* pool, int* count, PoolMoveFunc move, void* context)
+{
+	if (pool->removedCount == 0) return;
+	for (int index = *count - 1; index >= 0; index--)
+	{
+		if (!pool->removed[index]) continue;
+		const uint16_t slot = pool->denseToSlot[index];
+		pool->generation[slot] = (uint16_t)(pool->generation[slot] + 1);
+		if (pool->generation[slot] == 0) pool->generation[slot] = 1;
+		pool->freeSlots[pool->freeCount++] = slot;
+
+		const int last = --(*count);
+		if (index != last)
+		{
+			move(context, index, last);
+			const uint16_t movedSlot = pool->denseToSlot[last];
+			pool->denseToSlot[index] = movedSlot;
+			pool->slotToDense[movedSlot] = (uint16_t)index;
+		}
+		pool->removed[index] = false;
+		pool->removed[last] = false;
+	}
+	pool->removedCount = 0;
+}
+
+typedef struct PoolItems {
+	unsigned char* bytes;
+	size_t itemSize;
+} PoolItems;
+
+static inline void PoolMoveItem(void* context, int to, int from)
+{
+	PoolItems* items = (PoolItems*)context;
+	memcpy(items->bytes + (size_t)to * items->itemSize, items->bytes + (size_t)from * items->itemSize, items->itemSize);
+}
+
+// PoolCompactWith for entities stored as one array of structs
+static inline void PoolCompact(EntityPool* pool, void* items, size_t itemSize, int* count)
+{
+	PoolItems context = {(unsigned char*)items, itemSize};
+	PoolCompactWith(pool, count, PoolMoveItem, &context);
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "raylib.h"
+#include "trace.h"
+
+// Lightweight phase timers. Each rendered frame owns one slot of a ring
+// buffer; every ProfileBegin/ProfileEnd pair adds its duration to the current
+// slot, so phases that run once per tick sum up over all ticks of the frame.
+// While a trace capture is running every pair is also recorded as a trace event.
+#define PROFILE_HISTORY (240)
+// Window over which the simulation rate is measured, in seconds
+#define PROFILE_RATE_WINDOW (0.5)
+
+// Clock used for the timers, drivers without a real GetTime() override it
+#ifndef PROFILER_CLOCK
+#define PROFILER_CLOCK() GetTime()
+#endif
+
+typedef enum ProfilePhase
+{
+	PROFILE_UPDATE,
+	PROFILE_STARS,
+	PROFILE_PLAYER,
+	PROFILE_SHOOT,
+	PROFILE_ENEMIES,
+	PROFILE_BULLETS,
+	PROFILE_PLAYER_COLLISION,
+	PROFILE_ASTEROIDS,
+	PROFILE_ASTEROID_COLLISION,
+	PROFILE_BOOSTS,
+	PROFILE_EMITTERS,
+	PROFILE_DRAW,
+	PROFILE_LIGHTMAP,
+	PROFILE_SCENE,
+	PROFILE_COMPOSITE,
+	PROFILE_UI,
+	PROFILE_COUNT,
+} ProfilePhase;
+
+// Names in the overlay, the bench tables and the trace, "unknown" out of range
+static inline const char* ProfilePhaseName(ProfilePhase phase)
+{
+	static const char* names[PROFILE_COUNT] = {
+		[PROFILE_UPDATE]             = "update",
+		[PROFILE_STARS]              = "stars",
+		[PROFILE_PLAYER]             = "player",
+		[PROFILE_SHOOT]              = "shoot",
+		[PROFILE_ENEMIES]            = "enemies",
+		[PROFILE_BULLETS]            = "bullets",
+		[PROFILE_PLAYER_COLLISION]   = "player collision",
+		[PROFILE_ASTEROIDS]          = "asteroids",
+		[PROFILE_ASTEROID_COLLISION] = "asteroid collision",
+		[PROFILE_BOOSTS]             = "boosts",
+		[PROFILE_EMITTERS]           = "emitters",
+		[PROFILE_DRAW]               = "draw",
+		[PROFILE_LIGHTMAP]           = "lightmap",
+		[PROFILE_SCENE]              = "scene",
+		[PROFILE_COMPOSITE]          = "composite",
+		[PROFILE_UI]                 = "ui",
+	};
+	return phase >= 0 && phase < PROFILE_COUNT ? names[phase] : "unknown";
+}
+
+// Per-frame event counts, summed like the phase timers
+typedef enum ProfileCounter
+{
+	PROFILE_PAIRS_BRUTE,      // pairs a test of every entity against every target would visit
+	PROFILE_PAIRS_CANDIDATE,  // pairs the broadphase handed out
+	PROFILE_PAIRS_OVERLAP,    // candidates whose colliders overlap
+	PROFILE_MIDPHASE_REJECTS, // overlapping pairs the midphase kept from the pixel test
+	PROFILE_PIXEL_TESTS,      // pairs that reached the pixel perfect test
+	PROFILE_COUNTER_COUNT,
+} ProfileCounter;
+
+static inline const char* ProfileCounterName(ProfileCounter counter)
+{
+	static const char* names[PROFILE_COUNTER_COUNT] = {
+		[PROFILE_PAIRS_BRUTE]      = "pairs brute",
+		[PROFILE_PAIRS_CANDIDATE]  = "pairs candidate",
+		[PROFILE_PAIRS_OVERLAP]    = "pairs overlap",
+		[PROFILE_MIDPHASE_REJECTS] = "midphase rejects",
+		[PROFILE_PIXEL_TESTS]      = "pixel tests",
+	};
+	return counter >= 0 && counter < PROFILE_COUNTER_COUNT ? names[counter] : "unknown";
+}
+
+// Totals are the sum of the phases listed below them, or less while phases
+// run in parallel on the job system
+static inline bool ProfileIsTotal(ProfilePhase phase)
+{
+	return phase == PROFILE_UPDATE || phase == PROFILE_DRAW;
+}
+
+typedef struct ProfileFrame {
+	float seconds[PROFILE_COUNT];
+	long counters[PROFILE_COUNTER_COUNT];
+	int ticks;
+	int bulletCount;
+} ProfileFrame;
+
+typedef struct Profiler {
+	ProfileFrame frames[PROFILE_HISTORY];
+	int current;    // slot being written this frame
+	int frameCount; // completed frames, up to PROFILE_HISTORY
+	double start[PROFILE_COUNT];
+	double frameStart;
+	// Achieved simulation rate, refreshed every PROFILE_RATE_WINDOW
+	double rateStart;
+	long rateTicks;
+	float ticksPerSecond;
+	Trace trace;
+} Profiler;
+
+static inline void ProfileFrameBegin(Profiler* profiler)
+{
+	profiler->frames[profiler->current] = (ProfileFrame){0};
+	profiler->frameStart = PROFILER_CLOCK();
+}
+
+static inline void ProfileFrameEnd(Profiler* profiler, int bulletCount)
+{
+	profiler->frames[profiler->current].bulletCount = bulletCount;
+	profiler->rateTicks += profiler->frames[profiler->current].ticks;
+	if (profiler->frameStart - profiler->rateStart >= PROFILE_RATE_WINDOW)
+	{
+		profiler->ticksPerSecond = (float)(profiler->rateTicks / (profiler->frameStart - profiler->rateStart));
+		profiler->rateStart = profiler->frameStart;
+		profiler->rateTicks = 0;
+	}
+	if (profiler->trace.capturing)
+	{
+		double now = PROFILER_CLOCK();
+		TraceComplete(&profiler->trace, TRACE_FRAME, "frame", profiler->frameStart, now);
+		TraceCounter(&profiler->trace, TRACE_FRAME, "ticks", profiler->frameStart, profiler->frames[profiler->current].ticks);
+		TraceCounter(&profiler->trace, TRACE_FRAME, "bullets", profiler->frameStart, bulletCount);
+	}
+	profiler->current = (profiler->current + 1) % PROFILE_HISTORY;
+	if (profiler->frameCount < PROFILE_HISTORY) profiler->frameCount++;
+}
+
+static inline void ProfileBegin(Profiler* profiler, ProfilePhase phase)
+{
+	profiler->start[phase] = PROFILER_CLOCK();
+}
+
+// Adds a span measured elsewhere, e.g. a job run by another thread, to a phase
+static inline void ProfileSpan(Profiler* profiler, ProfilePhase phase, double start, double end)
+{
+	profiler->frames[profiler->current].seconds[phase] += (float)(end - start);
+	if (profiler->trace.capturing)
+	{
+		TraceCategory category = phase < PROFILE_DRAW ? TRACE_UPDATE : TRACE_DRAW;
+		TraceComplete(&profiler->trace, category, ProfilePhaseName(phase), start, end);
+	}
+}
+
+static inline void ProfileEnd(Profiler* profiler, ProfilePhase phase)
+{
+	ProfileSpan(profiler, phase, profiler->start[phase], PROFILER_CLOCK());
+}
+
+static inline void ProfileCount(Profiler* profiler, ProfileCounter counter, long amount)
+{
+	profiler->frames[profiler->current].counters[counter] += amount;
+}
+
+// Counters of the current frame, indexed by ProfileCounter
+static inline long* ProfileCounters(Profiler* profiler)
+{
+	return profiler->frames[profiler->current].counters;
+}
+
+// Traces a one-off span that is not part of the per-frame phases (asset loads, reloads, GIF encoding)
+static inline void ProfileEvent(Profiler* profiler, TraceCategory category, const char* name, double start)
+{
+	if (profiler->trace.capturing)
+	{
+		TraceComplete(&profiler->trace, category, name, start, PROFILER_CLOCK());
+	}
+}
+
+// Rolling average and maximum over the completed frames, in seconds. Once the
+// history is full the current slot holds the frame being written, so it is
+// left out.
+static inline void ProfileStats(const Profiler* profiler, ProfilePhase phase, float* average, float* maximum)
+{
+	const int count = profiler->frameCount < PROFILE_HISTORY ? profiler->frameCount : PROFILE_HISTORY - 1;
+	float sum = 0.0f;
+	float max = 0.0f;
+	for (int i = 1; i <= count; i++)
+	{
+		float seconds = profiler->frames[(profiler->current - i + PROFILE_HISTORY) % PROFILE_HISTORY].seconds[phase];
+		sum += seconds;
+		if (seconds > max) max = seconds;
+	}
+	*average = count > 0 ? sum / count : 0.0f;
+	*maximum = max;
+}
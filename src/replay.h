@@ -0,0 +1,224 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Per-tick input recording. A replay is the seed of a fresh run plus the input
+// every simulation tick consumed, which is enough to reproduce the run exactly.
+//
+// A full pool drops spawns, so the pool capacities and limits the run was
+// recorded with are part of the replay too.
+//
+// File layout (little endian, version 2):
+//   header: "ASRP" | u32 version | u64 seed | u32 tickRate | u32 tickCount
+//           | u32 poolCount | poolCount * (u32 capacity | u32 limit)
+//   ticks:  u16 down | u16 pressed | f32 mouseX | f32 mouseY | i8 hoveredUpgrade
+// Version 1 files have no pools and play with the pools of the config.
+#define REPLAY_MAGIC "ASRP"
+#define REPLAY_VERSION (2)
+#define REPLAY_FILE "bin/replay.rep"
+#define REPLAY_MAX_POOLS (16)
+
+typedef enum ReplayMode
+{
+	REPLAY_OFF,
+	REPLAY_RECORDING,
+	REPLAY_PLAYING,
+} ReplayMode;
+
+typedef struct ReplayTick {
+	uint16_t down;
+	uint16_t pressed;
+	float mouseX;
+	float mouseY;
+	int8_t hoveredUpgrade;
+} ReplayTick;
+
+typedef struct ReplayPool {
+	uint32_t capacity;
+	uint32_t limit;
+} ReplayPool;
+
+typedef struct Replay {
+	ReplayMode mode;
+	uint64_t seed;
+	uint32_t tickRate;
+	uint32_t poolCount;
+	ReplayPool pools[REPLAY_MAX_POOLS];
+	ReplayTick* ticks;
+	uint32_t tickCount;
+	uint32_t tickCapacity;
+	uint32_t cursor;
+} Replay;
+
+static inline void ReplayFree(Replay* replay)
+{
+	free(replay->ticks);
+	*replay = (Replay){0};
+}
+
+static inline void ReplayRecordStart(Replay* replay, uint64_t seed, uint32_t tickRate, const ReplayPool* pools, uint32_t poolCount)
+{
+	ReplayFree(replay);
+	replay->mode = REPLAY_RECORDING;
+	replay->seed = seed;
+	replay->tickRate = tickRate;
+	replay->poolCount = poolCount < REPLAY_MAX_POOLS ? poolCount : REPLAY_MAX_POOLS;
+	memcpy(replay->pools, pools, replay->poolCount * sizeof(ReplayPool));
+}
+
+static inline void ReplayRecordTick(Replay* replay, ReplayTick tick)
+{
+	if (replay->tickCount == replay->tickCapacity)
+	{
+		uint32_t capacity = replay->tickCapacity ? replay->tickCapacity * 2 : 4096;
+		ReplayTick* ticks = (ReplayTick*)realloc(replay->ticks, capacity * sizeof(ReplayTick));
+		if (ticks == NULL)
+		{
+			printf("Error: out of memory while recording replay, stopping at tick %u\n", replay->tickCount);
+			replay->mode = REPLAY_OFF;
+			return;
+		}
+		replay->ticks = ticks;
+		replay->tickCapacity = capacity;
+	}
+	replay->ticks[replay->tickCount++] = tick;
+}
+
+// Fields go through these byte by byte, so the files match the layout above
+// whatever the byte order of the host
+static inline void ReplayWriteU64(FILE* file, uint64_t value, int bytes)
+{
+	for (int i = 0; i < bytes; i++) fputc((int)((value >> (8 * i)) & 0xFF), file);
+}
+
+static inline bool ReplayReadU64(FILE* file, uint64_t* value, int bytes)
+{
+	*value = 0;
+	for (int i = 0; i < bytes; i++)
+	{
+		int byte = fgetc(file);
+		if (byte == EOF) return false;
+		*value |= (uint64_t)byte << (8 * i);
+	}
+	return true;
+}
+
+static inline void ReplayWriteF32(FILE* file, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	ReplayWriteU64(file, bits, 4);
+}
+
+static inline bool ReplayReadF32(FILE* file, float* value)
+{
+	uint64_t bits;
+	if (!ReplayReadU64(file, &bits, 4)) return false;
+	const uint32_t bits32 = (uint32_t)bits;
+	memcpy(value, &bits32, sizeof(*value));
+	return true;
+}
+
+static inline bool ReplaySave(const Replay* replay, const char* path)
+{
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		printf("Error: could not open replay file %s\n", path);
+		return false;
+	}
+	fwrite(REPLAY_MAGIC, 1, 4, file);
+	ReplayWriteU64(file, REPLAY_VERSION, 4);
+	ReplayWriteU64(file, replay->seed, 8);
+	ReplayWriteU64(file, replay->tickRate, 4);
+	ReplayWriteU64(file, replay->tickCount, 4);
+	ReplayWriteU64(file, replay->poolCount, 4);
+	for (uint32_t i = 0; i < replay->poolCount; i++)
+	{
+		ReplayWriteU64(file, replay->pools[i].capacity, 4);
+		ReplayWriteU64(file, replay->pools[i].limit, 4);
+	}
+	for (uint32_t i = 0; i < replay->tickCount; i++)
+	{
+		const ReplayTick* tick = &replay->ticks[i];
+		ReplayWriteU64(file, tick->down, 2);
+		ReplayWriteU64(file, tick->pressed, 2);
+		ReplayWriteF32(file, tick->mouseX);
+		ReplayWriteF32(file, tick->mouseY);
+		ReplayWriteU64(file, (uint8_t)tick->hoveredUpgrade, 1);
+	}
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+static inline bool ReplayLoad(Replay* replay, const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		printf("Error: could not open replay file %s\n", path);
+		return false;
+	}
+	char magic[4];
+	uint64_t version = 0, tickRate = 0, tickCount = 0, poolCount = 0;
+	Replay loaded = {0};
+	bool ok = fread(magic, 1, 4, file) == 4
+		&& memcmp(magic, REPLAY_MAGIC, 4) == 0
+		&& ReplayReadU64(file, &version, 4)
+		&& (version == 1 || version == REPLAY_VERSION)
+		&& ReplayReadU64(file, &loaded.seed, 8)
+		&& ReplayReadU64(file, &tickRate, 4)
+		&& ReplayReadU64(file, &tickCount, 4)
+		&& (version == 1 || (ReplayReadU64(file, &poolCount, 4) && poolCount <= REPLAY_MAX_POOLS));
+	loaded.tickRate = (uint32_t)tickRate;
+	loaded.tickCount = (uint32_t)tickCount;
+	loaded.poolCount = (uint32_t)poolCount;
+	for (uint32_t i = 0; ok && i < loaded.poolCount; i++)
+	{
+		uint64_t capacity = 0, limit = 0;
+		ok = ReplayReadU64(file, &capacity, 4) && ReplayReadU64(file, &limit, 4);
+		loaded.pools[i] = (ReplayPool){(uint32_t)capacity, (uint32_t)limit};
+	}
+	if (ok && loaded.tickCount > 0)
+	{
+		loaded.ticks = (ReplayTick*)malloc(loaded.tickCount * sizeof(ReplayTick));
+		loaded.tickCapacity = loaded.tickCount;
+		ok = loaded.ticks != NULL;
+		for (uint32_t i = 0; ok && i < loaded.tickCount; i++)
+		{
+			ReplayTick* tick = &loaded.ticks[i];
+			uint64_t down = 0, pressed = 0, hoveredUpgrade = 0;
+			ok = ReplayReadU64(file, &down, 2)
+				&& ReplayReadU64(file, &pressed, 2)
+				&& ReplayReadF32(file, &tick->mouseX)
+				&& ReplayReadF32(file, &tick->mouseY)
+				&& ReplayReadU64(file, &hoveredUpgrade, 1);
+			tick->down = (uint16_t)down;
+			tick->pressed = (uint16_t)pressed;
+			tick->hoveredUpgrade = (int8_t)(uint8_t)hoveredUpgrade;
+		}
+	}
+	fclose(file);
+	if (!ok)
+	{
+		printf("Error: %s is not a version 1 or %d replay file\n", path, REPLAY_VERSION);
+		free(loaded.ticks);
+		return false;
+	}
+	ReplayFree(replay);
+	*replay = loaded;
+	replay->mode = REPLAY_PLAYING;
+	return true;
+}
+
+// Returns false once every recorded tick has been played back
+static inline bool ReplayPlaybackTick(Replay* replay, ReplayTick* tick)
+{
+	if (replay->cursor >= replay->tickCount) return false;
+	*tick = replay->ticks[replay->cursor++];
+	return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+
+// Seeded xoshiro128** generator. Each subsystem owns an independent stream,
+// so cosmetic randomness never shifts the gameplay sequence.
+typedef enum RngStream
+{
+	RNG_GAMEPLAY,  // spawns, enemy and asteroid parameters
+	RNG_PARTICLES, // particles and background stars
+	RNG_AUDIO,     // pitch jitter
+	RNG_STREAM_COUNT,
+} RngStream;
+
+typedef struct Rng {
+	uint32_t s[4];
+} Rng;
+
+static inline uint64_t SplitMix64(uint64_t* x)
+{
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static inline void RngSeed(Rng* rng, uint64_t seed, RngStream stream)
+{
+	uint64_t x = seed ^ ((uint64_t)(stream + 1) * 0xD1B54A32D192ED03ull);
+	uint64_t a = SplitMix64(&x);
+	uint64_t b = SplitMix64(&x);
+	rng->s[0] = (uint32_t)a;
+	rng->s[1] = (uint32_t)(a >> 32);
+	rng->s[2] = (uint32_t)b;
+	rng->s[3] = (uint32_t)(b >> 32);
+	if ((rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3]) == 0) rng->s[0] = 1; // all-zero state is a fixed point
+}
+
+static inline uint32_t RngRotl(uint32_t x, int k)
+{
+	return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t RngNext(Rng* rng)
+{
+	uint32_t* s = rng->s;
+	const uint32_t result = RngRotl(s[1] * 5, 7) * 9;
+	const uint32_t t = s[1] << 9;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = RngRotl(s[3], 11);
+	return result;
+}
+
+// Uniform integer in [min, max], arguments may come in either order (like GetRandomValue)
+static inline int RngInt(Rng* rng, int min, int max)
+{
+	if (min > max)
+	{
+		int tmp = max;
+		max = min;
+		min = tmp;
+	}
+	uint32_t range = (uint32_t)((int64_t)max - min) + 1u;
+	if (range == 0) return (int)RngNext(rng); // full 32-bit range
+	return min + (int)(((uint64_t)RngNext(rng) * range) >> 32);
+}
+
+// Uniform float in [0, 1)
+static inline float RngFloat(Rng* rng)
+{
+	return (RngNext(rng) >> 8) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "archetype.h"
+
+// Broadphase for the collision passes: a uniform grid over the play area,
+// rebuilt from an archetype's collider column right before the pass that
+// queries it, leaving out removed entities.
+//
+// Every entity goes into the one cell holding the top left corner of its
+// collider, and a query widens its rectangle up and to the left by the largest
+// collider in the grid instead. Corners outside the area are clamped into the
+// border cells, so every entity overlapping the query rectangle is found.
+// Colliders wider or taller than SPATIAL_HASH_MAX_EXTENT would widen every
+// query too much, they go to a list every query returns.
+//
+// The build is a counting sort: one pass counts the entities per cell, a
+// prefix sum gives every cell its range of the entry array and a second pass
+// fills the ranges. A query marks its candidates in a bitset over the entity
+// indices and hands them out in ascending order, the order the brute-force
+// loops visited them in.
+//
+// The per-entity arrays are carved from the arena for the largest capacity
+// the indexed archetype may grow to, so the hash never has to move.
+#define SPATIAL_HASH_CELL_SIZE (64.0f)
+#define SPATIAL_HASH_MAX_EXTENT (2.0f * SPATIAL_HASH_CELL_SIZE)
+#define SPATIAL_HASH_MAX_CELLS (512)
+#define SPATIAL_HASH_NO_CELL (0xFFFF)
+#define SPATIAL_HASH_WORDS (POOL_MAX_CAPACITY / 64)
+
+typedef struct SpatialHash {
+	Rectangle area;
+	int columns;
+	int rows;
+	int count;      // entities indexed, 0..count-1
+	Vector2 margin; // largest collider in the cells
+	uint16_t cellStart[SPATIAL_HASH_MAX_CELLS + 1];
+	uint16_t* entries;
+	uint16_t* cell; // per entity, SPATIAL_HASH_NO_CELL if removed or large
+	uint16_t* large;
+	int largeCount;
+} SpatialHash;
+
+typedef struct SpatialQuery {
+	uint64_t bits[SPATIAL_HASH_WORDS];
+	int words;
+	int word;
+	int count; // candidates found
+} SpatialQuery;
+
+// Carves the arrays for up to capacity entities, false if the arena is full
+static inline bool SpatialHashInit(SpatialHash* hash, MemoryArena* arena, int capacity)
+{
+	memset(hash, 0, sizeof(*hash));
+	hash->entries = (uint16_t*)ArenaPush(arena, capacity * sizeof(uint16_t));
+	hash->cell = (uint16_t*)ArenaPush(arena, capacity * sizeof(uint16_t));
+	hash->large = (uint16_t*)ArenaPush(arena, capacity * sizeof(uint16_t));
+	return hash->large != NULL;
+}
+
+static inline void SpatialHashRelocate(SpatialHash* hash, ptrdiff_t delta)
+{
+	ARENA_RELOCATE(hash->entries, delta);
+	ARENA_RELOCATE(hash->cell, delta);
+	ARENA_RELOCATE(hash->large, delta);
+}
+
+static inline int SpatialHashClamp(float value, int last)
+{
+	const int cell = (int)(value * (1.0f / SPATIAL_HASH_CELL_SIZE));
+	return value < 0.0f ? 0 : cell > last ? last : cell;
+}
+
+static inline void SpatialHashBuild(SpatialHash* hash, Rectangle area, const Archetype* archetype)
+{
+	const int columns = (int)(area.width / SPATIAL_HASH_CELL_SIZE) + 1;
+	int rows = (int)(area.height / SPATIAL_HASH_CELL_SIZE) + 1;
+	if (columns * rows > SPATIAL_HASH_MAX_CELLS) rows = SPATIAL_HASH_MAX_CELLS / columns;
+	const int cellCount = columns * rows;
+	const int count = archetype->count;
+	hash->area = area;
+	hash->columns = columns;
+	hash->rows = rows;
+	hash->count = count;
+	hash->largeCount = 0;
+
+	// Count, cellStart[cell + 1] holds the number of entities in cell
+	uint16_t* cellStart = hash->cellStart;
+	memset(cellStart, 0, (cellCount + 1) * sizeof(uint16_t));
+	Vector2 margin = {0.0f, 0.0f};
+	for (int i = 0; i < count; i++)
+	{
+		hash->cell[i] = SPATIAL_HASH_NO_CELL;
+		if (!ArchetypeAlive(archetype, i)) continue;
+		const Rectangle c = archetype->collider[i];
+		if (c.width > SPATIAL_HASH_MAX_EXTENT || c.height > SPATIAL_HASH_MAX_EXTENT)
+		{
+			hash->large[hash->largeCount++] = (uint16_t)i;
+			continue;
+		}
+		const int cell = SpatialHashClamp(c.y - area.y, rows - 1) * columns + SpatialHashClamp(c.x - area.x, columns - 1);
+		hash->cell[i] = (uint16_t)cell;
+		cellStart[cell + 1]++;
+		if (c.width > margin.x) margin.x = c.width;
+		if (c.height > margin.y) margin.y = c.height;
+	}
+	hash->margin = margin;
+	for (int cell = 0; cell < cellCount; cell++)
+	{
+		cellStart[cell + 1] += cellStart[cell];
+	}
+
+	// Fill, cellStart[cell] is used as the write cursor and ends up at the
+	// start of the next cell, shifting it back restores the starts
+	for (int i = 0; i < count; i++)
+	{
+		const uint16_t cell = hash->cell[i];
+		if (cell != SPATIAL_HASH_NO_CELL) hash->entries[cellStart[cell]++] = (uint16_t)i;
+	}
+	memmove(cellStart + 1, cellStart, cellCount * sizeof(uint16_t));
+	cellStart[0] = 0;
+}
+
+// Collects every entity that may overlap rect
+static inline void SpatialHashQuery(const SpatialHash* hash, Rectangle rect, SpatialQuery* query)
+{
+	query->words = (hash->count + 63) / 64;
+	query->word = 0;
+	memset(query->bits, 0, query->words * sizeof(uint64_t));
+	const int x0 = SpatialHashClamp(rect.x - hash->margin.x - hash->area.x, hash->columns - 1);
+	const int y0 = SpatialHashClamp(rect.y - hash->margin.y - hash->area.y, hash->rows - 1);
+	const int x1 = SpatialHashClamp(rect.x + rect.width - hash->area.x, hash->columns - 1);
+	const int y1 = SpatialHashClamp(rect.y + rect.height - hash->area.y, hash->rows - 1);
+	for (int y = y0; y <= y1; y++)
+	{
+		// The cells of a row are contiguous in the entry array
+		const int first = hash->cellStart[y * hash->columns + x0];
+		const int last = hash->cellStart[y * hash->columns + x1 + 1];
+		for (int e = first; e < last; e++)
+		{
+			const int i = hash->entries[e];
+			query->bits[i >> 6] |= (uint64_t)1 << (i & 63);
+		}
+	}
+	for (int l = 0; l < hash->largeCount; l++)
+	{
+		const int i = hash->large[l];
+		query->bits[i >> 6] |= (uint64_t)1 << (i & 63);
+	}
+	query->count = 0;
+	for (int w = 0; w < query->words; w++)
+	{
+		query->count += __builtin_popcountll(query->bits[w]);
+	}
+}
+
+static inline bool SpatialQueryContains(const SpatialQuery* query, int index)
+{
+	return (query->bits[index >> 6] >> (index & 63)) & 1;
+}
+
+// Next candidate in ascending order, -1 once all have been handed out
+static inline int SpatialQueryNext(SpatialQuery* query)
+{
+	for (; query->word < query->words; query->word++)
+	{
+		uint64_t* bits = &query->bits[query->word];
+		if (*bits == 0) continue;
+		const int bit = __builtin_ctzll(*bits);
+		*bits &= *bits - 1;
+		return query->word * 64 + bit;
+	}
+	return -1;
+}
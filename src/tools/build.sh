@@ -167,6 +167,35 @@ elif [ "$PLATFORM" == "windows" ]; then
 	mv $SRC_DIR/game_tmp.dll $SRC_DIR/game.dll
 	rm ./*.obj 2> /dev/null
 	echo "Built Windows executable: $OUT_EXE"
+elif [ "$PLATFORM" == "headless" ]; then
+	# Headless simulation build: game.c is linked against platformHeadless.h
+	# instead of raylib, so no window, GPU or audio device is needed.
+	if [ "$DEBUG" == "1" ]; then
+		DEBUG_FLAGS="-g -g3"
+	else 
+		DEBUG_FLAGS="-O2"
+	fi
+	INCLUDE_FLAGS="-I$SRC_DIR/third_party/include"
+	CC=gcc
+
+	time $CC $DEBUG_FLAGS $SRC_DIR/headless.c -o $BIN_DIR/${GAME_NAME}_headless \
+		$INCLUDE_FLAGS \
+		-lm -pthread
+
+	echo "Built headless executable: $BIN_DIR/${GAME_NAME}_headless"
+
+	time $CC $DEBUG_FLAGS $SRC_DIR/bench.c -o $BIN_DIR/${GAME_NAME}_bench \
+		$INCLUDE_FLAGS \
+		-lm -pthread
+
+	echo "Built benchmark executable: $BIN_DIR/${GAME_NAME}_bench"
+
+	time $CC $DEBUG_FLAGS $SRC_DIR/microbench.c -o $BIN_DIR/${GAME_NAME}_microbench \
+		$INCLUDE_FLAGS \
+		-lm
+
+	echo "Built microbenchmark executable: $BIN_DIR/${GAME_NAME}_microbench"
+	exit 0
 else
 	if [ "$DEBUG" == "1" ]; then
 		DEBUG_FLAGS="-g -g3"
@@ -154,22 +154,12 @@ end
 h:write("    SPRITE_COUNT\n")
 h:write("} SpriteID;\n\n")
 
--- Sprite struct
-h:write("typedef struct Sprite {\n")
-h:write("    Texture2D texture;\n")
-h:write("    Rectangle coords;\n")
-h:write("    Vector2 pivotOffset;\n")
-h:write("    int numFrames;\n")
-h:write("    SpriteID spriteID;\n")
-h:write("} Sprite;\n\n")
-
 -- enum AnimationID
 h:write("typedef enum AnimationID {\n")
 
 for _, name in ipairs(spriteNames) do
   local meta = spriteMeta[name]
   if meta.frameCount and meta.frameCount > 1 then
-    local clean = 
     h:write("    ANIM_" .. sanitizeName(name) .. ",\n")
   end
 end
@@ -177,14 +167,7 @@ h:write("    ANIMATION_COUNT\n")
 h:write("} AnimationID;\n\n")
 
 -- SpriteToAnimation lookup table
-h:write("static int SpriteToAnimation[SPRITE_COUNT] = {\n")
-
-local spriteNames = {}
-for name in pairs(spriteMeta) do
-  table.insert(spriteNames, name)
-end
-table.sort(spriteNames)
-
+h:write("static const int SpriteToAnimation[SPRITE_COUNT] = {\n")
 for _, name in ipairs(spriteNames) do
   local meta = spriteMeta[name]
   if meta.frameCount and meta.frameCount > 1 then
@@ -194,30 +177,60 @@ for _, name in ipairs(spriteNames) do
 end
 h:write("};\n\n")
 
--- getSprite()
-h:write("static inline Sprite getSprite(SpriteID spriteID) {\n")
-h:write("    Sprite s = {0};\n")
-h:write("    switch(spriteID) {\n")
+-- Sprite tables, indexed by SpriteID
+local function writeTable(comment, ctype, tableName, size, rows)
+  h:write(comment)
+  h:write(string.format("static const %s %s[%s] = {\n", ctype, tableName, size))
+  for _, row in ipairs(rows) do
+    h:write("    " .. row .. ",\n")
+  end
+  h:write("};\n\n")
+end
 
+local coordsRows, frameSizeRows, pivotRows, numFramesRows = {}, {}, {}, {}
+local firstFrameRows, maskWordsRows, frameRows = {}, {}, {}
+local frameTotal = 0
 for _, name in ipairs(spriteNames) do
   local m = spriteMeta[name]
-  h:write(string.format(
-    "        case %s: { s.coords = (Rectangle){%d, %d, %d, %d}; s.pivotOffset = (Vector2){%d, %d}; s.numFrames = %d; s.spriteID = %s; break; }\n",
-    "SPRITE_" .. sanitizeName(name),
-    m.offsetX - (m.frameWidth/m.frameCount)*(m.frameCount-1),
-    m.offsetY,
-    m.frameWidth,
-    m.frameHeight,
-    m.pivotX,
-    m.pivotY,
-    m.frameCount,
-	"SPRITE_" .. sanitizeName(name)
-))
+  local id = "[SPRITE_" .. sanitizeName(name) .. "] = "
+  local frameW = m.frameWidth // m.frameCount
+  local x = m.offsetX - frameW * (m.frameCount - 1)
+  table.insert(coordsRows, string.format("%s{%d, %d, %d, %d}", id, x, m.offsetY, m.frameWidth, m.frameHeight))
+  table.insert(frameSizeRows, string.format("%s{%d, %d}", id, frameW, m.frameHeight))
+  table.insert(pivotRows, string.format("%s{%d, %d}", id, m.pivotX, m.pivotY))
+  table.insert(numFramesRows, string.format("%s%d", id, m.frameCount))
+  table.insert(firstFrameRows, string.format("%s%d", id, frameTotal))
+  table.insert(maskWordsRows, string.format("%s%d", id, (frameW + 63) // 64 * m.frameHeight))
+  -- Frames of an animation step by the frame width plus the shape padding,
+  -- the same rectangles the game has always drawn and built masks from
+  for i = 0, m.frameCount - 1 do
+    local frameX = x
+    if m.frameCount > 1 then
+      frameX = x + i * (frameW + SHAPE_PADDING) - SHAPE_PADDING * m.frameCount
+    end
+    table.insert(frameRows, string.format("{%d, %d, %d, %d}, // SPRITE_%s %d", frameX, m.offsetY, frameW, m.frameHeight, sanitizeName(name), i))
+  end
+  frameTotal = frameTotal + m.frameCount
 end
-
-h:write("        default: break;\n")
-h:write("    }\n")
-h:write("    return s;\n")
-h:write("}\n")
+h:write(string.format("#define SPRITE_FRAME_COUNT (%d)\n\n", frameTotal))
+
+writeTable("// Atlas rectangle of the whole sprite, the frames of an animation side by side\n",
+  "Rectangle", "SpriteCoords", "SPRITE_COUNT", coordsRows)
+writeTable("// Width and height of a single frame\n",
+  "Vector2", "SpriteFrameSize", "SPRITE_COUNT", frameSizeRows)
+writeTable("// Offset of the pivot from the bottom center of a frame\n",
+  "Vector2", "SpritePivots", "SPRITE_COUNT", pivotRows)
+writeTable("", "int", "SpriteNumFrames", "SPRITE_COUNT", numFramesRows)
+writeTable("// Index of the first frame of the sprite in SpriteFrames\n",
+  "int", "SpriteFirstFrame", "SPRITE_COUNT", firstFrameRows)
+writeTable("// Words of one frame of the collision mask (rows padded to 64 bits), frame\n// i of the sprite starts i times as many words into its mask\n",
+  "int", "SpriteMaskFrameWords", "SPRITE_COUNT", maskWordsRows)
+
+-- SpriteFrames has no designated initializers, the comment names the frame
+h:write("// Atlas rectangle of every frame, the frames of a sprite back to back\n")
+h:write("static const Rectangle SpriteFrames[SPRITE_FRAME_COUNT] = {\n")
+for _, row in ipairs(frameRows) do
+  h:write("    " .. row .. "\n")
+end
+h:write("};\n")
 h:close()
-
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Trace capture in the Chrome trace-event format, loadable in chrome://tracing
+// or https://ui.perfetto.dev. Events are only appended to a memory buffer while
+// capturing; the JSON file is written when the capture stops, so file IO does
+// not land inside the frames being measured.
+//
+// Names are copied into the event: the game code that recorded them may be
+// unloaded by a hot reload before the capture is written.
+#define TRACE_NAME_LENGTH (48)
+#define TRACE_INITIAL_CAPACITY (1 << 16)
+
+typedef enum TraceCategory
+{
+	TRACE_FRAME,
+	TRACE_UPDATE,
+	TRACE_DRAW,
+	TRACE_RELOAD,
+	TRACE_ASSET,
+	TRACE_GIF,
+	TRACE_CATEGORY_COUNT,
+} TraceCategory;
+
+static inline const char* TraceCategoryName(TraceCategory category)
+{
+	static const char* names[TRACE_CATEGORY_COUNT] = {
+		[TRACE_FRAME]  = "frame",
+		[TRACE_UPDATE] = "update",
+		[TRACE_DRAW]   = "draw",
+		[TRACE_RELOAD] = "reload",
+		[TRACE_ASSET]  = "asset",
+		[TRACE_GIF]    = "gif",
+	};
+	return category >= 0 && category < TRACE_CATEGORY_COUNT ? names[category] : "unknown";
+}
+
+typedef enum TraceEventType
+{
+	TRACE_COMPLETE, // "X", a span with a duration
+	TRACE_COUNTER,  // "C", a sampled value
+} TraceEventType;
+
+typedef struct TraceEvent {
+	char name[TRACE_NAME_LENGTH];
+	uint8_t type;
+	uint8_t category;
+	double start; // seconds since the capture started
+	double value; // duration in seconds, or the counter value
+} TraceEvent;
+
+typedef struct Trace {
+	bool capturing;
+	double origin; // clock value at the start of the capture
+	TraceEvent* events;
+	uint32_t eventCount;
+	uint32_t eventCapacity;
+} Trace;
+
+static inline void TraceFree(Trace* trace)
+{
+	free(trace->events);
+	*trace = (Trace){0};
+}
+
+// Reserves the buffer up front so appending rarely has to reallocate mid-frame
+static inline void TraceStart(Trace* trace, double now)
+{
+	if (trace->eventCapacity < TRACE_INITIAL_CAPACITY)
+	{
+		TraceEvent* events = (TraceEvent*)realloc(trace->events, TRACE_INITIAL_CAPACITY * sizeof(TraceEvent));
+		if (events == NULL)
+		{
+			printf("Error: out of memory while starting trace capture\n");
+			return;
+		}
+		trace->events = events;
+		trace->eventCapacity = TRACE_INITIAL_CAPACITY;
+	}
+	trace->eventCount = 0;
+	trace->origin = now;
+	trace->capturing = true;
+}
+
+static inline void TraceAppend(Trace* trace, TraceEventType type, TraceCategory category, const char* name, double start, double value)
+{
+	if (!trace->capturing || start < trace->origin) return;
+	if (trace->eventCount == trace->eventCapacity)
+	{
+		uint32_t capacity = trace->eventCapacity * 2;
+		TraceEvent* events = (TraceEvent*)realloc(trace->events, capacity * sizeof(TraceEvent));
+		if (events == NULL)
+		{
+			printf("Error: out of memory while tracing, dropping events after %u\n", trace->eventCount);
+			return;
+		}
+		trace->events = events;
+		trace->eventCapacity = capacity;
+	}
+	TraceEvent* event = &trace->events[trace->eventCount++];
+	snprintf(event->name, sizeof(event->name), "%s", name);
+	event->type = (uint8_t)type;
+	event->category = (uint8_t)category;
+	event->start = start - trace->origin;
+	event->value = value;
+}
+
+static inline void TraceComplete(Trace* trace, TraceCategory category, const char* name, double start, double end)
+{
+	TraceAppend(trace, TRACE_COMPLETE, category, name, start, end - start);
+}
+
+static inline void TraceCounter(Trace* trace, TraceCategory category, const char* name, double time, double value)
+{
+	TraceAppend(trace, TRACE_COUNTER, category, name, time, value);
+}
+
+static inline void TraceWriteString(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\') fputc('\\', file);
+		if ((unsigned char)*c >= 0x20) fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+// Ends the capture and writes every buffered event, timestamps in microseconds
+static inline bool TraceStop(Trace* trace, const char* path)
+{
+	trace->capturing = false;
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		printf("Error: could not open trace file %s\n", path);
+		return false;
+	}
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+	for (uint32_t i = 0; i < trace->eventCount; i++)
+	{
+		const TraceEvent* event = &trace->events[i];
+		fprintf(file, ",\n{\"name\":");
+		TraceWriteString(file, event->name);
+		fprintf(file, ",\"cat\":\"%s\",\"pid\":1,\"tid\":1,\"ts\":%.3f", TraceCategoryName((TraceCategory)event->category), event->start * 1e6);
+		if (event->type == TRACE_COMPLETE)
+		{
+			fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f}", event->value * 1e6);
+		}
+		else
+		{
+			fprintf(file, ",\"ph\":\"C\",\"args\":{\"value\":%g}}", event->value);
+		}
+	}
+	fprintf(file, "\n]}\n");
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
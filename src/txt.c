@@ -23,20 +23,17 @@ static inline Color GetRainbowColor(float time)
     };
 }
 
-static inline void DrawTextWave(Font font, const char* text, Vector2 center, float fontSize, Color color, bool rainbow, float time, float amplitude, float frequency, float phase, bool drawShadow)
+// Width of a single line as laid out by DrawTextWave (glyph advances plus spacing)
+static inline float MeasureTextWaveWidth(Font font, const char* text, float fontSize, float spacing)
 {
-    float spacing = GetDefaultSpacing(fontSize);
-
-    // --- First pass: compute total width ---
     float totalWidth = 0.0f;
 
     int byteOffset = 0;
-    int codepoint = 0;
 
     while (text[byteOffset] != '\0')
     {
         int next = 0;
-        codepoint = GetCodepointNext(&text[byteOffset], &next);
+        int codepoint = GetCodepointNext(&text[byteOffset], &next);
 
         int glyphIndex = GetGlyphIndex(font, codepoint);
         float advance = (font.glyphs[glyphIndex].advanceX > 0)
@@ -48,10 +45,21 @@ static inline void DrawTextWave(Font font, const char* text, Vector2 center, flo
         byteOffset += next;
     }
 
+    return totalWidth;
+}
+
+static inline void DrawTextWave(Font font, const char* text, Vector2 center, float fontSize, Color color, bool rainbow, float time, float amplitude, float frequency, float phase, bool drawShadow)
+{
+    float spacing = GetDefaultSpacing(fontSize);
+
+    // --- First pass: compute total width ---
+    float totalWidth = MeasureTextWaveWidth(font, text, fontSize, spacing);
+
     float x = center.x - totalWidth / 2.0f;
 
     // --- Second pass: draw ---
-    byteOffset = 0;
+    int byteOffset = 0;
+    int codepoint = 0;
     int i = 0;
 
     while (text[byteOffset] != '\0')
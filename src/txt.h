@@ -28,6 +28,7 @@ typedef enum {
 	TXT_MUSICVOLUME,
 	TXT_FXVOLUME,
 	TXT_SHOW_DEBUG_INFO,
+	TXT_SHOW_PROFILER,
 	TXT_COUNT
 } TextID;
 
@@ -65,6 +66,7 @@ static const char *gText[LANG_COUNT][TXT_COUNT] = {
 	"Music Volume:",
 	"FX Volume:",
 	"Show debug info",
+	"Show profiler",
   },
   {
 	"",
@@ -92,6 +94,7 @@ static const char *gText[LANG_COUNT][TXT_COUNT] = {
 	"Musik Lautstärke:",
 	"FX Lautstärke:",
 	"Debuginformation anzeigen",
+	"Profiler anzeigen",
   },
   {
 	"",
@@ -119,5 +122,6 @@ static const char *gText[LANG_COUNT][TXT_COUNT] = {
 	"音乐音量:",
 	"效果音量:",
 	"显示碰撞 ",
+	"显示性能分析",
   },
 };